@@ -0,0 +1,13 @@
+#include <stddef.h>
+#include <stdint.h>
+
+// Touches every byte so the cost scales with the buffer like a real kernel
+void xor_kernel(uint8_t* data, size_t length) {
+    for (size_t i = 0; i < length; ++i) data[i] ^= 0x5a;
+}
+
+#include <sljs.h>
+
+int touch_buffers(sljs_buffer* buffers, size_t count) {
+    return count ? ((uint8_t*)buffers[0].data)[0] : 0;
+}
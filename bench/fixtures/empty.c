@@ -0,0 +1,9 @@
+// Calls that do nothing: what remains is the cost of the call path itself
+
+void noop(void) {}
+
+void tick(float dt) { (void)dt; }
+
+void render(void) {}
+
+void noop_args(int argc, const char** argv) { (void)argc; (void)argv; }
@@ -0,0 +1,11 @@
+#include <stdio.h>
+
+void say_hi(void) {
+    printf("hi\n");
+}
+
+// ~64 KiB of stdout per call: exercises the capture pipe and reader
+void spam(void) {
+    for (int i = 0; i < 1024; ++i)
+        printf("%04d the quick brown fox jumps over the lazy dog .........\n", i);
+}
@@ -0,0 +1,9 @@
+#include <string.h>
+
+const char* give_string(void) {
+    return "hello from bench";
+}
+
+const char* echo_first(int argc, const char** argv) {
+    return argc > 0 ? argv[0] : "";
+}
@@ -0,0 +1,16 @@
+#include <stdlib.h>
+
+int give_number(void) {
+    return 69420;
+}
+
+int add(int a, int b) {
+    return a + b;
+}
+
+// argv flavour of add(): what runArgsValue has to go through
+int add_args(int argc, const char** argv) {
+    int sum = 0;
+    for (int i = 0; i < argc; ++i) sum += atoi(argv[i]);
+    return sum;
+}
@@ -0,0 +1,217 @@
+#!/usr/bin/env node
+// Benchmarks every exported call path against the fixture libraries in
+// bench/fixtures, breaks the cost down into dlopen, dlsym, stdout capture
+// and argument marshalling, and compares the result with a saved baseline.
+//
+//   node bench/run.js [--quick] [--filter <regex>] [--out <file>]
+//                     [--baseline <file>] [--threshold <fraction>] [--save-baseline]
+//
+// Exits with status 1 when a case's p50 is slower than the baseline by more
+// than the threshold (default 0.25 = 25%).
+
+const fs = require('fs');
+const os = require('os');
+const path = require('path');
+const { execFileSync } = require('child_process');
+
+const root = path.resolve(__dirname, '..');
+const sljs = require(path.join(root, 'build/Release/sljs'));
+
+function parseArgs(argv) {
+  const opts = {
+    quick: false,
+    filter: null,
+    out: path.join(__dirname, 'results.json'),
+    baseline: path.join(__dirname, 'baseline.json'),
+    threshold: 0.25,
+    saveBaseline: false,
+  };
+  for (let i = 0; i < argv.length; i++) {
+    switch (argv[i]) {
+      case '--quick': opts.quick = true; break;
+      case '--filter': opts.filter = new RegExp(argv[++i]); break;
+      case '--out': opts.out = path.resolve(argv[++i]); break;
+      case '--baseline': opts.baseline = path.resolve(argv[++i]); break;
+      case '--threshold': opts.threshold = Number(argv[++i]); break;
+      case '--save-baseline': opts.saveBaseline = true; break;
+      default:
+        console.error(`unknown option ${argv[i]}`);
+        process.exit(2);
+    }
+  }
+  return opts;
+}
+
+// Fixtures are compiled from source whenever the .so is missing or stale
+function buildFixtures() {
+  const dir = path.join(__dirname, 'fixtures');
+  const cc = process.env.CC || 'cc';
+  const libs = {};
+  for (const file of fs.readdirSync(dir).filter(f => f.endsWith('.c'))) {
+    const src = path.join(dir, file);
+    const so = src.replace(/\.c$/, '.so');
+    if (!fs.existsSync(so) || fs.statSync(so).mtimeMs < fs.statSync(src).mtimeMs) {
+      execFileSync(cc, ['-O2', '-fPIC', '-shared', '-I', path.join(root, 'include'), '-o', so, src], { stdio: 'inherit' });
+    }
+    libs[path.basename(file, '.c')] = so;
+  }
+  return libs;
+}
+
+// dlopen is only paid when no handle to the file is live, and glibc
+// recognises an already-loaded object by its inode. Cases that time
+// dlopen therefore use a separate copy that no other case keeps open.
+function coldCopy(so) {
+  const copy = so.replace(/\.so$/, '-cold.so');
+  if (!fs.existsSync(copy) || fs.statSync(copy).mtimeMs < fs.statSync(so).mtimeMs) fs.copyFileSync(so, copy);
+  return copy;
+}
+
+// Calls are timed in batches large enough (>= 50 µs) that the timer's own
+// cost disappears; each batch contributes one ns/call sample to the
+// percentiles.
+function measure(fn, minTimeNs) {
+  const now = process.hrtime.bigint;
+  let batch = 1;
+  for (;;) {
+    const start = now();
+    for (let i = 0; i < batch; i++) fn();
+    if (Number(now() - start) >= 50e3 || batch >= 1 << 20) break;
+    batch *= 2;
+  }
+
+  const samples = [];
+  let calls = 0;
+  const begin = now();
+  while (Number(now() - begin) < minTimeNs || samples.length < 20) {
+    const start = now();
+    for (let i = 0; i < batch; i++) fn();
+    samples.push(Number(now() - start) / batch);
+    calls += batch;
+  }
+  const total = Number(now() - begin);
+
+  samples.sort((a, b) => a - b);
+  const at = q => samples[Math.min(samples.length - 1, Math.floor(q * samples.length))];
+  return {
+    callsPerSec: Math.round(calls / (total / 1e9)),
+    p50Ns: +at(0.5).toFixed(1),
+    p99Ns: +at(0.99).toFixed(1),
+    samples: samples.length,
+  };
+}
+
+function defineCases(libs) {
+  const coldValue = coldCopy(libs.value);
+  const lib = {};
+  for (const [name, so] of Object.entries(libs)) lib[name] = sljs.open(so);
+
+  const add = lib.value.bind('add', 'int(int, int)');
+  const giveNumber = lib.value.bind('give_number', 'int()');
+  const buffer4k = Buffer.alloc(4096);
+  const buffer1m = Buffer.alloc(1 << 20);
+
+  // One entry per export in Init; the legacy calls go through a Library
+  // handle so that the numbers show the call path, not dlopen. Only the
+  // path-based cases that exist to time dlopen use the cold copy.
+  const cases = {
+    'runText': () => sljs.runText(lib.empty, 'noop'),
+    'runText(spam 64KiB)': () => sljs.runText(lib.spam, 'spam'),
+    'runValue': () => sljs.runValue(lib.value, 'give_number'),
+    'runValue(path)': () => sljs.runValue(coldValue, 'give_number'),
+    'runArgsText': () => sljs.runArgsText(lib.empty, 'noop_args', ['a', 'b']),
+    'runArgsValue': () => sljs.runArgsValue(lib.value, 'add_args', ['1', '2']),
+    'runArgsString': () => sljs.runArgsString(lib.text, 'echo_first', ['a', 'b']),
+    'runStringReturn': () => sljs.runStringReturn(lib.text, 'give_string'),
+    'runBufferFunc(4KiB)': () => sljs.runBufferFunc(lib.buffer, 'xor_kernel', buffer4k),
+    'runBufferFunc(1MiB)': () => sljs.runBufferFunc(lib.buffer, 'xor_kernel', buffer1m),
+    'runGameTick': () => sljs.runGameTick(lib.empty, 'tick', 0.016),
+    'runRender': () => sljs.runRender(lib.empty, 'render'),
+    'runARMFunc': () => sljs.runARMFunc(lib.empty, 'noop'),
+    'inspect': () => sljs.inspect(libs.value),
+    'smartInspect': () => sljs.smartInspect(libs.value),
+    'open+close': () => sljs.open(coldValue).close(),
+    'bound int()': () => giveNumber(),
+    'bound int(int,int)': () => add(1, 2),
+    'runTyped int(int,int)': () => sljs.runTyped(lib.value, 'add', 'int(int,int)', [1, 2]),
+    'runBuffers(4KiB)': () => sljs.runBuffers(lib.buffer, 'touch_buffers', [buffer4k]),
+  };
+  return { cases, lib };
+}
+
+// Each component is the difference between two paths that differ only in it
+function breakdown(results) {
+  const p50 = name => (results[name] ? results[name].p50Ns : NaN);
+  const diff = (a, b) => +(p50(a) - p50(b)).toFixed(1);
+  return {
+    dlopenNs: diff('runValue(path)', 'runValue'),
+    openCloseNs: p50('open+close'),
+    dlsymNs: diff('runValue', 'bound int()'),
+    captureNs: diff('runText', 'runRender'),
+    captureMBps: results['runText(spam 64KiB)'] ? +(64 * 1024 / p50('runText(spam 64KiB)') * 1e3).toFixed(1) : NaN,
+    argvMarshallingNs: diff('runArgsValue', 'runValue'),
+    typedMarshallingNs: diff('runTyped int(int,int)', 'runValue'),
+    boundMarshallingNs: diff('bound int(int,int)', 'bound int()'),
+  };
+}
+
+function compare(results, baseline, threshold) {
+  const regressions = [];
+  for (const [name, base] of Object.entries(baseline.cases || {})) {
+    const current = results[name];
+    if (!current) continue;
+    const change = current.p50Ns / base.p50Ns - 1;
+    if (change > threshold) regressions.push({ name, baseline: base.p50Ns, current: current.p50Ns, change });
+  }
+  return regressions;
+}
+
+function main() {
+  const opts = parseArgs(process.argv.slice(2));
+  const libs = buildFixtures();
+  const { cases } = defineCases(libs);
+  const minTimeNs = (opts.quick ? 100 : 500) * 1e6;
+
+  const results = {};
+  console.log(`${'case'.padEnd(24)} ${'calls/s'.padStart(12)} ${'p50 ns'.padStart(12)} ${'p99 ns'.padStart(12)}`);
+  for (const [name, fn] of Object.entries(cases)) {
+    if (opts.filter && !opts.filter.test(name)) continue;
+    const r = measure(fn, minTimeNs);
+    results[name] = r;
+    console.log(`${name.padEnd(24)} ${String(r.callsPerSec).padStart(12)} ${r.p50Ns.toFixed(1).padStart(12)} ${r.p99Ns.toFixed(1).padStart(12)}`);
+  }
+
+  const report = {
+    date: new Date().toISOString(),
+    node: process.version,
+    platform: `${os.platform()}-${os.arch()}`,
+    cpus: os.cpus().length,
+    cases: results,
+    breakdown: breakdown(results),
+  };
+  console.log('\nbreakdown:', report.breakdown);
+
+  fs.writeFileSync(opts.out, JSON.stringify(report, null, 2) + '\n');
+  console.log(`results written to ${path.relative(process.cwd(), opts.out)}`);
+
+  if (opts.saveBaseline) {
+    fs.writeFileSync(opts.baseline, JSON.stringify(report, null, 2) + '\n');
+    console.log(`baseline saved to ${path.relative(process.cwd(), opts.baseline)}`);
+    return;
+  }
+  if (!fs.existsSync(opts.baseline)) {
+    console.log('no baseline found; run with --save-baseline to create one');
+    return;
+  }
+
+  const regressions = compare(results, JSON.parse(fs.readFileSync(opts.baseline, 'utf8')), opts.threshold);
+  if (regressions.length === 0) {
+    console.log(`no regressions beyond ${(opts.threshold * 100).toFixed(0)}% against the baseline`);
+    return;
+  }
+  for (const r of regressions)
+    console.error(`REGRESSION ${r.name}: p50 ${r.baseline} -> ${r.current} ns (+${(r.change * 100).toFixed(1)}%)`);
+  process.exitCode = 1;
+}
+
+main();
@@ -2,10 +2,11 @@
   "targets": [
     {
       "target_name": "sljs",
-      "sources": [ "libs/core.cpp" ],
+      "sources": [ "libs/core.cpp", "libs/library.cpp", "libs/bind.cpp", "libs/pool.cpp", "libs/async.cpp", "libs/capture.cpp", "libs/elf.cpp", "libs/buffers.cpp", "libs/loop.cpp", "libs/parallel.cpp", "libs/typed.cpp", "libs/stats.cpp", "libs/reload.cpp", "libs/channel.cpp", "libs/isolate.cpp", "libs/session.cpp", "libs/preload.cpp", "libs/symindex.cpp", "libs/pipeline.cpp", "libs/arena.cpp", "libs/callback.cpp" ],
       "include_dirs": [
         "<!(node -p \"require('node-addon-api').include\")",
-        "<!(node -p \"require('node-addon-api').include_dir\")"
+        "<!(node -p \"require('node-addon-api').include_dir\")",
+        "include"
       ],
       "defines": [ "NAPI_DISABLE_CPP_EXCEPTIONS" ],
       "cflags_cc!": [ "-fno-exceptions" ],
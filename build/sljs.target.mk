@@ -0,0 +1,182 @@
+# This file is generated by gyp; do not edit.
+
+TOOLSET := target
+TARGET := sljs
+DEFS_Debug := \
+	'-DNODE_GYP_MODULE_NAME=sljs' \
+	'-DUSING_UV_SHARED=1' \
+	'-DUSING_V8_SHARED=1' \
+	'-DV8_DEPRECATION_WARNINGS=1' \
+	'-D_GLIBCXX_USE_CXX11_ABI=1' \
+	'-D_FILE_OFFSET_BITS=64' \
+	'-D_LARGEFILE_SOURCE' \
+	'-D__STDC_FORMAT_MACROS' \
+	'-DOPENSSL_NO_PINSHARED' \
+	'-DOPENSSL_THREADS' \
+	'-DNAPI_DISABLE_CPP_EXCEPTIONS' \
+	'-DBUILDING_NODE_EXTENSION' \
+	'-DDEBUG' \
+	'-D_DEBUG'
+
+# Flags passed to all source files.
+CFLAGS_Debug := \
+	-fPIC \
+	-pthread \
+	-Wall \
+	-Wextra \
+	-Wno-unused-parameter \
+	-m64 \
+	-g \
+	-O0
+
+# Flags passed to only C files.
+CFLAGS_C_Debug :=
+
+# Flags passed to only C++ files.
+CFLAGS_CC_Debug := \
+	-fno-rtti \
+	-std=gnu++17 \
+	-std=c++17
+
+INCS_Debug := \
+	-I/usr/include/node \
+	-I/usr/src \
+	-I/usr/deps/openssl/config \
+	-I/usr/deps/openssl/openssl/include \
+	-I/usr/deps/uv/include \
+	-I/usr/deps/zlib \
+	-I/usr/deps/v8/include \
+	"-I$(srcdir)/\"/root/repo/node_modules/node-addon-api\"" \
+	-I$(srcdir)/node_modules/node-addon-api \
+	-I$(srcdir)/include
+
+DEFS_Release := \
+	'-DNODE_GYP_MODULE_NAME=sljs' \
+	'-DUSING_UV_SHARED=1' \
+	'-DUSING_V8_SHARED=1' \
+	'-DV8_DEPRECATION_WARNINGS=1' \
+	'-D_GLIBCXX_USE_CXX11_ABI=1' \
+	'-D_FILE_OFFSET_BITS=64' \
+	'-D_LARGEFILE_SOURCE' \
+	'-D__STDC_FORMAT_MACROS' \
+	'-DOPENSSL_NO_PINSHARED' \
+	'-DOPENSSL_THREADS' \
+	'-DNAPI_DISABLE_CPP_EXCEPTIONS' \
+	'-DBUILDING_NODE_EXTENSION'
+
+# Flags passed to all source files.
+CFLAGS_Release := \
+	-fPIC \
+	-pthread \
+	-Wall \
+	-Wextra \
+	-Wno-unused-parameter \
+	-m64 \
+	-O3 \
+	-fno-omit-frame-pointer
+
+# Flags passed to only C files.
+CFLAGS_C_Release :=
+
+# Flags passed to only C++ files.
+CFLAGS_CC_Release := \
+	-fno-rtti \
+	-std=gnu++17 \
+	-std=c++17
+
+INCS_Release := \
+	-I/usr/include/node \
+	-I/usr/src \
+	-I/usr/deps/openssl/config \
+	-I/usr/deps/openssl/openssl/include \
+	-I/usr/deps/uv/include \
+	-I/usr/deps/zlib \
+	-I/usr/deps/v8/include \
+	"-I$(srcdir)/\"/root/repo/node_modules/node-addon-api\"" \
+	-I$(srcdir)/node_modules/node-addon-api \
+	-I$(srcdir)/include
+
+OBJS := \
+	$(obj).target/$(TARGET)/libs/core.o \
+	$(obj).target/$(TARGET)/libs/library.o \
+	$(obj).target/$(TARGET)/libs/bind.o \
+	$(obj).target/$(TARGET)/libs/pool.o \
+	$(obj).target/$(TARGET)/libs/async.o \
+	$(obj).target/$(TARGET)/libs/capture.o \
+	$(obj).target/$(TARGET)/libs/elf.o \
+	$(obj).target/$(TARGET)/libs/buffers.o \
+	$(obj).target/$(TARGET)/libs/loop.o \
+	$(obj).target/$(TARGET)/libs/parallel.o \
+	$(obj).target/$(TARGET)/libs/typed.o \
+	$(obj).target/$(TARGET)/libs/stats.o \
+	$(obj).target/$(TARGET)/libs/reload.o \
+	$(obj).target/$(TARGET)/libs/channel.o \
+	$(obj).target/$(TARGET)/libs/isolate.o \
+	$(obj).target/$(TARGET)/libs/session.o \
+	$(obj).target/$(TARGET)/libs/preload.o \
+	$(obj).target/$(TARGET)/libs/symindex.o \
+	$(obj).target/$(TARGET)/libs/pipeline.o \
+	$(obj).target/$(TARGET)/libs/arena.o \
+	$(obj).target/$(TARGET)/libs/callback.o
+
+# Add to the list of files we specially track dependencies for.
+all_deps += $(OBJS)
+
+# CFLAGS et al overrides must be target-local.
+# See "Target-specific Variable Values" in the GNU Make manual.
+$(OBJS): TOOLSET := $(TOOLSET)
+$(OBJS): GYP_CFLAGS := $(DEFS_$(BUILDTYPE)) $(INCS_$(BUILDTYPE))  $(CFLAGS_$(BUILDTYPE)) $(CFLAGS_C_$(BUILDTYPE))
+$(OBJS): GYP_CXXFLAGS := $(DEFS_$(BUILDTYPE)) $(INCS_$(BUILDTYPE))  $(CFLAGS_$(BUILDTYPE)) $(CFLAGS_CC_$(BUILDTYPE))
+
+# Suffix rules, putting all outputs into $(obj).
+
+$(obj).$(TOOLSET)/$(TARGET)/%.o: $(srcdir)/%.cpp FORCE_DO_CMD
+	@$(call do_cmd,cxx,1)
+
+# Try building from generated source, too.
+
+$(obj).$(TOOLSET)/$(TARGET)/%.o: $(obj).$(TOOLSET)/%.cpp FORCE_DO_CMD
+	@$(call do_cmd,cxx,1)
+
+$(obj).$(TOOLSET)/$(TARGET)/%.o: $(obj)/%.cpp FORCE_DO_CMD
+	@$(call do_cmd,cxx,1)
+
+# End of this set of suffix rules
+### Rules for final target.
+LDFLAGS_Debug := \
+	-pthread \
+	-rdynamic \
+	-m64
+
+LDFLAGS_Release := \
+	-pthread \
+	-rdynamic \
+	-m64
+
+LIBS :=
+
+$(obj).target/sljs.node: GYP_LDFLAGS := $(LDFLAGS_$(BUILDTYPE))
+$(obj).target/sljs.node: LIBS := $(LIBS)
+$(obj).target/sljs.node: TOOLSET := $(TOOLSET)
+$(obj).target/sljs.node: $(OBJS) FORCE_DO_CMD
+	$(call do_cmd,solink_module)
+
+all_deps += $(obj).target/sljs.node
+# Add target alias
+.PHONY: sljs
+sljs: $(builddir)/sljs.node
+
+# Copy this to the executable output path.
+$(builddir)/sljs.node: TOOLSET := $(TOOLSET)
+$(builddir)/sljs.node: $(obj).target/sljs.node FORCE_DO_CMD
+	$(call do_cmd,copy)
+
+all_deps += $(builddir)/sljs.node
+# Short alias for building this executable.
+.PHONY: sljs.node
+sljs.node: $(obj).target/sljs.node $(builddir)/sljs.node
+
+# Add executable to "all" target.
+.PHONY: all
+all: $(builddir)/sljs.node
+
@@ -0,0 +1,186 @@
+#ifndef SLJS_H
+#define SLJS_H
+
+/*
+ * C ABI for libraries called through sljs.
+ *
+ * Include this header from the shared library side; nothing here needs to
+ * be linked. Pointers handed to the library point straight into JS memory
+ * (TypedArray, DataView, ArrayBuffer or SharedArrayBuffer backing stores)
+ * and are only valid for the duration of the call.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* One view passed by runBuffers / runBufferAlloc, or the result a library returns */
+typedef struct sljs_buffer {
+  void* data;
+  size_t length; /* in bytes */
+} sljs_buffer;
+
+/*
+ * runBuffers(lib, symbol, [views...]) calls
+ *   int symbol(sljs_buffer* buffers, size_t count);
+ * The buffers are writable, so outputs are simply preallocated views.
+ */
+typedef int (*sljs_buffers_fn)(sljs_buffer* buffers, size_t count);
+
+/*
+ * runBufferAlloc(lib, symbol, [views...], freeSymbol) calls
+ *   int symbol(const sljs_buffer* inputs, size_t count, sljs_buffer* out);
+ * The library allocates out->data itself; JS receives it as an external
+ * ArrayBuffer without a copy, and freeSymbol(out->data) runs once that
+ * ArrayBuffer is garbage collected. A non-zero return is an error (out is
+ * still freed if set).
+ */
+typedef int (*sljs_alloc_fn)(const sljs_buffer* inputs, size_t count, sljs_buffer* out);
+
+/* Default freeSymbol name used when runBufferAlloc is not given one */
+typedef void (*sljs_free_fn)(void* data);
+#define SLJS_DEFAULT_FREE "sljs_free"
+
+/*
+ * Ring channel: createChannel(lib, { capacity, init, stop, onData }).
+ *
+ * A multi-producer, single-consumer ring of length-prefixed records living
+ * in a SharedArrayBuffer. The init symbol receives the ring and may push
+ * from any number of its own threads for as long as the channel is open:
+ *   int init(sljs_ring* ring, size_t capacity);   non-zero fails createChannel
+ *   void stop(sljs_ring* ring);                   must return once no thread pushes
+ * JS drains records in batches with channel.drain(); nothing crosses N-API
+ * per record. When the consumer has emptied the ring it arms a wakeup, and
+ * the first commit after that (and only that one) calls ring->notify.
+ *
+ * Layout: three 64-byte lines of header followed by `capacity` bytes of
+ * data (a power of two). Each record is an sljs_record header plus its
+ * payload padded to 8 bytes; a record never wraps, the tail end of the
+ * data area is skipped with a padding record instead. The consumer zeroes
+ * what it has read, so a zero state means "not committed yet".
+ */
+#define SLJS_RING_MAGIC 0x736c6a72u /* "sljr" */
+#define SLJS_RING_HEADER 192
+
+typedef struct sljs_ring {
+  /* Written once by createChannel */
+  uint32_t magic;
+  uint32_t capacity;
+  void (*notify)(struct sljs_ring* ring);
+  void* notify_context;
+  uint8_t reserved0[64 - 8 - 2 * sizeof(void*)];
+  /* Producers */
+  uint64_t head;    /* bytes reserved so far */
+  uint64_t dropped; /* records refused because the ring was full */
+  uint8_t reserved1[48];
+  /* Consumer */
+  uint64_t tail;    /* bytes consumed so far */
+  uint32_t armed;   /* 1 while the consumer waits for a wakeup */
+  uint8_t reserved2[52];
+} sljs_ring;
+
+typedef struct sljs_record {
+  uint32_t length; /* payload bytes */
+  uint32_t state;  /* SLJS_RECORD_* */
+} sljs_record;
+
+#define SLJS_RECORD_EMPTY 0u
+#define SLJS_RECORD_READY 1u
+#define SLJS_RECORD_PADDING 2u
+
+static inline uint8_t* sljs_ring_data(sljs_ring* ring) {
+  return (uint8_t*)ring + SLJS_RING_HEADER;
+}
+
+/*
+ * Reserves room for a `length`-byte record and returns where its payload
+ * goes, or NULL when the ring is full (counted in ring->dropped) or the
+ * record could never fit. Every reservation must be committed.
+ */
+static inline void* sljs_ring_reserve(sljs_ring* ring, uint32_t length) {
+  uint64_t size = sizeof(sljs_record) + (((uint64_t)length + 7) & ~(uint64_t)7);
+  uint64_t capacity = ring->capacity;
+  uint64_t head = __atomic_load_n(&ring->head, __ATOMIC_RELAXED);
+  uint64_t pad;
+  if (size > capacity) {
+    __atomic_fetch_add(&ring->dropped, 1, __ATOMIC_RELAXED);
+    return NULL;
+  }
+  for (;;) {
+    uint64_t offset = head & (capacity - 1);
+    uint64_t tail = __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE);
+    pad = offset + size > capacity ? capacity - offset : 0;
+    if (head + pad + size - tail > capacity) {
+      __atomic_fetch_add(&ring->dropped, 1, __ATOMIC_RELAXED);
+      return NULL;
+    }
+    if (__atomic_compare_exchange_n(&ring->head, &head, head + pad + size, 1, __ATOMIC_ACQ_REL, __ATOMIC_RELAXED))
+      break;
+  }
+
+  uint8_t* data = sljs_ring_data(ring);
+  if (pad) {
+    sljs_record* skip = (sljs_record*)(data + (head & (capacity - 1)));
+    skip->length = (uint32_t)(pad - sizeof(sljs_record));
+    __atomic_store_n(&skip->state, SLJS_RECORD_PADDING, __ATOMIC_RELEASE);
+    head += pad;
+  }
+  sljs_record* record = (sljs_record*)(data + (head & (capacity - 1)));
+  record->length = length;
+  return record + 1;
+}
+
+/* Publishes a reserved record and wakes the consumer if it is waiting */
+static inline void sljs_ring_commit(sljs_ring* ring, void* payload) {
+  sljs_record* record = (sljs_record*)payload - 1;
+  __atomic_store_n(&record->state, SLJS_RECORD_READY, __ATOMIC_SEQ_CST);
+  if (__atomic_load_n(&ring->armed, __ATOMIC_SEQ_CST) && __atomic_exchange_n(&ring->armed, 0, __ATOMIC_SEQ_CST)) {
+    void (*notify)(sljs_ring*) = __atomic_load_n(&ring->notify, __ATOMIC_ACQUIRE);
+    if (notify) notify(ring);
+  }
+}
+
+/* Copies one record in; returns 0, or -1 if it was dropped */
+static inline int sljs_ring_push(sljs_ring* ring, const void* data, uint32_t length) {
+  void* payload = sljs_ring_reserve(ring, length);
+  if (!payload) return -1;
+  memcpy(payload, data, length);
+  sljs_ring_commit(ring, payload);
+  return 0;
+}
+
+/*
+ * Callbacks: createCallback(lib, { onCall, register, unregister, ... }).
+ *
+ * A plain function pointer and context the library can call from any of
+ * its threads to reach JS:
+ *   int invoke(void* context, uint64_t key, const void* data, uint32_t length);
+ * The call copies `data` into an sljs_ring and returns at once: 0 when the
+ * call was queued, -1 when the ring is full or the callback was closed. JS
+ * receives queued calls in batches, one event-loop turn per batch; `key`
+ * tells events apart and, with coalescing on, only the latest call per key
+ * in a batch is delivered. The pair reaches the library either through
+ *   int register(sljs_callback_fn invoke, void* context);  non-zero fails
+ *   void unregister(void* context);                       must return once no thread calls
+ * or as the sljs_callback struct in callback.handle, passed like any buffer.
+ */
+typedef int (*sljs_callback_fn)(void* context, uint64_t key, const void* data, uint32_t length);
+
+typedef struct sljs_callback {
+  sljs_callback_fn invoke;
+  void* context;
+} sljs_callback;
+
+static inline int sljs_callback_call(const sljs_callback* callback, uint64_t key, const void* data, uint32_t length) {
+  return callback->invoke(callback->context, key, data, length);
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SLJS_H */
@@ -0,0 +1,394 @@
+#include "arena.h"
+#include "core.h"
+
+#include <sys/mman.h>
+#include <unistd.h>
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <map>
+#include <mutex>
+#include <string>
+
+static constexpr size_t kDefaultSize = 16 << 20;
+static constexpr size_t kHugePage = 2 << 20;
+
+// Live mappings by base address, so a pin can tell which arena a pointer
+// belongs to. Also guards the pin counts and the unmapping itself.
+static std::mutex arenaMutex;
+static std::map<uintptr_t, ArenaMemory*> arenaMappings;
+
+struct ArenaMemory {
+  uint8_t* base = nullptr;
+  size_t size = 0;
+  std::atomic<size_t> refs{1}; // the Arena, every block not yet collected and every pin
+  size_t pins = 0;             // native calls in flight
+  bool freed = false;          // free() ran while calls were in flight
+
+  // Caller holds arenaMutex
+  void Unmap() {
+    if (!base) return;
+    arenaMappings.erase(reinterpret_cast<uintptr_t>(base));
+    munmap(base, size);
+    base = nullptr;
+  }
+};
+
+static void releaseMemory(ArenaMemory* memory) {
+  if (--memory->refs > 0) return;
+  {
+    std::lock_guard<std::mutex> lock(arenaMutex);
+    memory->Unmap();
+  }
+  delete memory;
+}
+
+ArenaPin::ArenaPin(const void* data) {
+  if (!data) return;
+  auto address = reinterpret_cast<uintptr_t>(data);
+  std::lock_guard<std::mutex> lock(arenaMutex);
+  auto it = arenaMappings.upper_bound(address);
+  if (it == arenaMappings.begin()) return;
+  --it;
+  if (address >= it->first + it->second->size) return;
+  memory_ = it->second;
+  memory_->pins++;
+  memory_->refs++;
+}
+
+ArenaPin::~ArenaPin() {
+  if (!memory_) return;
+  {
+    std::lock_guard<std::mutex> lock(arenaMutex);
+    if (--memory_->pins == 0 && memory_->freed) memory_->Unmap();
+  }
+  releaseMemory(memory_);
+}
+
+// Finalizer of a block's external ArrayBuffer
+static void releaseBlock(napi_env, void*, void* hint) {
+  releaseMemory(static_cast<ArenaMemory*>(hint));
+}
+
+struct ElementType {
+  const char* name;
+  napi_typedarray_type type;
+  size_t size;
+};
+
+static const ElementType kElementTypes[] = {
+  { "int8", napi_int8_array, 1 },       { "uint8", napi_uint8_array, 1 },
+  { "int16", napi_int16_array, 2 },     { "uint16", napi_uint16_array, 2 },
+  { "int32", napi_int32_array, 4 },     { "uint32", napi_uint32_array, 4 },
+  { "float32", napi_float32_array, 4 }, { "float64", napi_float64_array, 8 },
+  { "bigint64", napi_bigint64_array, 8 }, { "biguint64", napi_biguint64_array, 8 },
+};
+
+static const ElementType* findElementType(const std::string& name) {
+  for (const ElementType& type : kElementTypes)
+    if (name == type.name) return &type;
+  return nullptr;
+}
+
+static bool powerOfTwo(size_t n) {
+  return n && !(n & (n - 1));
+}
+
+static size_t alignUp(size_t n, size_t alignment) {
+  return (n + alignment - 1) & ~(alignment - 1);
+}
+
+Napi::Function Arena::Define(Napi::Env env) {
+  Napi::Function ctor = DefineClass(env, "Arena", {
+    InstanceMethod("alloc", &Arena::Alloc),
+    InstanceMethod("structOfArrays", &Arena::StructOfArrays),
+    InstanceMethod("reset", &Arena::Reset),
+    InstanceMethod("free", &Arena::Free),
+    InstanceMethod("stats", &Arena::Stats),
+  });
+  addonData(env).arena = Napi::Persistent(ctor);
+  return ctor;
+}
+
+// createArena({ size, alignment, hugePages, lock })
+Napi::Value Arena::Create(const Napi::CallbackInfo& info) {
+  return addonData(info.Env()).arena.New({ info[0] });
+}
+
+Arena::Arena(const Napi::CallbackInfo& info) : Napi::ObjectWrap<Arena>(info) {
+  Napi::Env env = info.Env();
+  size_t size = kDefaultSize;
+  bool hugePages = false, lock = false;
+  if (info[0].IsObject()) {
+    Napi::Object options = info[0].As<Napi::Object>();
+    if (options.Get("size").IsNumber())
+      size = static_cast<size_t>(std::max<int64_t>(0, options.Get("size").As<Napi::Number>().Int64Value()));
+    if (options.Get("alignment").IsNumber())
+      alignment_ = static_cast<size_t>(std::max<int64_t>(0, options.Get("alignment").As<Napi::Number>().Int64Value()));
+    hugePages = options.Get("hugePages").ToBoolean().Value();
+    lock = options.Get("lock").ToBoolean().Value();
+  }
+
+  size_t page = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+  baseAlignment_ = hugePages ? kHugePage : page;
+  if (!powerOfTwo(alignment_) || alignment_ > baseAlignment_) {
+    Napi::RangeError::New(env, "alignment must be a power of two no larger than " + std::to_string(baseAlignment_))
+        .ThrowAsJavaScriptException();
+    return;
+  }
+  if (size == 0) {
+    Napi::RangeError::New(env, "size must be positive").ThrowAsJavaScriptException();
+    return;
+  }
+  size = alignUp(size, baseAlignment_);
+
+  // Huge pages need a 2 MiB aligned start: map one extra page and trim
+  size_t reserve = size + (baseAlignment_ > page ? baseAlignment_ : 0);
+  void* mapped = mmap(nullptr, reserve, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+  if (mapped == MAP_FAILED) {
+    Napi::Error::New(env, "Could not map " + std::to_string(size) + " bytes: " + strerror(errno)).ThrowAsJavaScriptException();
+    return;
+  }
+  uint8_t* raw = static_cast<uint8_t*>(mapped);
+  uint8_t* base = reinterpret_cast<uint8_t*>(alignUp(reinterpret_cast<uintptr_t>(raw), baseAlignment_));
+  if (base > raw) munmap(raw, base - raw);
+  if (raw + reserve > base + size) munmap(base + size, raw + reserve - (base + size));
+
+  memory_ = new ArenaMemory();
+  memory_->base = base;
+  memory_->size = size;
+  {
+    std::lock_guard<std::mutex> lock(arenaMutex);
+    arenaMappings.emplace(reinterpret_cast<uintptr_t>(base), memory_);
+  }
+
+  // Transparent huge pages are a hint; stats() reports whether it was taken
+  if (hugePages) hugePages_ = madvise(base, size, MADV_HUGEPAGE) == 0;
+  if (lock) {
+    if (mlock(base, size) != 0) {
+      std::string reason = strerror(errno);
+      releaseMemory(memory_);
+      memory_ = nullptr;
+      Napi::Error::New(env, "Could not lock " + std::to_string(size) + " bytes in memory: " + reason + " (see ulimit -l)")
+          .ThrowAsJavaScriptException();
+      return;
+    }
+    locked_ = true;
+  }
+}
+
+// Blocks still referenced from JS keep the mapping until they are collected
+Arena::~Arena() {
+  if (memory_) releaseMemory(memory_);
+}
+
+bool Arena::Usable(Napi::Env env) {
+  if (memory_) return true;
+  Napi::Error::New(env, "arena has been freed").ThrowAsJavaScriptException();
+  return false;
+}
+
+size_t Arena::PendingCalls() const {
+  std::lock_guard<std::mutex> lock(arenaMutex);
+  return memory_->pins;
+}
+
+// The alignment option of alloc() and structOfArrays(), never below the
+// element size so the TypedArray is valid
+size_t Arena::Alignment(Napi::Env env, const Napi::Value& options, size_t elementSize, bool& ok) {
+  ok = true;
+  size_t alignment = alignment_;
+  if (options.IsObject() && options.As<Napi::Object>().Get("alignment").IsNumber()) {
+    int64_t requested = options.As<Napi::Object>().Get("alignment").As<Napi::Number>().Int64Value();
+    alignment = static_cast<size_t>(std::max<int64_t>(0, requested));
+    if (!powerOfTwo(alignment) || alignment > baseAlignment_) {
+      Napi::RangeError::New(env, "alignment must be a power of two no larger than " + std::to_string(baseAlignment_))
+          .ThrowAsJavaScriptException();
+      ok = false;
+      return 0;
+    }
+  }
+  return std::max(alignment, elementSize);
+}
+
+Napi::Value Arena::Block(Napi::Env env, napi_typedarray_type type, size_t count, size_t alignment) {
+  size_t elementSize = 1;
+  for (const ElementType& t : kElementTypes)
+    if (t.type == type) elementSize = t.size;
+
+  size_t start = alignUp(used_, alignment);
+  if (start > memory_->size || count > (memory_->size - start) / elementSize) {
+    Napi::RangeError::New(env, "arena exhausted: " + std::to_string(count * elementSize) + " bytes requested, " +
+                                   std::to_string(memory_->size - std::min(start, memory_->size)) + " left")
+        .ThrowAsJavaScriptException();
+    return env.Null();
+  }
+  size_t bytes = count * elementSize;
+
+  napi_value buffer, view;
+  memory_->refs++;
+  if (napi_create_external_arraybuffer(env, memory_->base + start, bytes, releaseBlock, memory_, &buffer) != napi_ok) {
+    memory_->refs--;
+    // Runtimes with a memory sandbox refuse external backing stores, and a
+    // copy would defeat the point of the arena
+    Napi::Error::New(env, "This runtime does not allow external ArrayBuffers").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+  if (napi_create_typedarray(env, type, count, buffer, 0, &view) != napi_ok) {
+    Napi::Error::New(env, "Could not create a view of the arena block").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+  if (blocks_.size() >= pruneAt_) PruneBlocks(env);
+  blocks_.push_back(Napi::Weak(Napi::ArrayBuffer(env, buffer)));
+  used_ = start + bytes;
+  peak_ = std::max(peak_, used_);
+  allocations_++;
+  return Napi::Value(env, view);
+}
+
+// alloc(count, type = 'uint8', { alignment }) -> TypedArray over a new block
+Napi::Value Arena::Alloc(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+  if (!Usable(env)) return env.Null();
+  if (!info[0].IsNumber() || info[0].As<Napi::Number>().DoubleValue() < 0) {
+    Napi::TypeError::New(env, "alloc(count, type, options) expects a non-negative count").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+  std::string typeName = info[1].IsString() ? info[1].As<Napi::String>().Utf8Value() : "uint8";
+  const ElementType* type = findElementType(typeName);
+  if (!type) {
+    Napi::TypeError::New(env, "Unknown element type: " + typeName).ThrowAsJavaScriptException();
+    return env.Null();
+  }
+  bool ok;
+  size_t alignment = Alignment(env, info[2], type->size, ok);
+  if (!ok) return env.Null();
+  return Block(env, type->type, static_cast<size_t>(info[0].As<Napi::Number>().Int64Value()), alignment);
+}
+
+// structOfArrays(count, { x: 'float32', id: 'uint32', ... }, { alignment })
+// -> { x: Float32Array(count), id: Uint32Array(count), ... }, one aligned
+// column per field in declaration order. Object.values() of the result is
+// ready for runBuffers().
+Napi::Value Arena::StructOfArrays(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+  if (!Usable(env)) return env.Null();
+  if (!info[0].IsNumber() || info[0].As<Napi::Number>().DoubleValue() < 0 || !info[1].IsObject()) {
+    Napi::TypeError::New(env, "structOfArrays(count, fields, options) expects a count and a field map")
+        .ThrowAsJavaScriptException();
+    return env.Null();
+  }
+  size_t count = static_cast<size_t>(info[0].As<Napi::Number>().Int64Value());
+  Napi::Object fields = info[1].As<Napi::Object>();
+  Napi::Array names = fields.GetPropertyNames();
+
+  // Lay every column out first so a layout that does not fit allocates nothing
+  std::vector<const ElementType*> types;
+  std::vector<size_t> alignments;
+  size_t end = used_;
+  for (uint32_t i = 0; i < names.Length(); ++i) {
+    Napi::Value typeName = fields.Get(names.Get(i));
+    const ElementType* type = typeName.IsString() ? findElementType(typeName.As<Napi::String>()) : nullptr;
+    if (!type) {
+      Napi::TypeError::New(env, "Unknown element type for field " + names.Get(i).ToString().Utf8Value())
+          .ThrowAsJavaScriptException();
+      return env.Null();
+    }
+    bool ok;
+    size_t alignment = Alignment(env, info[2], type->size, ok);
+    if (!ok) return env.Null();
+    types.push_back(type);
+    alignments.push_back(alignment);
+    end = alignUp(end, alignment);
+    if (end > memory_->size || count > (memory_->size - end) / type->size) {
+      Napi::RangeError::New(env, "arena exhausted: the layout needs more than the " +
+                                     std::to_string(memory_->size - used_) + " bytes left")
+          .ThrowAsJavaScriptException();
+      return env.Null();
+    }
+    end += count * type->size;
+  }
+
+  Napi::Object result = Napi::Object::New(env);
+  for (uint32_t i = 0; i < names.Length(); ++i) {
+    Napi::Value column = Block(env, types[i]->type, count, alignments[i]);
+    if (column.IsNull()) return env.Null();
+    result.Set(names.Get(i), column);
+  }
+  return result;
+}
+
+void Arena::DetachBlocks() {
+  for (auto& ref : blocks_) {
+    Napi::ArrayBuffer buffer = ref.Value();
+    if (!buffer.IsEmpty() && !buffer.IsDetached()) buffer.Detach();
+  }
+  blocks_.clear();
+}
+
+// Drops the references whose block has been collected. Run when the list has
+// doubled since the last prune, so a long run of alloc() without reset()
+// stays bounded by the blocks still alive.
+void Arena::PruneBlocks(Napi::Env env) {
+  Napi::HandleScope scope(env);
+  blocks_.erase(std::remove_if(blocks_.begin(), blocks_.end(), [](Napi::Reference<Napi::ArrayBuffer>& ref) {
+    return ref.Value().IsEmpty();
+  }), blocks_.end());
+  pruneAt_ = std::max<size_t>(64, blocks_.size() * 2);
+}
+
+// Rewinds the whole arena at once; earlier blocks become empty views.
+// Refused while a native call still works on a block, since its bytes
+// would be handed out again underneath it.
+Napi::Value Arena::Reset(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+  if (!Usable(env)) return env.Null();
+  if (size_t pending = PendingCalls()) {
+    Napi::Error::New(env, "cannot reset the arena: " + std::to_string(pending) + " native call(s) still use its blocks")
+        .ThrowAsJavaScriptException();
+    return env.Null();
+  }
+  DetachBlocks();
+  used_ = 0;
+  resets_++;
+  return env.Undefined();
+}
+
+// Unmaps the arena now rather than when it and its blocks are collected,
+// or, if native calls still use a block, as soon as the last one returns
+Napi::Value Arena::Free(const Napi::CallbackInfo& info) {
+  if (memory_) {
+    DetachBlocks();
+    {
+      std::lock_guard<std::mutex> lock(arenaMutex);
+      if (memory_->pins) memory_->freed = true;
+      else memory_->Unmap();
+    }
+    releaseMemory(memory_);
+    memory_ = nullptr;
+  }
+  return info.Env().Undefined();
+}
+
+Napi::Value Arena::Stats(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+  if (!Usable(env)) return env.Null();
+  size_t live = 0;
+  for (auto& ref : blocks_)
+    if (!ref.Value().IsEmpty()) live++;
+
+  Napi::Object stats = Napi::Object::New(env);
+  stats.Set("size", Napi::Number::New(env, static_cast<double>(memory_->size)));
+  stats.Set("used", Napi::Number::New(env, static_cast<double>(used_)));
+  stats.Set("free", Napi::Number::New(env, static_cast<double>(memory_->size - used_)));
+  stats.Set("peak", Napi::Number::New(env, static_cast<double>(peak_)));
+  stats.Set("alignment", Napi::Number::New(env, static_cast<double>(alignment_)));
+  stats.Set("allocations", Napi::Number::New(env, static_cast<double>(allocations_)));
+  stats.Set("liveBlocks", Napi::Number::New(env, static_cast<double>(live)));
+  stats.Set("pendingCalls", Napi::Number::New(env, static_cast<double>(PendingCalls())));
+  stats.Set("resets", Napi::Number::New(env, static_cast<double>(resets_)));
+  stats.Set("hugePages", Napi::Boolean::New(env, hugePages_));
+  stats.Set("locked", Napi::Boolean::New(env, locked_));
+  return stats;
+}
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <napi.h>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// The mapping behind an Arena. Blocks handed to JS hold a reference to it,
+// so it outlives the Arena object until every block has been collected.
+struct ArenaMemory;
+
+// Held by a native call that uses JS memory off the JS thread (the *Async
+// calls, parallelMapAsync, isolated pools). While a pin on an arena block
+// is held, reset() throws and free() defers the unmap until the last pin
+// is dropped. A pin on any other memory does nothing.
+class ArenaPin {
+ public:
+  explicit ArenaPin(const void* data);
+  ~ArenaPin();
+
+  ArenaPin(ArenaPin&& other) noexcept : memory_(other.memory_) { other.memory_ = nullptr; }
+  ArenaPin(const ArenaPin&) = delete;
+  ArenaPin& operator=(const ArenaPin&) = delete;
+
+ private:
+  ArenaMemory* memory_ = nullptr;
+};
+
+// Native memory pool returned by createArena({ size, alignment, hugePages, lock }).
+// One anonymous mapping is carved up by a bump allocator into aligned
+// blocks, each exposed as a TypedArray over an external ArrayBuffer, so JS
+// and native kernels work on the same memory without copying. reset()
+// rewinds the pool and free() unmaps it; both detach every block handed
+// out so far, so stale views read as empty instead of aliasing new data.
+class Arena : public Napi::ObjectWrap<Arena> {
+ public:
+  static Napi::Function Define(Napi::Env env);
+  static Napi::Value Create(const Napi::CallbackInfo& info);
+
+  Arena(const Napi::CallbackInfo& info);
+  ~Arena();
+
+ private:
+  Napi::Value Alloc(const Napi::CallbackInfo& info);
+  Napi::Value StructOfArrays(const Napi::CallbackInfo& info);
+  Napi::Value Reset(const Napi::CallbackInfo& info);
+  Napi::Value Free(const Napi::CallbackInfo& info);
+  Napi::Value Stats(const Napi::CallbackInfo& info);
+
+  bool Usable(Napi::Env env);
+  size_t PendingCalls() const;
+  size_t Alignment(Napi::Env env, const Napi::Value& options, size_t elementSize, bool& ok);
+  Napi::Value Block(Napi::Env env, napi_typedarray_type type, size_t count, size_t alignment);
+  void DetachBlocks();
+  void PruneBlocks(Napi::Env env);
+
+  ArenaMemory* memory_ = nullptr;
+  size_t used_ = 0;
+  size_t alignment_ = 64;
+  size_t baseAlignment_ = 0;
+  bool hugePages_ = false;
+  bool locked_ = false;
+
+  // Weak references to the blocks handed out since the last reset; those
+  // already collected are pruned once the list doubles in length
+  std::vector<Napi::Reference<Napi::ArrayBuffer>> blocks_;
+  size_t pruneAt_ = 64;
+  uint64_t allocations_ = 0;
+  uint64_t resets_ = 0;
+  size_t peak_ = 0;
+};
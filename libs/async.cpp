@@ -0,0 +1,120 @@
+#include "async.h"
+#include "capture.h"
+#include "core.h"
+#include "pool.h"
+
+#include <mutex>
+#include <string>
+#include <vector>
+
+struct AsyncJob;
+
+static void deliverAsync(Napi::Env env, Napi::Function, void*, AsyncJob* job);
+
+using CompletionQueue = Napi::TypedThreadSafeFunction<void, AsyncJob, deliverAsync>;
+
+// One thread-safe function per env carries every completion back to its JS
+// thread. It is only ref'd while calls are outstanding so an idle pool never
+// keeps the event loop alive. Jobs share ownership of the queue: one that
+// finishes after the env was torn down finds it closed instead of calling
+// into a released function.
+struct AsyncQueue {
+  CompletionQueue completions;
+  size_t pending = 0; // JS thread only
+  std::mutex mutex;
+  bool closed = false;
+};
+
+struct AsyncJob {
+  std::function<void()> work;
+  std::function<Napi::Value(Napi::Env)> done;
+  Napi::Promise::Deferred deferred;
+  std::vector<std::string> logs;
+  std::shared_ptr<AsyncQueue> queue;
+  std::shared_ptr<CaptureStream> capture;
+
+  AsyncJob(Napi::Env env, std::shared_ptr<AsyncQueue> queue)
+      : deferred(Napi::Promise::Deferred::New(env)), queue(std::move(queue)) {}
+};
+
+static void closeAsyncQueue(void* arg) {
+  auto* queue = static_cast<std::shared_ptr<AsyncQueue>*>(arg);
+  {
+    std::lock_guard<std::mutex> lock((*queue)->mutex);
+    (*queue)->closed = true;
+    (*queue)->completions.Release();
+  }
+  delete queue;
+}
+
+static void deliverAsync(Napi::Env env, Napi::Function, void*, AsyncJob* job) {
+  if (env != nullptr) {
+    Napi::HandleScope scope(env);
+    for (const std::string& message : job->logs) logToJs(message);
+
+    Napi::Value result = job->done(env);
+    if (env.IsExceptionPending()) {
+      job->deferred.Reject(env.GetAndClearPendingException().Value());
+    } else {
+      job->deferred.Resolve(result.IsEmpty() ? env.Undefined() : result);
+    }
+
+    if (--job->queue->pending == 0 && !job->queue->closed) job->queue->completions.Unref(env);
+  }
+  delete job;
+}
+
+Napi::Promise queueAsync(Napi::Env env, std::function<void()> work, std::function<Napi::Value(Napi::Env)> done) {
+  std::shared_ptr<AsyncQueue>& queue = addonData(env).async;
+  if (!queue) {
+    queue = std::make_shared<AsyncQueue>();
+    queue->completions = CompletionQueue::New(env, "sljs-async", 0, 1);
+    queue->completions.Unref(env);
+    napi_add_env_cleanup_hook(env, closeAsyncQueue, new std::shared_ptr<AsyncQueue>(queue));
+  }
+  if (queue->pending++ == 0) queue->completions.Ref(env);
+
+  auto* job = new AsyncJob(env, queue);
+  job->capture = addonData(env).capture;
+  job->work = std::move(work);
+  job->done = std::move(done);
+  Napi::Promise promise = job->deferred.Promise();
+
+  ThreadPool::shared().Submit([job]() {
+    deferredLogs = &job->logs;
+    deferredStream = job->capture.get();
+    job->work();
+    deferredLogs = nullptr;
+    deferredStream = nullptr;
+    // After the env is gone its handles cannot be freed from here, so a
+    // late job is left to leak
+    std::shared_ptr<AsyncQueue> queue = job->queue;
+    std::lock_guard<std::mutex> lock(queue->mutex);
+    if (!queue->closed) queue->completions.NonBlockingCall(job);
+  });
+  return promise;
+}
+
+// setThreadPoolSize(n)
+Napi::Value SetThreadPoolSize(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+  if (!info[0].IsNumber() || info[0].As<Napi::Number>().Int32Value() < 1) {
+    Napi::TypeError::New(env, "Expected a thread count >= 1").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+  ThreadPool::shared().Resize(info[0].As<Napi::Number>().Uint32Value());
+  return env.Undefined();
+}
+
+// getThreadPoolStats() -> { threads, queued, inFlight, pending }
+Napi::Value GetThreadPoolStats(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+  ThreadPool& pool = ThreadPool::shared();
+  Napi::Object stats = Napi::Object::New(env);
+  stats.Set("threads", Napi::Number::New(env, pool.Size()));
+  stats.Set("queued", Napi::Number::New(env, pool.Queued()));
+  stats.Set("inFlight", Napi::Number::New(env, pool.InFlight()));
+  const std::shared_ptr<AsyncQueue>& queue = addonData(env).async;
+  stats.Set("pending", Napi::Number::New(env, static_cast<double>(queue ? queue->pending : 0)));
+  return stats;
+}
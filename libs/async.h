@@ -0,0 +1,12 @@
+#pragma once
+
+#include <napi.h>
+#include <functional>
+
+// Runs `work` on the shared ThreadPool and settles the returned Promise on
+// the JS thread with the value `done` returns; if `done` throws (returns with
+// a pending exception) the Promise is rejected with that error instead.
+Napi::Promise queueAsync(Napi::Env env, std::function<void()> work, std::function<Napi::Value(Napi::Env)> done);
+
+Napi::Value SetThreadPoolSize(const Napi::CallbackInfo& info);
+Napi::Value GetThreadPoolStats(const Napi::CallbackInfo& info);
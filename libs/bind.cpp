@@ -0,0 +1,667 @@
+#include "bind.h"
+#include "typed.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstdint>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// Bound-call trampolines. Each signature gets its own napi_callback,
+// instantiated from the templates below, so a call does one cb_info fetch,
+// the argument conversions for that exact C type and the call itself:
+// no dlsym, no std::string symbol name and no switch on the signature.
+
+// JS -> C
+
+template <typename T> struct FromJs;
+
+template <> struct FromJs<int> {
+  static bool get(napi_env env, napi_value value, int& out) {
+    int32_t v;
+    if (napi_get_value_int32(env, value, &v) != napi_ok) return false;
+    out = v;
+    return true;
+  }
+};
+
+template <> struct FromJs<float> {
+  static bool get(napi_env env, napi_value value, float& out) {
+    double v;
+    if (napi_get_value_double(env, value, &v) != napi_ok) return false;
+    out = static_cast<float>(v);
+    return true;
+  }
+};
+
+template <> struct FromJs<double> {
+  static bool get(napi_env env, napi_value value, double& out) {
+    return napi_get_value_double(env, value, &out) == napi_ok;
+  }
+};
+
+// int64_t takes a BigInt, or a plain Number for convenience
+template <> struct FromJs<int64_t> {
+  static bool get(napi_env env, napi_value value, int64_t& out) {
+    bool lossless;
+    if (napi_get_value_bigint_int64(env, value, &out, &lossless) == napi_ok) return true;
+    return napi_get_value_int64(env, value, &out) == napi_ok;
+  }
+};
+
+// C -> JS
+
+template <typename T> struct ToJs;
+
+template <> struct ToJs<int> {
+  static napi_value make(napi_env env, int v) {
+    napi_value result;
+    napi_create_int32(env, v, &result);
+    return result;
+  }
+};
+
+template <> struct ToJs<float> {
+  static napi_value make(napi_env env, float v) {
+    napi_value result;
+    napi_create_double(env, v, &result);
+    return result;
+  }
+};
+
+template <> struct ToJs<double> {
+  static napi_value make(napi_env env, double v) {
+    napi_value result;
+    napi_create_double(env, v, &result);
+    return result;
+  }
+};
+
+template <> struct ToJs<int64_t> {
+  static napi_value make(napi_env env, int64_t v) {
+    napi_value result;
+    napi_create_bigint_int64(env, v, &result);
+    return result;
+  }
+};
+
+template <> struct ToJs<const char*> {
+  static napi_value make(napi_env env, const char* v) {
+    napi_value result;
+    if (v) napi_create_string_utf8(env, v, NAPI_AUTO_LENGTH, &result);
+    else napi_get_null(env, &result);
+    return result;
+  }
+};
+
+template <typename R, typename F>
+static napi_value convertResult(napi_env env, F&& call) {
+  if constexpr (std::is_void_v<R>) {
+    call();
+    napi_value result;
+    napi_get_undefined(env, &result);
+    return result;
+  } else {
+    return ToJs<R>::make(env, call());
+  }
+}
+
+template <typename R, typename F>
+static napi_value invoke(napi_env env, BoundSymbol* bound, F&& call) {
+  if (!statsEnabled()) return convertResult<R>(env, call);
+  if (!bound->stats) bound->stats = symbolStats(bound->lib->handle, bound->name);
+  return convertResult<R>(env, [&]() { return timedCall(bound->stats, call); });
+}
+
+static napi_value throwArgumentError(napi_env env, const BoundSymbol* bound) {
+  std::string message = "Invalid arguments for " + bound->name + ": expected " + bound->signature->name;
+  napi_throw_type_error(env, nullptr, message.c_str());
+  return nullptr;
+}
+
+static BoundSymbol* fetchArgs(napi_env env, napi_callback_info cbinfo, napi_value* argv, size_t argc) {
+  void* data = nullptr;
+  napi_get_cb_info(env, cbinfo, &argc, argv, nullptr, &data);
+  return static_cast<BoundSymbol*>(data);
+}
+
+// R fn(A...) with one JS argument per C argument
+
+template <typename R, typename... A, size_t... I>
+static napi_value callScalarWith(napi_env env, BoundSymbol* bound, napi_value* argv, std::index_sequence<I...>) {
+  std::tuple<A...> args;
+  if (!(true && ... && FromJs<A>::get(env, argv[I], std::get<I>(args)))) return throwArgumentError(env, bound);
+
+  auto fn = reinterpret_cast<R(*)(A...)>(bound->fn);
+  return invoke<R>(env, bound, [&]() { return fn(std::get<I>(args)...); });
+}
+
+template <typename R, typename... A>
+static napi_value callScalar(napi_env env, napi_callback_info cbinfo) {
+  napi_value argv[sizeof...(A) + 1];
+  BoundSymbol* bound = fetchArgs(env, cbinfo, argv, sizeof...(A));
+  return callScalarWith<R, A...>(env, bound, argv, std::index_sequence_for<A...>{});
+}
+
+// R fn(int argc, const char** argv) called with one JS array of strings.
+// The scratch vectors keep their capacity, so steady-state calls with
+// similar arguments do not allocate. They are per thread, so each
+// worker_thread gets its own.
+
+struct ArgvScratch {
+  std::vector<std::string> strings;
+  std::vector<const char*> pointers;
+};
+
+static bool argvFromJs(napi_env env, napi_value value, ArgvScratch& scratch) {
+  bool isArray = false;
+  if (napi_is_array(env, value, &isArray) != napi_ok || !isArray) return false;
+
+  uint32_t length = 0;
+  napi_get_array_length(env, value, &length);
+  if (scratch.strings.size() < length) scratch.strings.resize(length);
+  scratch.pointers.resize(length);
+
+  for (uint32_t i = 0; i < length; ++i) {
+    napi_value item;
+    napi_get_element(env, value, i, &item);
+
+    size_t size = 0;
+    if (napi_get_value_string_utf8(env, item, nullptr, 0, &size) != napi_ok) return false;
+    std::string& s = scratch.strings[i];
+    s.resize(size);
+    napi_get_value_string_utf8(env, item, &s[0], size + 1, &size);
+    scratch.pointers[i] = s.c_str();
+  }
+  return true;
+}
+
+template <typename R>
+static napi_value callArgv(napi_env env, napi_callback_info cbinfo) {
+  static thread_local ArgvScratch scratch;
+  napi_value argv[1];
+  BoundSymbol* bound = fetchArgs(env, cbinfo, argv, 1);
+  if (!argvFromJs(env, argv[0], scratch)) return throwArgumentError(env, bound);
+
+  auto fn = reinterpret_cast<R(*)(int, const char**)>(bound->fn);
+  return invoke<R>(env, bound, [&]() { return fn(static_cast<int>(scratch.pointers.size()), scratch.pointers.data()); });
+}
+
+// R fn(uint8_t* data, size_t length) called with one Buffer / TypedArray / ArrayBuffer
+
+bool viewBytes(napi_env env, napi_value value, uint8_t*& data, size_t& length) {
+  bool is = false;
+  void* raw = nullptr;
+
+  if (napi_is_typedarray(env, value, &is) == napi_ok && is) {
+    napi_typedarray_type type;
+    size_t count;
+    if (napi_get_typedarray_info(env, value, &type, &count, &raw, nullptr, nullptr) != napi_ok) return false;
+    size_t width = 1;
+    switch (type) {
+      case napi_int16_array: case napi_uint16_array: width = 2; break;
+      case napi_int32_array: case napi_uint32_array: case napi_float32_array: width = 4; break;
+      case napi_float64_array: case napi_bigint64_array: case napi_biguint64_array: width = 8; break;
+      default: break;
+    }
+    data = static_cast<uint8_t*>(raw);
+    length = count * width;
+    return true;
+  }
+
+  if (napi_is_dataview(env, value, &is) == napi_ok && is) {
+    if (napi_get_dataview_info(env, value, &length, &raw, nullptr, nullptr) != napi_ok) return false;
+    data = static_cast<uint8_t*>(raw);
+    return true;
+  }
+
+  if (napi_is_arraybuffer(env, value, &is) == napi_ok && is) {
+    if (napi_get_arraybuffer_info(env, value, &raw, &length) != napi_ok) return false;
+    data = static_cast<uint8_t*>(raw);
+    return true;
+  }
+
+  // N-API has no accessor for a bare SharedArrayBuffer; a Uint8Array over
+  // it shares the same backing store.
+  napi_value global, ctor, view;
+  if (napi_get_global(env, &global) != napi_ok ||
+      napi_get_named_property(env, global, "SharedArrayBuffer", &ctor) != napi_ok ||
+      napi_instanceof(env, value, ctor, &is) != napi_ok || !is)
+    return false;
+  if (napi_get_named_property(env, global, "Uint8Array", &ctor) != napi_ok ||
+      napi_new_instance(env, ctor, 1, &value, &view) != napi_ok)
+    return false;
+  return viewBytes(env, view, data, length);
+}
+
+napi_value newSharedArrayBuffer(napi_env env, size_t size, uint8_t*& data) {
+  // N-API cannot allocate a SharedArrayBuffer directly, so the JS constructor does
+  napi_value global, ctor, length, buffer;
+  size_t actual = 0;
+  if (napi_get_global(env, &global) != napi_ok ||
+      napi_get_named_property(env, global, "SharedArrayBuffer", &ctor) != napi_ok ||
+      napi_create_double(env, static_cast<double>(size), &length) != napi_ok ||
+      napi_new_instance(env, ctor, 1, &length, &buffer) != napi_ok || !viewBytes(env, buffer, data, actual))
+    return nullptr;
+  return buffer;
+}
+
+template <typename R>
+static napi_value callBytes(napi_env env, napi_callback_info cbinfo) {
+  napi_value argv[1];
+  BoundSymbol* bound = fetchArgs(env, cbinfo, argv, 1);
+  uint8_t* data = nullptr;
+  size_t length = 0;
+  if (!viewBytes(env, argv[0], data, length)) return throwArgumentError(env, bound);
+
+  auto fn = reinterpret_cast<R(*)(uint8_t*, size_t)>(bound->fn);
+  return invoke<R>(env, bound, [&]() { return fn(data, length); });
+}
+
+// Batched calls: runBatch() loops natively over many argument tuples
+// against one resolved pointer. Results go into one preallocated column
+// (a TypedArray for numbers, an Array for strings) in input order, and
+// items whose arguments fail to convert are flagged in an error bitmap
+// instead of throwing halfway through.
+
+template <typename T> struct Column;
+template <> struct Column<int> { using Element = int32_t; static constexpr napi_typedarray_type type = napi_int32_array; };
+template <> struct Column<float> { using Element = float; static constexpr napi_typedarray_type type = napi_float32_array; };
+template <> struct Column<double> { using Element = double; static constexpr napi_typedarray_type type = napi_float64_array; };
+template <> struct Column<int64_t> { using Element = int64_t; static constexpr napi_typedarray_type type = napi_bigint64_array; };
+
+template <typename R>
+struct BatchResults {
+  using Element = typename Column<R>::Element;
+
+  BatchResults(napi_env env, size_t count) : env(env), count(count) {
+    void* raw = nullptr;
+    if (napi_create_arraybuffer(env, count * sizeof(Element), &raw, &buffer) == napi_ok) data = static_cast<Element*>(raw);
+  }
+  bool ok() const { return data != nullptr; }
+  void set(size_t i, R value) { data[i] = value; }
+  napi_value finish() {
+    napi_value array;
+    napi_create_typedarray(env, Column<R>::type, count, buffer, 0, &array);
+    return array;
+  }
+
+  napi_env env;
+  size_t count;
+  napi_value buffer;
+  Element* data = nullptr;
+};
+
+template <>
+struct BatchResults<const char*> {
+  BatchResults(napi_env env, size_t count) : env(env) {
+    valid = napi_create_array_with_length(env, count, &array) == napi_ok;
+  }
+  bool ok() const { return valid; }
+  void set(size_t i, const char* value) { napi_set_element(env, array, i, ToJs<const char*>::make(env, value)); }
+  napi_value finish() { return array; }
+
+  napi_env env;
+  napi_value array;
+  bool valid;
+};
+
+template <>
+struct BatchResults<void> {
+  BatchResults(napi_env env, size_t) : env(env) {}
+  bool ok() const { return true; }
+  napi_value finish() {
+    napi_value undefined;
+    napi_get_undefined(env, &undefined);
+    return undefined;
+  }
+
+  napi_env env;
+};
+
+struct BatchErrors {
+  BatchErrors(napi_env env, size_t count) : count(count) {
+    void* raw = nullptr;
+    if (napi_create_arraybuffer(env, (count + 7) / 8, &raw, &buffer) == napi_ok) bits = static_cast<uint8_t*>(raw); // zero-filled
+  }
+  bool ok() const { return bits != nullptr || count == 0; }
+  void mark(size_t i) {
+    bits[i >> 3] |= static_cast<uint8_t>(1u << (i & 7));
+    failed++;
+  }
+
+  size_t count;
+  size_t failed = 0;
+  napi_value buffer;
+  uint8_t* bits = nullptr;
+};
+
+template <typename R, typename F>
+static void storeResult(BatchResults<R>& results, size_t i, SymbolStats* stats, F&& call) {
+  if constexpr (std::is_void_v<R>) timedCall(stats, call);
+  else results.set(i, timedCall(stats, call));
+}
+
+template <typename R>
+static napi_value finishBatch(napi_env env, BatchResults<R>& results, BatchErrors& errors) {
+  napi_value out, value;
+  napi_create_object(env, &out);
+  napi_set_named_property(env, out, "results", results.finish());
+  napi_create_typedarray(env, napi_uint8_array, (errors.count + 7) / 8, errors.buffer, 0, &value);
+  napi_set_named_property(env, out, "errors", value);
+  napi_create_uint32(env, static_cast<uint32_t>(errors.failed), &value);
+  napi_set_named_property(env, out, "errorCount", value);
+  napi_create_uint32(env, static_cast<uint32_t>(errors.count), &value);
+  napi_set_named_property(env, out, "count", value);
+  return out;
+}
+
+// Largest plain call count runBatch accepts for a zero-parameter signature
+static constexpr uint32_t kMaxBatchCount = 1u << 26;
+
+static napi_value throwBatchError(napi_env env, const char* message) {
+  napi_throw_type_error(env, nullptr, message);
+  return nullptr;
+}
+
+// Results and the error bitmap are allocated up front; a failed allocation
+// usually leaves its own RangeError pending
+template <typename R>
+static bool batchAllocated(napi_env env, const BatchResults<R>& results, const BatchErrors& errors) {
+  if (results.ok() && errors.ok()) return true;
+  bool pending = false;
+  napi_is_exception_pending(env, &pending);
+  if (!pending) napi_throw_range_error(env, nullptr, "Could not allocate the batch results");
+  return false;
+}
+
+static bool batchLength(napi_env env, napi_value items, uint32_t& count) {
+  bool isArray = false;
+  if (napi_is_array(env, items, &isArray) != napi_ok || !isArray) return false;
+  return napi_get_array_length(env, items, &count) == napi_ok;
+}
+
+// A packed TypedArray can stand in for the tuple list when every parameter
+// has the same numeric type: `count * arity` elements, row after row.
+template <typename... A> struct PackedArgs { static constexpr bool enabled = false; };
+template <typename T, typename... Rest> struct PackedArgs<T, Rest...> {
+  static constexpr bool enabled = (std::is_same_v<T, Rest> && ...);
+  using Element = typename Column<T>::Element;
+  static constexpr napi_typedarray_type type = Column<T>::type;
+};
+
+template <typename R, typename... A, size_t... I>
+static napi_value batchPacked(napi_env env, R (*fn)(A...), napi_value items, SymbolStats* stats, std::index_sequence<I...>) {
+  using Packed = PackedArgs<A...>;
+  constexpr size_t arity = sizeof...(A);
+
+  napi_typedarray_type type;
+  size_t length;
+  void* raw = nullptr;
+  napi_get_typedarray_info(env, items, &type, &length, &raw, nullptr, nullptr);
+  if (type != Packed::type || length % arity != 0)
+    return throwBatchError(env, "Packed arguments must be a TypedArray of the parameter type with count * arity elements");
+
+  size_t count = length / arity;
+  auto* row = static_cast<typename Packed::Element*>(raw);
+  BatchResults<R> results(env, count);
+  BatchErrors errors(env, count);
+  if (!batchAllocated(env, results, errors)) return nullptr;
+  for (size_t i = 0; i < count; ++i, row += arity)
+    storeResult(results, i, stats, [&]() { return fn(static_cast<A>(row[I])...); });
+  return finishBatch(env, results, errors);
+}
+
+template <typename... A, size_t... I>
+static bool tupleFromJs(napi_env env, napi_value item, std::tuple<A...>& args, std::index_sequence<I...>) {
+  bool isArray = false;
+  napi_is_array(env, item, &isArray);
+
+  // Single-parameter signatures accept bare values instead of 1-tuples
+  if (!isArray) {
+    if constexpr (sizeof...(A) == 1) return FromJs<std::tuple_element_t<0, std::tuple<A...>>>::get(env, item, std::get<0>(args));
+    else return false;
+  }
+
+  napi_value element;
+  return (true && ... && (napi_get_element(env, item, I, &element) == napi_ok &&
+                          FromJs<A>::get(env, element, std::get<I>(args))));
+}
+
+template <typename R, typename... A>
+static napi_value batchScalar(napi_env env, void* fnptr, napi_value items, SymbolStats* stats) {
+  auto fn = reinterpret_cast<R(*)(A...)>(fnptr);
+  auto indices = std::index_sequence_for<A...>{};
+
+  bool isTyped = false;
+  napi_is_typedarray(env, items, &isTyped);
+  if (isTyped) {
+    if constexpr (sizeof...(A) > 0 && PackedArgs<A...>::enabled) return batchPacked(env, fn, items, stats, indices);
+    else return throwBatchError(env, "This signature cannot take packed arguments");
+  }
+
+  // Zero-parameter signatures also accept a plain call count
+  uint32_t count = 0;
+  if constexpr (sizeof...(A) == 0) {
+    double requested;
+    if (napi_get_value_double(env, items, &requested) == napi_ok) {
+      if (!(requested >= 0 && requested <= kMaxBatchCount) || requested != std::floor(requested)) {
+        std::string message = "Call count must be an integer from 0 to " + std::to_string(kMaxBatchCount);
+        napi_throw_range_error(env, nullptr, message.c_str());
+        return nullptr;
+      }
+      count = static_cast<uint32_t>(requested);
+    } else if (!batchLength(env, items, count)) {
+      return throwBatchError(env, "Expected a call count or an array");
+    }
+  } else if (!batchLength(env, items, count)) {
+    return throwBatchError(env, "Expected an array of argument tuples or a packed TypedArray");
+  }
+
+  BatchResults<R> results(env, count);
+  BatchErrors errors(env, count);
+  if (!batchAllocated(env, results, errors)) return nullptr;
+  std::tuple<A...> args;
+  for (uint32_t i = 0; i < count; ++i) {
+    if constexpr (sizeof...(A) > 0) {
+      napi_value item;
+      napi_get_element(env, items, i, &item);
+      if (!tupleFromJs(env, item, args, indices)) {
+        errors.mark(i);
+        continue;
+      }
+    }
+    storeResult(results, i, stats, [&]() { return std::apply(fn, args); });
+  }
+  return finishBatch(env, results, errors);
+}
+
+template <typename R>
+static napi_value batchArgv(napi_env env, void* fnptr, napi_value items, SymbolStats* stats) {
+  static thread_local ArgvScratch scratch;
+  auto fn = reinterpret_cast<R(*)(int, const char**)>(fnptr);
+
+  uint32_t count = 0;
+  if (!batchLength(env, items, count)) return throwBatchError(env, "Expected an array of string arrays");
+
+  BatchResults<R> results(env, count);
+  BatchErrors errors(env, count);
+  if (!batchAllocated(env, results, errors)) return nullptr;
+  for (uint32_t i = 0; i < count; ++i) {
+    napi_value item;
+    napi_get_element(env, items, i, &item);
+    if (!argvFromJs(env, item, scratch)) {
+      errors.mark(i);
+      continue;
+    }
+    storeResult(results, i, stats, [&]() { return fn(static_cast<int>(scratch.pointers.size()), scratch.pointers.data()); });
+  }
+  return finishBatch(env, results, errors);
+}
+
+template <typename R>
+static napi_value batchBytes(napi_env env, void* fnptr, napi_value items, SymbolStats* stats) {
+  auto fn = reinterpret_cast<R(*)(uint8_t*, size_t)>(fnptr);
+
+  uint32_t count = 0;
+  if (!batchLength(env, items, count)) return throwBatchError(env, "Expected an array of buffers");
+
+  BatchResults<R> results(env, count);
+  BatchErrors errors(env, count);
+  if (!batchAllocated(env, results, errors)) return nullptr;
+  for (uint32_t i = 0; i < count; ++i) {
+    napi_value item;
+    napi_get_element(env, items, i, &item);
+    uint8_t* data = nullptr;
+    size_t length = 0;
+    if (!viewBytes(env, item, data, length)) {
+      errors.mark(i);
+      continue;
+    }
+    storeResult(results, i, stats, [&]() { return fn(data, length); });
+  }
+  return finishBatch(env, results, errors);
+}
+
+// Signature table
+
+template <typename R, typename... A>
+static constexpr SignatureEntry scalarEntry(const char* name) { return { name, &callScalar<R, A...>, &batchScalar<R, A...> }; }
+
+template <typename R>
+static constexpr SignatureEntry argvEntry(const char* name) { return { name, &callArgv<R>, &batchArgv<R> }; }
+
+template <typename R>
+static constexpr SignatureEntry bytesEntry(const char* name) { return { name, &callBytes<R>, &batchBytes<R> }; }
+
+static const SignatureEntry signatureTable[] = {
+  scalarEntry<void>("void()"),
+  scalarEntry<int>("int()"),
+  scalarEntry<float>("float()"),
+  scalarEntry<double>("double()"),
+  scalarEntry<int64_t>("int64_t()"),
+  scalarEntry<const char*>("const char*()"),
+
+  scalarEntry<void, int>("void(int)"),
+  scalarEntry<void, float>("void(float)"),
+  scalarEntry<void, double>("void(double)"),
+  scalarEntry<void, int64_t>("void(int64_t)"),
+  scalarEntry<int, int>("int(int)"),
+  scalarEntry<int, int, int>("int(int,int)"),
+  scalarEntry<float, float>("float(float)"),
+  scalarEntry<double, double>("double(double)"),
+  scalarEntry<double, double, double>("double(double,double)"),
+  scalarEntry<int64_t, int64_t>("int64_t(int64_t)"),
+  scalarEntry<int64_t, int64_t, int64_t>("int64_t(int64_t,int64_t)"),
+  scalarEntry<const char*, int>("const char*(int)"),
+
+  argvEntry<void>("void(int,const char**)"),
+  argvEntry<int>("int(int,const char**)"),
+  argvEntry<double>("double(int,const char**)"),
+  argvEntry<const char*>("const char*(int,const char**)"),
+
+  bytesEntry<void>("void(uint8_t*,size_t)"),
+  bytesEntry<int>("int(uint8_t*,size_t)"),
+  bytesEntry<double>("double(uint8_t*,size_t)"),
+  bytesEntry<int64_t>("int64_t(uint8_t*,size_t)"),
+};
+
+static std::string normalizeSignature(const std::string& signature) {
+  std::string out;
+  for (char c : signature)
+    if (!std::isspace(static_cast<unsigned char>(c))) out += c;
+
+  // "constchar*" is what "const char*" collapses to once spaces are gone
+  size_t pos;
+  while ((pos = out.find("int32_t")) != std::string::npos) out.replace(pos, 7, "int");
+  while ((pos = out.find("constchar")) != std::string::npos) out.replace(pos, 9, "const char");
+  return out;
+}
+
+const SignatureEntry* findSignature(const std::string& signature) {
+  std::string wanted = normalizeSignature(signature);
+  for (const SignatureEntry& entry : signatureTable)
+    if (wanted == entry.name) return &entry;
+  return nullptr;
+}
+
+Napi::Array listSignatures(Napi::Env env) {
+  size_t count = sizeof(signatureTable) / sizeof(signatureTable[0]);
+  Napi::Array list = Napi::Array::New(env, count);
+  for (size_t i = 0; i < count; ++i)
+    list.Set(i, Napi::String::New(env, signatureTable[i].name));
+  return list;
+}
+
+static void finalizeBound(napi_env, void* data, void*) {
+  auto* bound = static_cast<BoundSymbol*>(data);
+  releaseLibrary(bound->lib);
+  delete bound;
+}
+
+Napi::Value bindSymbol(Napi::Env env, SharedLibrary* lib, const std::string& symbol, const std::string& signature,
+                       const std::shared_ptr<BindingSet>& registry) {
+  const SignatureEntry* entry = findSignature(signature);
+  if (!entry) return bindTypedSymbol(env, lib, symbol, signature, registry);
+
+  std::string err;
+  void* fn = safeDlsym<void*>(lib->handle, symbol, err);
+  if (!fn) {
+    Napi::Error::New(env, "[ERROR] symbol lookup: " + err).ThrowAsJavaScriptException();
+    return Napi::Value();
+  }
+
+  auto* bound = new BoundSymbol();
+  bound->fn = fn;
+  bound->lib = lib;
+  bound->name = symbol;
+  bound->signature = entry;
+  retainLibrary(lib);
+  if (registry) {
+    bound->registry = registry;
+    registry->insert(bound);
+  }
+
+  napi_value result;
+  napi_create_function(env, symbol.c_str(), symbol.size(), entry->call, bound, &result);
+  napi_add_finalizer(env, result, bound, finalizeBound, nullptr, nullptr);
+  return Napi::Function(env, result);
+}
+
+// runBatch(pathOrLibrary, symbol, signature, argsList)
+Napi::Value RunBatch(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+  if (!info[1].IsString() || !info[2].IsString()) {
+    Napi::TypeError::New(env, "Expected (library, symbol, signature, argsList)").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  const SignatureEntry* entry = findSignature(info[2].As<Napi::String>());
+  if (!entry) {
+    Napi::TypeError::New(env, "Unsupported signature: " + info[2].As<Napi::String>().Utf8Value()).ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  std::string err;
+  LibraryLease lib = leaseLibrary(info[0], err);
+  if (!lib) {
+    Napi::Error::New(env, "[ERROR] dlopen failed: " + err).ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  std::string symbol = info[1].As<Napi::String>();
+  void* fn = safeDlsym<void*>(lib.handle(), symbol, err);
+  if (!fn) {
+    recordSymbolError(lib.handle(), symbol);
+    Napi::Error::New(env, "[ERROR] symbol lookup: " + err).ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  // Each item is one call, so each adds its own sample, as a bound call would
+  napi_value result = entry->batch(env, fn, info[3], statsEnabled() ? symbolStats(lib.handle(), symbol) : nullptr);
+  if (!result) return env.Null();
+  return Napi::Value(env, result);
+}
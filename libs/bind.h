@@ -0,0 +1,45 @@
+#pragma once
+
+#include <napi.h>
+#include <string>
+#include "library.h"
+
+struct SignatureEntry;
+struct SymbolStats;
+
+// State behind a bound JS function: the resolved pointer plus a reference
+// that keeps its library loaded for as long as the function is reachable.
+struct BoundSymbol : SymbolBinding {
+  const SignatureEntry* signature = nullptr;
+};
+
+// One row of the signature table: `call` is the bound-function trampoline
+// for that C type and `batch` the runBatch loop over an argument list,
+// recording one sample per call into `stats` unless that is null.
+struct SignatureEntry {
+  const char* name;
+  napi_callback call;
+  napi_value (*batch)(napi_env env, void* fn, napi_value items, SymbolStats* stats);
+};
+
+// Raw pointer and byte length of a Buffer, TypedArray, DataView, ArrayBuffer
+// or SharedArrayBuffer (no copy)
+bool viewBytes(napi_env env, napi_value value, uint8_t*& data, size_t& length);
+
+// Zero-filled SharedArrayBuffer of `size` bytes and its backing store. It
+// cannot be detached, so native threads may keep writing to `data` for as
+// long as a reference holds the buffer. Returns nullptr on failure.
+napi_value newSharedArrayBuffer(napi_env env, size_t size, uint8_t*& data);
+
+// Whitespace-insensitive lookup ("const char* (int, const char**)" works too)
+const SignatureEntry* findSignature(const std::string& signature);
+Napi::Array listSignatures(Napi::Env env);
+
+// Resolves `symbol` once and wraps it in a JS function. Signatures outside
+// the table go through the typed calling convention (typed.h); throws and
+// returns an empty value when neither can handle it or the symbol is missing.
+// With a `registry` the function follows its Library across hot reloads.
+Napi::Value bindSymbol(Napi::Env env, SharedLibrary* lib, const std::string& symbol, const std::string& signature,
+                       const std::shared_ptr<BindingSet>& registry = nullptr);
+
+Napi::Value RunBatch(const Napi::CallbackInfo& info);
@@ -0,0 +1,123 @@
+#include "buffers.h"
+#include "bind.h"
+#include "library.h"
+#include "stats.h"
+#include "sljs.h"
+
+#include <cstring>
+#include <string>
+#include <vector>
+
+// Pointers go straight from the JS views' backing stores into the call,
+// so nothing is copied in either direction. Views must not be detached or
+// resized by the library; their lifetime ends with the call.
+static bool collectViews(Napi::Env env, const Napi::Value& list, std::vector<sljs_buffer>& views) {
+  if (!list.IsArray()) {
+    Napi::TypeError::New(env, "Expected an array of TypedArray, DataView, ArrayBuffer or SharedArrayBuffer").ThrowAsJavaScriptException();
+    return false;
+  }
+
+  Napi::Array items = list.As<Napi::Array>();
+  views.resize(items.Length());
+  for (uint32_t i = 0; i < items.Length(); ++i) {
+    uint8_t* data = nullptr;
+    size_t length = 0;
+    if (!viewBytes(env, items.Get(i), data, length)) {
+      Napi::TypeError::New(env, "Buffer " + std::to_string(i) + " is not a TypedArray, DataView, ArrayBuffer or SharedArrayBuffer").ThrowAsJavaScriptException();
+      return false;
+    }
+    views[i] = { data, length };
+  }
+  return true;
+}
+
+template <typename T>
+static T resolve(Napi::Env env, const LibraryLease& lib, const std::string& symbol) {
+  std::string error;
+  T fn = safeDlsym<T>(lib.handle(), symbol, error);
+  if (!fn) {
+    recordSymbolError(lib.handle(), symbol);
+    Napi::Error::New(env, "Symbol not found: " + symbol + ": " + error).ThrowAsJavaScriptException();
+  }
+  return fn;
+}
+
+Napi::Value RunBuffers(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+  std::string error;
+  LibraryLease lib = leaseLibrary(info[0], error);
+  if (!lib) {
+    Napi::Error::New(env, error).ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  std::string symbol = info[1].As<Napi::String>();
+  auto fn = resolve<sljs_buffers_fn>(env, lib, symbol);
+  if (!fn) return env.Null();
+
+  std::vector<sljs_buffer> views;
+  if (!collectViews(env, info[2], views)) return env.Null();
+
+  return Napi::Number::New(env, timedCall(lib.handle(), symbol, [&]() { return fn(views.data(), views.size()); }));
+}
+
+// Finalizer state of an external ArrayBuffer: the library's free function
+// plus a reference that keeps the library (and so that function) loaded.
+struct NativeAllocation {
+  sljs_free_fn release;
+  SharedLibrary* lib;
+};
+
+static void freeNativeAllocation(napi_env, void* data, void* hint) {
+  auto* allocation = static_cast<NativeAllocation*>(hint);
+  allocation->release(data);
+  releaseLibrary(allocation->lib);
+  delete allocation;
+}
+
+Napi::Value RunBufferAlloc(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+  std::string error;
+  LibraryLease lib = leaseLibrary(info[0], error);
+  if (!lib) {
+    Napi::Error::New(env, error).ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  std::string symbol = info[1].As<Napi::String>();
+  std::string freeSymbol = info[3].IsString() ? info[3].As<Napi::String>().Utf8Value() : SLJS_DEFAULT_FREE;
+
+  // Both symbols are resolved before the call so a missing free function
+  // can never leak a result.
+  auto fn = resolve<sljs_alloc_fn>(env, lib, symbol);
+  if (!fn) return env.Null();
+  auto release = resolve<sljs_free_fn>(env, lib, freeSymbol);
+  if (!release) return env.Null();
+
+  std::vector<sljs_buffer> views;
+  if (!collectViews(env, info[2], views)) return env.Null();
+
+  sljs_buffer out = { nullptr, 0 };
+  int status = timedCall(lib.handle(), symbol, [&]() { return fn(views.data(), views.size(), &out); });
+  if (status != 0) {
+    recordSymbolError(lib.handle(), symbol);
+    if (out.data) release(out.data);
+    Napi::Error::New(env, symbol + " failed with status " + std::to_string(status)).ThrowAsJavaScriptException();
+    return env.Null();
+  }
+  if (!out.data) return Napi::ArrayBuffer::New(env, 0);
+
+  auto* allocation = new NativeAllocation{ release, lib.get() };
+  retainLibrary(allocation->lib);
+
+  napi_value result;
+  napi_status created = napi_create_external_arraybuffer(env, out.data, out.length, freeNativeAllocation, allocation, &result);
+  if (created == napi_ok) return Napi::Value(env, result);
+
+  // Runtimes with a memory sandbox refuse external backing stores; fall
+  // back to one copy and free the native block right away.
+  Napi::ArrayBuffer copy = Napi::ArrayBuffer::New(env, out.length);
+  memcpy(copy.Data(), out.data, out.length);
+  freeNativeAllocation(env, out.data, allocation);
+  return copy;
+}
@@ -0,0 +1,12 @@
+#pragma once
+
+#include <napi.h>
+
+// Zero-copy buffer calls using the sljs_buffer ABI from include/sljs.h.
+
+// runBuffers(lib, symbol, [views...]) -> int returned by the symbol
+Napi::Value RunBuffers(const Napi::CallbackInfo& info);
+
+// runBufferAlloc(lib, symbol, [views...], freeSymbol = "sljs_free") -> ArrayBuffer
+// backed by the memory the library allocated, freed by freeSymbol on GC.
+Napi::Value RunBufferAlloc(const Napi::CallbackInfo& info);
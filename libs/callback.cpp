@@ -0,0 +1,326 @@
+#include "callback.h"
+#include "channel.h"
+#include "core.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <unordered_map>
+#include <vector>
+
+static constexpr uint64_t kDefaultCapacity = 256 << 10;
+static constexpr uint64_t kMinCapacity = 4096;
+static constexpr uint64_t kMaxCapacity = 1u << 30;
+
+struct CallbackTarget {
+  sljs_ring* ring = nullptr;
+  std::atomic<bool> open{true};
+  std::atomic<uint32_t> calls{0}; // invokeCallback calls past the open check
+};
+
+// The function pointer handed to the library. Each call becomes one ring
+// record: the key followed by a copy of the data. A commit may notify the
+// wrapper, so the whole call is counted and Shutdown() waits for it.
+static int invokeCallback(void* context, uint64_t key, const void* data, uint32_t length) {
+  auto* target = static_cast<CallbackTarget*>(context);
+  if (length > UINT32_MAX - sizeof(key)) return -1;
+  target->calls.fetch_add(1, std::memory_order_seq_cst);
+  int status = -1;
+  if (target->open.load(std::memory_order_seq_cst)) {
+    auto* payload = static_cast<uint8_t*>(sljs_ring_reserve(target->ring, length + sizeof(key)));
+    if (payload) {
+      memcpy(payload, &key, sizeof(key));
+      if (length) memcpy(payload + sizeof(key), data, length);
+      sljs_ring_commit(target->ring, payload);
+      status = 0;
+    }
+  }
+  target->calls.fetch_sub(1, std::memory_order_release);
+  return status;
+}
+
+Napi::Function NativeCallback::Define(Napi::Env env) {
+  Napi::Function ctor = DefineClass(env, "NativeCallback", {
+    InstanceMethod("close", &NativeCallback::Close),
+    InstanceMethod("stats", &NativeCallback::Stats),
+    InstanceAccessor("handle", &NativeCallback::GetHandle, nullptr),
+    InstanceAccessor("open", &NativeCallback::GetOpen, nullptr),
+  });
+  addonData(env).callback = Napi::Persistent(ctor);
+  return ctor;
+}
+
+// createCallback(lib, { onCall, register, unregister, maxBatch, maxLatency, coalesce, capacity })
+Napi::Value NativeCallback::Create(const Napi::CallbackInfo& info) {
+  return addonData(info.Env()).callback.New({ info[0], info[1] });
+}
+
+NativeCallback::NativeCallback(const Napi::CallbackInfo& info) : Napi::ObjectWrap<NativeCallback>(info) {
+  Napi::Env env = info.Env();
+  std::string error;
+  lib_ = leaseLibrary(info[0], error);
+  if (!lib_) {
+    Napi::Error::New(env, error).ThrowAsJavaScriptException();
+    return;
+  }
+  if (!info[1].IsObject() || !info[1].As<Napi::Object>().Get("onCall").IsFunction()) {
+    Napi::TypeError::New(env, "Expected options with an onCall function").ThrowAsJavaScriptException();
+    return;
+  }
+  Napi::Object options = info[1].As<Napi::Object>();
+
+  int (*registerFn)(sljs_callback_fn, void*) = nullptr;
+  std::string registerSymbol;
+  if (options.Get("register").IsString()) {
+    registerSymbol = options.Get("register").As<Napi::String>();
+    registerFn = safeDlsym<int(*)(sljs_callback_fn, void*)>(lib_.handle(), registerSymbol, error);
+    if (!registerFn) {
+      Napi::Error::New(env, "Symbol not found: " + registerSymbol + ": " + error).ThrowAsJavaScriptException();
+      return;
+    }
+  }
+  if (options.Get("unregister").IsString()) {
+    std::string unregisterSymbol = options.Get("unregister").As<Napi::String>();
+    unregister_ = safeDlsym<void(*)(void*)>(lib_.handle(), unregisterSymbol, error);
+    if (!unregister_) {
+      Napi::Error::New(env, "Symbol not found: " + unregisterSymbol + ": " + error).ThrowAsJavaScriptException();
+      return;
+    }
+  }
+
+  if (options.Get("maxBatch").IsNumber())
+    maxBatch_ = static_cast<uint32_t>(std::clamp<int64_t>(options.Get("maxBatch").As<Napi::Number>().Int64Value(), 1, UINT32_MAX));
+  if (options.Get("maxLatency").IsNumber())
+    maxLatency_ = std::chrono::milliseconds(std::max<int64_t>(0, options.Get("maxLatency").As<Napi::Number>().Int64Value()));
+  coalesce_ = options.Get("coalesce").ToBoolean().Value();
+
+  uint64_t capacity = kDefaultCapacity;
+  if (options.Get("capacity").IsNumber()) {
+    int64_t requested = options.Get("capacity").As<Napi::Number>().Int64Value();
+    capacity = kMinCapacity;
+    while (capacity < static_cast<uint64_t>(std::max<int64_t>(requested, 0)) && capacity < kMaxCapacity) capacity <<= 1;
+  }
+
+  // Unlike a channel's, this ring is private to the addon, so it lives on
+  // the native heap rather than in a SharedArrayBuffer
+  target_ = new CallbackTarget();
+  target_->ring = static_cast<sljs_ring*>(aligned_alloc(64, SLJS_RING_HEADER + capacity));
+  if (!target_->ring) {
+    delete target_;
+    target_ = nullptr;
+    Napi::Error::New(env, "Could not allocate the callback queue").ThrowAsJavaScriptException();
+    return;
+  }
+  memset(target_->ring, 0, SLJS_RING_HEADER + capacity);
+  target_->ring->magic = SLJS_RING_MAGIC;
+  target_->ring->capacity = static_cast<uint32_t>(capacity);
+  target_->ring->notify_context = this;
+  target_->ring->notify = Notify;
+
+  Napi::Buffer<uint8_t> handle = Napi::Buffer<uint8_t>::New(env, sizeof(sljs_callback));
+  sljs_callback pair = { invokeCallback, target_ };
+  memcpy(handle.Data(), &pair, sizeof(pair));
+  handle_ = Napi::Persistent(Napi::Value(handle));
+
+  // The ring starts disarmed, so calls made from inside register only queue
+  if (registerFn) {
+    int status = registerFn(invokeCallback, target_);
+    if (status != 0) {
+      ReleaseTarget();
+      Napi::Error::New(env, registerSymbol + " failed with status " + std::to_string(status)).ThrowAsJavaScriptException();
+      return;
+    }
+    shared_ = true;
+  }
+
+  // The wrapper stays reachable, and the process alive, until close()
+  onCall_ = Napi::Persistent(options.Get("onCall").As<Napi::Function>());
+  Ref();
+  wakeups_ = WakeupQueue::New(env, "sljs-callback", 0, 1, this, [](Napi::Env, void*, NativeCallback* callback) { callback->Unref(); });
+  if (maxLatency_.count() > 0) flusher_ = std::thread(&NativeCallback::FlushLoop, this);
+  open_ = true;
+  napi_add_env_cleanup_hook(env, Cleanup, this);
+  if (armRing(target_->ring, 0)) wakeups_.NonBlockingCall();
+}
+
+NativeCallback::~NativeCallback() {
+  if (open_) {
+    Shutdown();
+    napi_remove_env_cleanup_hook(Env(), Cleanup, this);
+  }
+  ReleaseTarget();
+}
+
+void NativeCallback::Cleanup(void* arg) {
+  auto* callback = static_cast<NativeCallback*>(arg);
+  callback->Shutdown();
+  callback->ReleaseTarget();
+}
+
+// Refuses further calls and stops every wakeup path; safe to call more than
+// once. Calls already queued stay in the ring until ReleaseTarget(). A call
+// that got past the open check before it closed may still notify, so the
+// wakeup queue is only released once none is left.
+void NativeCallback::Shutdown() {
+  if (!open_) return;
+  open_ = false;
+  target_->open.store(false, std::memory_order_seq_cst);
+  while (target_->calls.load(std::memory_order_acquire) != 0) std::this_thread::yield();
+  if (unregister_) unregister_(target_);
+  __atomic_store_n(&target_->ring->notify, nullptr, __ATOMIC_RELEASE);
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stopping_ = true;
+  }
+  wake_.notify_all();
+  if (flusher_.joinable()) flusher_.join();
+  wakeups_.Release();
+}
+
+// Frees the ring once no thread can reach it: the library unregistered, or
+// never got the pointer. Otherwise the target stays allocated, closed, so a
+// late call still gets -1 instead of touching freed memory.
+void NativeCallback::ReleaseTarget() {
+  if (!target_) return;
+  dropped_ = __atomic_load_n(&target_->ring->dropped, __ATOMIC_RELAXED);
+  if (unregister_ || !shared_) {
+    free(target_->ring);
+    delete target_;
+  }
+  target_ = nullptr;
+}
+
+void NativeCallback::Notify(sljs_ring* ring) {
+  auto* callback = static_cast<NativeCallback*>(ring->notify_context);
+  callback->notifications_.fetch_add(1, std::memory_order_relaxed);
+  if (callback->maxLatency_.count() == 0) {
+    callback->wakeups_.NonBlockingCall();
+    return;
+  }
+  {
+    std::lock_guard<std::mutex> lock(callback->mutex_);
+    callback->pending_ = true;
+  }
+  callback->wake_.notify_one();
+}
+
+void NativeCallback::FlushLoop() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  for (;;) {
+    wake_.wait(lock, [this] { return stopping_ || pending_; });
+    if (stopping_) return;
+    wake_.wait_for(lock, maxLatency_, [this] { return stopping_; });
+    if (stopping_) return;
+    pending_ = false;
+    wakeups_.NonBlockingCall();
+  }
+}
+
+void NativeCallback::Deliver(Napi::Env env, Napi::Function, NativeCallback* callback, std::nullptr_t*) {
+  if (env == nullptr || !callback->open_) return;
+  Napi::HandleScope scope(env);
+  if (callback->Flush(env)) callback->wakeups_.NonBlockingCall();
+  else if (!callback->open_) callback->Drain(env);  // onCall closed it
+}
+
+// Hands up to maxBatch queued calls to onCall as one array of { key, data }.
+// With coalescing, a key keeps only its latest call of the batch. Returns
+// true when calls are left and the callback is still open, so another turn
+// should follow; otherwise the ring is armed again.
+bool NativeCallback::Flush(Napi::Env env) {
+  sljs_ring* ring = target_->ring;
+  RingBatch taken = scanRing(ring, maxBatch_);
+  Napi::ArrayBuffer bytes = Napi::ArrayBuffer::New(env, taken.bytes);
+  std::vector<uint32_t> offsets(taken.count + 1);
+  takeRing(ring, taken, static_cast<uint8_t*>(bytes.Data()), offsets.data());
+
+  const auto* data = static_cast<const uint8_t*>(bytes.Data());
+  std::vector<uint64_t> keys(taken.count, 0);
+  std::vector<uint32_t> keep;
+  keep.reserve(taken.count);
+  for (uint32_t i = 0; i < taken.count; ++i)
+    if (offsets[i + 1] - offsets[i] >= sizeof(uint64_t)) memcpy(&keys[i], data + offsets[i], sizeof(uint64_t));
+  if (coalesce_) {
+    std::unordered_map<uint64_t, uint32_t> last;
+    for (uint32_t i = 0; i < taken.count; ++i) last[keys[i]] = i;
+    for (uint32_t i = 0; i < taken.count; ++i)
+      if (last[keys[i]] == i) keep.push_back(i);
+  } else {
+    for (uint32_t i = 0; i < taken.count; ++i) keep.push_back(i);
+  }
+
+  if (!keep.empty()) {
+    Napi::Array events = Napi::Array::New(env, keep.size());
+    for (uint32_t j = 0; j < keep.size(); ++j) {
+      uint32_t i = keep[j];
+      size_t start = std::min<size_t>(offsets[i] + sizeof(uint64_t), offsets[i + 1]);
+      Napi::Object event = Napi::Object::New(env);
+      event.Set("key", Napi::Number::New(env, static_cast<double>(keys[i])));
+      event.Set("data", Napi::Uint8Array::New(env, offsets[i + 1] - start, bytes, start));
+      events.Set(j, event);
+    }
+    delivered_ += keep.size();
+    coalesced_ += taken.count - keep.size();
+    batches_++;
+    largestBatch_ = std::max<uint64_t>(largestBatch_, keep.size());
+    delivering_ = true;
+    onCall_.Call(Value(), { events });
+    delivering_ = false;
+  }
+
+  if (taken.count == maxBatch_) return open_;
+  return open_ && armRing(ring, taken.end);
+}
+
+// Hands the calls still queued after close to onCall, then frees the ring
+void NativeCallback::Drain(Napi::Env env) {
+  while (target_ && !env.IsExceptionPending()) {
+    sljs_ring* ring = target_->ring;
+    if (__atomic_load_n(&ring->head, __ATOMIC_ACQUIRE) == __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE)) break;
+    Flush(env);
+  }
+  ReleaseTarget();
+}
+
+// Closes the callback after handing the calls still queued to onCall. From
+// inside onCall, the batch being delivered finishes first and the rest is
+// drained once it returns.
+Napi::Value NativeCallback::Close(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+  if (open_) {
+    Shutdown();
+    napi_remove_env_cleanup_hook(env, Cleanup, this);
+    if (!delivering_) Drain(env);
+  }
+  return env.Undefined();
+}
+
+// stats() -> { delivered, coalesced, batches, largestBatch, dropped, queuedBytes, notifications }
+Napi::Value NativeCallback::Stats(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+  uint64_t dropped = dropped_, queued = 0;
+  if (target_) {
+    dropped = __atomic_load_n(&target_->ring->dropped, __ATOMIC_RELAXED);
+    queued = __atomic_load_n(&target_->ring->head, __ATOMIC_ACQUIRE) - __atomic_load_n(&target_->ring->tail, __ATOMIC_ACQUIRE);
+  }
+  Napi::Object stats = Napi::Object::New(env);
+  stats.Set("delivered", Napi::Number::New(env, static_cast<double>(delivered_)));
+  stats.Set("coalesced", Napi::Number::New(env, static_cast<double>(coalesced_)));
+  stats.Set("batches", Napi::Number::New(env, static_cast<double>(batches_)));
+  stats.Set("largestBatch", Napi::Number::New(env, static_cast<double>(largestBatch_)));
+  stats.Set("dropped", Napi::Number::New(env, static_cast<double>(dropped)));
+  stats.Set("queuedBytes", Napi::Number::New(env, static_cast<double>(queued)));
+  stats.Set("notifications", Napi::Number::New(env, static_cast<double>(notifications_.load())));
+  return stats;
+}
+
+// 16 bytes holding an sljs_callback, for libraries that take the pointer
+// through runBuffers or a bound function instead of a register symbol
+Napi::Value NativeCallback::GetHandle(const Napi::CallbackInfo& info) {
+  shared_ = true;
+  return handle_.Value();
+}
+
+Napi::Value NativeCallback::GetOpen(const Napi::CallbackInfo& info) {
+  return Napi::Boolean::New(info.Env(), open_);
+}
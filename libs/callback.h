@@ -0,0 +1,75 @@
+#pragma once
+
+#include <napi.h>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include "library.h"
+#include "sljs.h"
+
+// What the library's invoke pointer is bound to. It stays valid until the
+// library has unregistered, so late calls fail cleanly instead of crashing.
+struct CallbackTarget;
+
+// Native-to-JS callback returned by createCallback(lib, options). The
+// library gets a C function pointer and context that it may call from any
+// thread; each call is copied into an sljs_ring, and onCall receives the
+// queued calls in batches, one event-loop turn per batch, optionally
+// coalesced so only the latest call per key is delivered.
+class NativeCallback : public Napi::ObjectWrap<NativeCallback> {
+ public:
+  static Napi::Function Define(Napi::Env env);
+  static Napi::Value Create(const Napi::CallbackInfo& info);
+
+  NativeCallback(const Napi::CallbackInfo& info);
+  ~NativeCallback();
+
+ private:
+  Napi::Value Close(const Napi::CallbackInfo& info);
+  Napi::Value Stats(const Napi::CallbackInfo& info);
+  Napi::Value GetHandle(const Napi::CallbackInfo& info);
+  Napi::Value GetOpen(const Napi::CallbackInfo& info);
+
+  bool Flush(Napi::Env env);
+  void Drain(Napi::Env env);
+  void FlushLoop();
+  void Shutdown();
+  void ReleaseTarget();
+  static void Notify(sljs_ring* ring);
+  static void Deliver(Napi::Env env, Napi::Function, NativeCallback* callback, std::nullptr_t*);
+  static void Cleanup(void* arg);
+
+  using WakeupQueue = Napi::TypedThreadSafeFunction<NativeCallback, std::nullptr_t, Deliver>;
+
+  LibraryLease lib_;
+  void (*unregister_)(void*) = nullptr;
+  CallbackTarget* target_ = nullptr;
+  Napi::Reference<Napi::Value> handle_;
+  bool shared_ = false;
+  bool open_ = false;
+  bool delivering_ = false;
+
+  uint32_t maxBatch_ = 1024;
+  std::chrono::milliseconds maxLatency_{0};
+  bool coalesce_ = false;
+
+  Napi::FunctionReference onCall_;
+  WakeupQueue wakeups_;
+
+  // With maxLatency, wakeups go through this thread, which holds them back
+  // so that calls arriving meanwhile join the same batch
+  std::thread flusher_;
+  std::mutex mutex_;
+  std::condition_variable wake_;
+  bool pending_ = false;
+  bool stopping_ = false;
+
+  std::atomic<uint64_t> notifications_{0};
+  uint64_t delivered_ = 0;
+  uint64_t batches_ = 0;
+  uint64_t coalesced_ = 0;
+  uint64_t largestBatch_ = 0;
+  uint64_t dropped_ = 0;
+};
@@ -0,0 +1,396 @@
+#include "capture.h"
+#include "core.h"
+#include "stats.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Capture engine behind runText / runArgsText. A reader thread drains the
+// redirected stdout (and optionally stderr) pipes while the native call
+// runs, so output is neither truncated nor able to fill the pipe and
+// deadlock the caller. With a logger set and streaming enabled, output is
+// forwarded to jsStdoutLogger in chunks of `flushBytes`. Captures are
+// serialized by StdioLock, so one long-lived reader thread serves them all.
+
+// Options, the logger and the streaming queue belong to one env (see
+// CaptureStream), so every worker_thread configures its own.
+
+thread_local CaptureStream* deferredStream = nullptr;
+
+CaptureStream* currentCaptureStream() {
+  if (deferredStream) return deferredStream;
+  AddonData* addon = threadAddonData();
+  return addon ? addon->capture.get() : nullptr;
+}
+
+bool hasStdoutLogger() {
+  CaptureStream* target = currentCaptureStream();
+  return target && target->logger;
+}
+
+// fd 1 is process-global, so concurrent (async) captures and session runs take turns
+static std::mutex stdioMutex;
+static std::condition_variable stdioReleased;
+static bool stdioHeld = false;
+static std::thread::id stdioInputFrom; // set while the holder may wait for JS input
+
+StdioLock::StdioLock(std::thread::id inputFrom) {
+  std::thread::id self = std::this_thread::get_id();
+  std::unique_lock<std::mutex> lock(stdioMutex);
+  stdioReleased.wait(lock, [&] { return !stdioHeld || stdioInputFrom == self; });
+  if (stdioHeld) return;
+  stdioHeld = true;
+  stdioInputFrom = inputFrom;
+  owns_ = true;
+}
+
+StdioLock::~StdioLock() {
+  if (!owns_) return;
+  {
+    std::lock_guard<std::mutex> lock(stdioMutex);
+    stdioHeld = false;
+    stdioInputFrom = std::thread::id();
+  }
+  stdioReleased.notify_all();
+}
+
+void ChunkedBuffer::Append(const char* data, size_t length) {
+  while (length > 0) {
+    if (chunks_.empty() || chunks_.back().size() == kChunkSize) {
+      chunks_.emplace_back();
+      chunks_.back().reserve(kChunkSize);
+    }
+    std::string& tail = chunks_.back();
+    size_t n = std::min(length, kChunkSize - tail.size());
+    tail.append(data, n);
+    data += n;
+    length -= n;
+    size_ += n;
+  }
+}
+
+std::string ChunkedBuffer::Take() {
+  std::string out;
+  if (chunks_.size() == 1) {
+    out = std::move(chunks_.front());
+  } else {
+    out.reserve(size_);
+    for (const std::string& chunk : chunks_) out += chunk;
+  }
+  chunks_.clear();
+  size_ = 0;
+  return out;
+}
+
+// Streaming delivery
+
+struct StreamChunk {
+  std::string text;
+  const char* stream;
+};
+
+static void deliverChunk(Napi::Env env, Napi::Function, void*, StreamChunk* chunk) {
+  if (env != nullptr && !addonData(env).stdoutLogger.IsEmpty()) {
+    Napi::HandleScope scope(env);
+    addonData(env).stdoutLogger.Call({ Napi::String::New(env, chunk->text), Napi::String::New(env, chunk->stream) });
+  }
+  delete chunk;
+}
+
+using ChunkQueue = Napi::TypedThreadSafeFunction<void, StreamChunk, deliverChunk>;
+
+static void closeChunkQueue(void* arg) {
+  auto* target = static_cast<std::shared_ptr<CaptureStream>*>(arg);
+  {
+    std::lock_guard<std::mutex> lock((*target)->mutex);
+    (*target)->closed = true;
+    ChunkQueue((*target)->chunks).Release();
+  }
+  delete target;
+}
+
+// One redirected stream: pipe, saved original fd and the collected output
+struct RedirectedStream {
+  RedirectedStream(int fd, const char* name, FILE* file) : fd(fd), name(name), file(file) {}
+
+  int fd;
+  const char* name;
+  FILE* file;
+  int saved = -1;
+  int readEnd = -1;
+  ChunkedBuffer pending;
+};
+
+class OutputCapture;
+
+// The shared reader thread. It is created on first use and never destroyed:
+// it may still be parked on the condition variable at process exit.
+class CaptureReader {
+ public:
+  static CaptureReader& Get() {
+    static CaptureReader* reader = new CaptureReader();
+    return *reader;
+  }
+
+  bool Begin(OutputCapture* capture, std::string& error);
+  void End();
+
+ private:
+  CaptureReader();
+  void Run();
+
+  std::mutex mutex_;
+  std::condition_variable changed_;
+  OutputCapture* capture_ = nullptr;
+  int wake_[2] = { -1, -1 };
+};
+
+class OutputCapture {
+ public:
+  // `target` may be null (no logger, default options) unless streaming
+  OutputCapture(CaptureStream* target, bool streaming)
+      : target_(target), streaming_(streaming), onJsThread_(threadAddonData() != nullptr) {
+    streams_.emplace_back(STDOUT_FILENO, "stdout", stdout);
+    if (target && target->withStderr) streams_.emplace_back(STDERR_FILENO, "stderr", stderr);
+  }
+
+  bool Start(std::string& error) {
+    for (RedirectedStream& s : streams_) {
+      int pipefd[2];
+      if (pipe(pipefd) == -1) {
+        error = "[ERROR] pipe creation failed";
+        return false;
+      }
+      fflush(s.file);
+      s.saved = dup(s.fd);
+      if (s.saved == -1 || dup2(pipefd[1], s.fd) == -1) {
+        close(pipefd[0]);
+        close(pipefd[1]);
+        error = s.saved == -1 ? "[ERROR] dup failed" : "[ERROR] dup2 failed";
+        return false;
+      }
+      close(pipefd[1]);
+      s.readEnd = pipefd[0];
+      fcntl(s.readEnd, F_SETFL, fcntl(s.readEnd, F_GETFL) | O_NONBLOCK);
+    }
+    reading_ = CaptureReader::Get().Begin(this, error);
+    return reading_;
+  }
+
+  // Restores the original fds, lets the reader drain what is left and
+  // returns everything that was not already streamed.
+  std::string Finish() {
+    Restore();
+    StopReader();
+
+    for (RedirectedStream& s : streams_) Flush(s);
+    if (!delivered_.empty()) {
+      Napi::FunctionReference& logger = threadAddonData()->stdoutLogger;
+      for (std::unique_ptr<StreamChunk>& chunk : delivered_) {
+        if (!logger.IsEmpty())
+          logger.Call({ Napi::String::New(logger.Env(), chunk->text), Napi::String::New(logger.Env(), chunk->stream) });
+      }
+    }
+    return output_.Take();
+  }
+
+  ~OutputCapture() {
+    Restore();
+    StopReader();
+    for (RedirectedStream& s : streams_)
+      if (s.readEnd != -1) close(s.readEnd);
+  }
+
+  // Runs on the reader thread until the stop signal on `wakeFd`, then drains
+  // what is already buffered once and returns. It does not wait for EOF: a
+  // child process (say `sleep 4 &`) may hold the write end open for longer.
+  void ReadLoop(int wakeFd) {
+    std::vector<pollfd> fds;
+    for (RedirectedStream& s : streams_) fds.push_back({ s.readEnd, POLLIN, 0 });
+    fds.push_back({ wakeFd, POLLIN, 0 });
+
+    char buffer[16384];
+    while (!fds.back().revents) {
+      if (poll(fds.data(), fds.size(), -1) <= 0) continue;
+      for (size_t i = 0; i < streams_.size(); ++i) {
+        if (fds[i].fd == -1 || !(fds[i].revents & (POLLIN | POLLHUP))) continue;
+        ssize_t n = read(fds[i].fd, buffer, sizeof(buffer));
+        if (n > 0) {
+          Append(streams_[i], buffer, static_cast<size_t>(n));
+        } else if (n == 0) {
+          fds[i].fd = -1; // poll skips negative fds
+        }
+      }
+    }
+
+    char stop;
+    while (read(wakeFd, &stop, 1) == -1 && errno == EINTR) {}
+    for (size_t i = 0; i < streams_.size(); ++i) {
+      if (fds[i].fd == -1) continue;
+      ssize_t n;
+      while ((n = read(fds[i].fd, buffer, sizeof(buffer))) > 0) Append(streams_[i], buffer, static_cast<size_t>(n));
+    }
+  }
+
+ private:
+  void StopReader() {
+    if (!reading_) return;
+    CaptureReader::Get().End();
+    reading_ = false;
+  }
+
+  void Restore() {
+    for (RedirectedStream& s : streams_) {
+      if (s.saved == -1) continue;
+      fflush(s.file);
+      dup2(s.saved, s.fd);
+      close(s.saved);
+      s.saved = -1;
+    }
+  }
+
+  void Append(RedirectedStream& s, const char* data, size_t length) {
+    if (!streaming_) {
+      output_.Append(data, length);
+      return;
+    }
+    s.pending.Append(data, length);
+    if (s.pending.Size() >= target_->flushBytes.load(std::memory_order_relaxed)) Flush(s);
+  }
+
+  // Sync captures hold the JS thread, so their chunks are delivered in
+  // order right after the call; captures on pool threads stream through
+  // the thread-safe function as the data arrives.
+  void Flush(RedirectedStream& s) {
+    if (s.pending.Empty()) return;
+    auto* chunk = new StreamChunk{ s.pending.Take(), s.name };
+    if (onJsThread_) {
+      delivered_.emplace_back(chunk);
+      return;
+    }
+    std::lock_guard<std::mutex> lock(target_->mutex);
+    if (target_->closed || !target_->chunks || ChunkQueue(target_->chunks).NonBlockingCall(chunk) != napi_ok) delete chunk;
+  }
+
+  std::vector<RedirectedStream> streams_;
+  std::vector<std::unique_ptr<StreamChunk>> delivered_;
+  ChunkedBuffer output_;
+  CaptureStream* target_;
+  bool reading_ = false;
+  bool streaming_;
+  bool onJsThread_;
+};
+
+CaptureReader::CaptureReader() {
+  if (pipe(wake_) == -1) return;
+  std::thread(&CaptureReader::Run, this).detach();
+}
+
+bool CaptureReader::Begin(OutputCapture* capture, std::string& error) {
+  if (wake_[0] == -1) {
+    error = "[ERROR] pipe creation failed";
+    return false;
+  }
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    capture_ = capture;
+  }
+  changed_.notify_all();
+  return true;
+}
+
+// Signals the stop and waits until the loop has returned
+void CaptureReader::End() {
+  char stop = 1;
+  ssize_t ignored = write(wake_[1], &stop, 1);
+  (void)ignored;
+  std::unique_lock<std::mutex> lock(mutex_);
+  changed_.wait(lock, [&] { return capture_ == nullptr; });
+}
+
+void CaptureReader::Run() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  for (;;) {
+    changed_.wait(lock, [&] { return capture_ != nullptr; });
+    OutputCapture* capture = capture_;
+    lock.unlock();
+    capture->ReadLoop(wake_[0]);
+    lock.lock();
+    capture_ = nullptr;
+    changed_.notify_all();
+  }
+}
+
+std::string captureStdout(const std::function<void()>& func) {
+  CaptureStream* target = currentCaptureStream();
+  bool logger = target && target->logger;
+  bool streaming = logger && target->stream;
+  if (logger && !streaming) {
+    func();
+    return "[output sent via jsStdoutLogger]";
+  }
+
+  // The capture phase is the time spent here minus the call itself,
+  // including the wait for another thread's capture to finish.
+  uint64_t start = statsEnabled() ? monotonicNs() : 0;
+  uint64_t callNs = 0;
+  StdioLock stdio;
+  if (!stdio.owns()) return "[ERROR] stdio is held by a session runAsync() waiting for input; write() to that session first";
+
+  OutputCapture capture(target, streaming);
+  std::string error;
+  if (!capture.Start(error)) return error;
+
+  if (start) {
+    uint64_t callStart = monotonicNs();
+    func();
+    callNs = monotonicNs() - callStart;
+  } else {
+    func();
+  }
+
+  std::string output = capture.Finish();
+  if (start) recordPhase(StatsPhase::Capture, monotonicNs() - start - callNs);
+  return streaming ? "[output sent via jsStdoutLogger]" : output;
+}
+
+Napi::Value SetCaptureOptions(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+  if (!info[0].IsObject()) {
+    Napi::TypeError::New(env, "Expected an options object").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  std::shared_ptr<CaptureStream>& target = addonData(env).capture;
+  Napi::Object options = info[0].As<Napi::Object>();
+  if (options.Has("stderr")) target->withStderr = options.Get("stderr").ToBoolean().Value();
+  if (options.Has("stream")) target->stream = options.Get("stream").ToBoolean().Value();
+  if (options.Has("flushBytes")) {
+    int64_t bytes = options.Get("flushBytes").ToNumber().Int64Value();
+    target->flushBytes = bytes > 0 ? static_cast<size_t>(bytes) : 1;
+  }
+
+  if (target->stream && !target->chunks) {
+    ChunkQueue chunks = ChunkQueue::New(env, "sljs-capture", 0, 1);
+    chunks.Unref(env);
+    std::lock_guard<std::mutex> lock(target->mutex);
+    target->chunks = chunks;
+    napi_add_env_cleanup_hook(env, closeChunkQueue, new std::shared_ptr<CaptureStream>(target));
+  }
+
+  Napi::Object current = Napi::Object::New(env);
+  current.Set("stderr", Napi::Boolean::New(env, target->withStderr));
+  current.Set("stream", Napi::Boolean::New(env, target->stream));
+  current.Set("flushBytes", Napi::Number::New(env, static_cast<double>(target->flushBytes.load())));
+  return current;
+}
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <napi.h>
+#include <atomic>
+#include <cstddef>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+
+// Output collected by a capture, kept as a list of fixed-size chunks so
+// large outputs grow without reallocating and copying what came before.
+class ChunkedBuffer {
+ public:
+  static constexpr size_t kChunkSize = 64 * 1024;
+
+  void Append(const char* data, size_t length);
+  size_t Size() const { return size_; }
+  bool Empty() const { return size_ == 0; }
+  std::string Take();
+
+ private:
+  std::deque<std::string> chunks_;
+  size_t size_ = 0;
+};
+
+// Exclusive use of fds 0-2, held by anything that swaps them for the
+// duration of a call. An async session run may hold it while blocked on
+// stdin that only its JS thread can write; that thread never waits for
+// such a holder, and owns() is false instead, so it can fail fast.
+class StdioLock {
+ public:
+  // `inputFrom`: the JS thread whose writes this holder may block on
+  explicit StdioLock(std::thread::id inputFrom = std::thread::id());
+  ~StdioLock();
+
+  StdioLock(const StdioLock&) = delete;
+  StdioLock& operator=(const StdioLock&) = delete;
+
+  bool owns() const { return owns_; }
+
+ private:
+  bool owns_ = false;
+};
+
+// One env's capture settings and streaming queue (AddonData::capture). Pool
+// threads running that env's async jobs reach it through deferredStream and
+// keep it alive, so a job that outlives the env drops its chunks instead of
+// queueing them on a released function.
+struct CaptureStream {
+  std::atomic<bool> logger{false}; // setStdoutLogger() was called
+  std::atomic<bool> withStderr{false};
+  std::atomic<bool> stream{false};
+  std::atomic<size_t> flushBytes{4096};
+
+  std::mutex mutex;
+  napi_threadsafe_function chunks = nullptr; // created once stream is set
+  bool closed = false;
+};
+
+// Set by queueAsync() for the duration of a job, like deferredLogs
+extern thread_local CaptureStream* deferredStream;
+
+// The calling thread's capture target: its env's on a JS thread, the job's
+// env's on a pool thread, null elsewhere
+CaptureStream* currentCaptureStream();
+
+// Whether output on this thread goes to a JS stdout logger
+bool hasStdoutLogger();
+
+// setCaptureOptions({ stderr, stream, flushBytes })
+Napi::Value SetCaptureOptions(const Napi::CallbackInfo& info);
@@ -0,0 +1,251 @@
+#include "channel.h"
+#include "bind.h"
+#include "core.h"
+
+#include <algorithm>
+#include <cstring>
+
+static_assert(sizeof(sljs_ring) == SLJS_RING_HEADER, "sljs_ring must fill the header lines exactly");
+
+static constexpr uint64_t kDefaultCapacity = 1 << 20;
+static constexpr uint64_t kMinCapacity = 4096;
+static constexpr uint64_t kMaxCapacity = 1u << 30;
+
+static uint64_t recordSize(uint32_t length) {
+  return sizeof(sljs_record) + ((static_cast<uint64_t>(length) + 7) & ~uint64_t(7));
+}
+
+Napi::Function Channel::Define(Napi::Env env) {
+  Napi::Function ctor = DefineClass(env, "Channel", {
+    InstanceMethod("drain", &Channel::Drain),
+    InstanceMethod("close", &Channel::Close),
+    InstanceMethod("stats", &Channel::Stats),
+    InstanceAccessor("buffer", &Channel::GetBuffer, nullptr),
+    InstanceAccessor("open", &Channel::GetOpen, nullptr),
+  });
+  addonData(env).channel = Napi::Persistent(ctor);
+  return ctor;
+}
+
+// createChannel(lib, { capacity, init, stop, onData })
+Napi::Value Channel::Create(const Napi::CallbackInfo& info) {
+  return addonData(info.Env()).channel.New({ info[0], info[1] });
+}
+
+Channel::Channel(const Napi::CallbackInfo& info) : Napi::ObjectWrap<Channel>(info) {
+  Napi::Env env = info.Env();
+  std::string error;
+  lib_ = leaseLibrary(info[0], error);
+  if (!lib_) {
+    Napi::Error::New(env, error).ThrowAsJavaScriptException();
+    return;
+  }
+  if (!info[1].IsObject() || !info[1].As<Napi::Object>().Get("init").IsString()) {
+    Napi::TypeError::New(env, "Expected options with an init symbol").ThrowAsJavaScriptException();
+    return;
+  }
+  Napi::Object options = info[1].As<Napi::Object>();
+
+  std::string initSymbol = options.Get("init").As<Napi::String>();
+  auto init = safeDlsym<int(*)(sljs_ring*, size_t)>(lib_.handle(), initSymbol, error);
+  if (!init) {
+    Napi::Error::New(env, "Symbol not found: " + initSymbol + ": " + error).ThrowAsJavaScriptException();
+    return;
+  }
+  if (options.Get("stop").IsString()) {
+    std::string stopSymbol = options.Get("stop").As<Napi::String>();
+    stop_ = safeDlsym<void(*)(sljs_ring*)>(lib_.handle(), stopSymbol, error);
+    if (!stop_) {
+      Napi::Error::New(env, "Symbol not found: " + stopSymbol + ": " + error).ThrowAsJavaScriptException();
+      return;
+    }
+  }
+
+  uint64_t capacity = kDefaultCapacity;
+  if (options.Get("capacity").IsNumber()) {
+    int64_t requested = options.Get("capacity").As<Napi::Number>().Int64Value();
+    capacity = kMinCapacity;
+    while (capacity < static_cast<uint64_t>(std::max<int64_t>(requested, 0)) && capacity < kMaxCapacity) capacity <<= 1;
+  }
+
+  uint8_t* memory = nullptr;
+  napi_value sab = newSharedArrayBuffer(env, SLJS_RING_HEADER + capacity, memory);
+  if (!sab) {
+    Napi::Error::New(env, "Could not allocate a SharedArrayBuffer for the channel").ThrowAsJavaScriptException();
+    return;
+  }
+  buffer_ = Napi::Persistent(Napi::Value(env, sab));
+
+  ring_ = reinterpret_cast<sljs_ring*>(memory);
+  ring_->magic = SLJS_RING_MAGIC;
+  ring_->capacity = static_cast<uint32_t>(capacity);
+  ring_->notify_context = this;
+
+  // The library's threads write into buffer_ until stop has run, so the
+  // wrapper stays reachable until close() even without onData; with onData
+  // it also keeps the process alive until then
+  Ref();
+  if (options.Get("onData").IsFunction()) {
+    onData_ = Napi::Persistent(options.Get("onData").As<Napi::Function>());
+    wakeups_ = WakeupQueue::New(env, "sljs-channel", 0, 1, this, [](Napi::Env, void*, Channel* channel) { channel->Unref(); });
+    ring_->notify = Notify;
+    ring_->armed = 1;
+  }
+  open_ = true;
+  napi_add_env_cleanup_hook(env, Cleanup, this);
+
+  int status = init(ring_, capacity);
+  if (status != 0) {
+    stop_ = nullptr; // nothing was started
+    Shutdown();
+    napi_remove_env_cleanup_hook(env, Cleanup, this);
+    Napi::Error::New(env, initSymbol + " failed with status " + std::to_string(status)).ThrowAsJavaScriptException();
+  }
+}
+
+Channel::~Channel() {
+  if (open_) {
+    Shutdown();
+    napi_remove_env_cleanup_hook(Env(), Cleanup, this);
+  }
+}
+
+void Channel::Cleanup(void* arg) {
+  static_cast<Channel*>(arg)->Shutdown();
+}
+
+// Stops the producers before anything they write to can go away; safe to
+// call more than once. Records already in the ring can still be drained.
+void Channel::Shutdown() {
+  if (!open_) return;
+  open_ = false;
+  if (stop_) stop_(ring_);
+  __atomic_store_n(&ring_->notify, nullptr, __ATOMIC_RELEASE);
+  if (!onData_.IsEmpty()) {
+    wakeups_.Release(); // its finalizer drops the reference
+  } else {
+    Unref();
+  }
+}
+
+void Channel::Notify(sljs_ring* ring) {
+  auto* channel = static_cast<Channel*>(ring->notify_context);
+  channel->notifications_.fetch_add(1, std::memory_order_relaxed);
+  channel->wakeups_.NonBlockingCall();
+}
+
+void Channel::DeliverWakeup(Napi::Env env, Napi::Function, Channel* channel, std::nullptr_t*) {
+  if (env == nullptr || channel->onData_.IsEmpty()) return;
+  Napi::HandleScope scope(env);
+  channel->onData_.Call(channel->Value(), { channel->Value() });
+}
+
+// Pass 1 of a drain: how many committed records, and how many payload
+// bytes. A full ring has no empty slot to stop at, hence the bound on `end`.
+RingBatch scanRing(sljs_ring* ring, uint64_t maxRecords) {
+  uint8_t* data = sljs_ring_data(ring);
+  const uint64_t capacity = ring->capacity;
+  const uint64_t mask = capacity - 1;
+  const uint64_t tail = ring->tail;
+
+  RingBatch batch;
+  batch.end = tail;
+  while (batch.count < maxRecords && batch.end - tail < capacity) {
+    auto* record = reinterpret_cast<sljs_record*>(data + (batch.end & mask));
+    uint32_t state = __atomic_load_n(&record->state, __ATOMIC_ACQUIRE);
+    if (state == SLJS_RECORD_EMPTY) break;
+    if (state == SLJS_RECORD_PADDING) {
+      batch.end += capacity - (batch.end & mask);
+      continue;
+    }
+    batch.count++;
+    batch.bytes += record->length;
+    batch.end += recordSize(record->length);
+  }
+  return batch;
+}
+
+// Pass 2: copy out and zero what was read, so stale bytes can never look
+// like a committed header once producers wrap around to them.
+void takeRing(sljs_ring* ring, const RingBatch& batch, uint8_t* out, uint32_t* offsets) {
+  uint8_t* data = sljs_ring_data(ring);
+  const uint64_t capacity = ring->capacity;
+  const uint64_t mask = capacity - 1;
+
+  size_t written = 0, index = 0;
+  for (uint64_t pos = ring->tail; pos < batch.end;) {
+    auto* record = reinterpret_cast<sljs_record*>(data + (pos & mask));
+    uint64_t size = record->state == SLJS_RECORD_PADDING ? capacity - (pos & mask) : recordSize(record->length);
+    if (record->state == SLJS_RECORD_READY) {
+      offsets[index++] = static_cast<uint32_t>(written);
+      memcpy(out + written, record + 1, record->length);
+      written += record->length;
+    }
+    memset(record, 0, size);
+    pos += size;
+  }
+  offsets[batch.count] = static_cast<uint32_t>(written);
+  __atomic_store_n(&ring->tail, batch.end, __ATOMIC_RELEASE);
+}
+
+// Arms the wakeup once the consumer has caught up to `tail`. A producer
+// that committed between that read and the flag going up did not see the
+// flag, so the slot is checked again; if it filled, the flag is taken back
+// and true tells the caller to queue the wakeup itself.
+bool armRing(sljs_ring* ring, uint64_t tail) {
+  __atomic_store_n(&ring->armed, 1, __ATOMIC_SEQ_CST);
+  auto* next = reinterpret_cast<sljs_record*>(sljs_ring_data(ring) + (tail & (ring->capacity - 1)));
+  return __atomic_load_n(&next->state, __ATOMIC_SEQ_CST) != SLJS_RECORD_EMPTY &&
+         __atomic_exchange_n(&ring->armed, 0, __ATOMIC_SEQ_CST);
+}
+
+// drain(maxRecords = Infinity) -> { count, data, offsets }: the payloads of
+// up to maxRecords committed records, back to back in one Buffer, with
+// record i at data.subarray(offsets[i], offsets[i + 1]).
+Napi::Value Channel::Drain(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+  uint64_t maxRecords = UINT64_MAX;
+  if (info[0].IsNumber()) maxRecords = static_cast<uint64_t>(std::max<int64_t>(info[0].As<Napi::Number>().Int64Value(), 0));
+
+  RingBatch taken = scanRing(ring_, maxRecords);
+  Napi::Buffer<uint8_t> out = Napi::Buffer<uint8_t>::New(env, taken.bytes);
+  Napi::ArrayBuffer offsetsBuffer = Napi::ArrayBuffer::New(env, (taken.count + 1) * sizeof(uint32_t));
+  takeRing(ring_, taken, out.Data(), static_cast<uint32_t*>(offsetsBuffer.Data()));
+
+  if (taken.count < maxRecords && open_ && !onData_.IsEmpty() && armRing(ring_, taken.end)) wakeups_.NonBlockingCall();
+
+  Napi::Object batch = Napi::Object::New(env);
+  batch.Set("count", Napi::Number::New(env, static_cast<double>(taken.count)));
+  batch.Set("data", out);
+  batch.Set("offsets", Napi::Uint32Array::New(env, taken.count + 1, offsetsBuffer, 0));
+  return batch;
+}
+
+Napi::Value Channel::Close(const Napi::CallbackInfo& info) {
+  if (open_) {
+    Shutdown();
+    napi_remove_env_cleanup_hook(info.Env(), Cleanup, this);
+  }
+  return info.Env().Undefined();
+}
+
+// stats() -> { capacity, used, dropped, notifications }
+Napi::Value Channel::Stats(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+  uint64_t head = __atomic_load_n(&ring_->head, __ATOMIC_ACQUIRE);
+  uint64_t tail = __atomic_load_n(&ring_->tail, __ATOMIC_ACQUIRE);
+  Napi::Object stats = Napi::Object::New(env);
+  stats.Set("capacity", Napi::Number::New(env, ring_->capacity));
+  stats.Set("used", Napi::Number::New(env, static_cast<double>(head - tail)));
+  stats.Set("dropped", Napi::Number::New(env, static_cast<double>(__atomic_load_n(&ring_->dropped, __ATOMIC_RELAXED))));
+  stats.Set("notifications", Napi::Number::New(env, static_cast<double>(notifications_.load())));
+  return stats;
+}
+
+Napi::Value Channel::GetBuffer(const Napi::CallbackInfo& info) {
+  return buffer_.Value();
+}
+
+Napi::Value Channel::GetOpen(const Napi::CallbackInfo& info) {
+  return Napi::Boolean::New(info.Env(), open_);
+}
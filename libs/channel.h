@@ -0,0 +1,62 @@
+#pragma once
+
+#include <napi.h>
+#include <atomic>
+#include "library.h"
+#include "sljs.h"
+
+// Committed records found from the ring's tail on, up to position `end`
+struct RingBatch {
+  size_t count = 0;
+  size_t bytes = 0;
+  uint64_t end = 0;
+};
+
+// Consumer side of an sljs_ring, shared by Channel and NativeCallback. Both
+// run on the one consumer thread: scanRing() counts what can be taken,
+// takeRing() copies the payloads to `out` back to back (record i spans
+// offsets[i]..offsets[i + 1]) and releases them to the producers, and
+// armRing() asks for a notify on the next commit, returning true when a
+// record slipped in meanwhile and the caller should wake itself.
+RingBatch scanRing(sljs_ring* ring, uint64_t maxRecords);
+void takeRing(sljs_ring* ring, const RingBatch& batch, uint8_t* out, uint32_t* offsets);
+bool armRing(sljs_ring* ring, uint64_t tail);
+
+// Ring channel returned by createChannel(lib, { capacity, init, stop, onData }).
+// The ring lives in a SharedArrayBuffer; the library pushes records from
+// its own threads with the inline functions in include/sljs.h and JS takes
+// them out in batches with drain(), so no N-API call happens per record.
+// An open channel is never collected: producers may write to the ring until
+// close() (or env teardown) has run `stop`.
+class Channel : public Napi::ObjectWrap<Channel> {
+ public:
+  static Napi::Function Define(Napi::Env env);
+  static Napi::Value Create(const Napi::CallbackInfo& info);
+
+  Channel(const Napi::CallbackInfo& info);
+  ~Channel();
+
+ private:
+  Napi::Value Drain(const Napi::CallbackInfo& info);
+  Napi::Value Close(const Napi::CallbackInfo& info);
+  Napi::Value Stats(const Napi::CallbackInfo& info);
+  Napi::Value GetBuffer(const Napi::CallbackInfo& info);
+  Napi::Value GetOpen(const Napi::CallbackInfo& info);
+
+  void Shutdown();
+  static void Notify(sljs_ring* ring);
+  static void DeliverWakeup(Napi::Env env, Napi::Function, Channel* channel, std::nullptr_t*);
+  static void Cleanup(void* arg);
+
+  using WakeupQueue = Napi::TypedThreadSafeFunction<Channel, std::nullptr_t, DeliverWakeup>;
+
+  LibraryLease lib_;
+  void (*stop_)(sljs_ring*) = nullptr;
+  Napi::Reference<Napi::Value> buffer_;
+  sljs_ring* ring_ = nullptr;
+  bool open_ = false;
+
+  Napi::FunctionReference onData_;
+  WakeupQueue wakeups_;
+  std::atomic<uint64_t> notifications_{0};
+};
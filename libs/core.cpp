@@ -4,14 +4,44 @@
 #include <fcntl.h>
 #include <string.h>
 #include <iostream>
-#include <sstream>
 #include <functional>
 #include <vector>
 #include <memory>
 #include <cstdio>
-#define BUFFER_SIZE 4096
+#include "library.h"
+#include "arena.h"
+#include "bind.h"
+#include "core.h"
+#include "async.h"
+#include "capture.h"
+#include "elf.h"
+#include "buffers.h"
+#include "loop.h"
+#include "parallel.h"
+#include "typed.h"
+#include "stats.h"
+#include "channel.h"
+#include "isolate.h"
+#include "session.h"
+#include "preload.h"
+#include "symindex.h"
+#include "pipeline.h"
+#include "callback.h"
+
+// Init runs on the env's JS thread, so that is where AddonData is created
+static thread_local AddonData* jsThreadData = nullptr;
+
+AddonData::AddonData() : capture(std::make_shared<CaptureStream>()) {
+  jsThreadData = this;
+}
+
+AddonData::~AddonData() {
+  if (jsThreadData == this) jsThreadData = nullptr;
+}
 
-Napi::FunctionReference jsStdoutLogger;
+AddonData* threadAddonData() {
+  return jsThreadData;
+}
 
 Napi::Value SetStdoutLogger(const Napi::CallbackInfo& info) {
   Napi::Env env = info.Env();
@@ -19,87 +49,50 @@ Napi::Value SetStdoutLogger(const Napi::CallbackInfo& info) {
     Napi::TypeError::New(env, "Expected a function").ThrowAsJavaScriptException();
     return env.Null();
   }
-  jsStdoutLogger = Napi::Persistent(info[0].As<Napi::Function>());
+  AddonData& data = addonData(env);
+  data.stdoutLogger = Napi::Persistent(info[0].As<Napi::Function>());
+  data.capture->logger = true;
   return env.Undefined();
 }
 
-void logToJs(const std::string& message) {
-  if (!jsStdoutLogger.IsEmpty()) {
-    jsStdoutLogger.Call({ Napi::String::New(jsStdoutLogger.Env(), message) });
-  }
-}
+thread_local std::vector<std::string>* deferredLogs = nullptr;
 
-std::string captureStdout(const std::function<void()>& func) {
-  if (!jsStdoutLogger.IsEmpty()) {
-    func();
-    return "[output sent via jsStdoutLogger]";
+void logToJs(const std::string& message) {
+  if (deferredLogs) {
+    deferredLogs->push_back(message);
+    return;
   }
-
-  int pipefd[2];
-  if (pipe(pipefd) == -1) return "[ERROR] pipe creation failed";
-
-  int stdout_fd = dup(STDOUT_FILENO);
-  if (stdout_fd == -1) return "[ERROR] dup failed";
-
-  if (dup2(pipefd[1], STDOUT_FILENO) == -1) {
-    close(stdout_fd);
-    return "[ERROR] dup2 failed";
+  AddonData* addon = threadAddonData();
+  if (addon && !addon->stdoutLogger.IsEmpty()) {
+    addon->stdoutLogger.Call({ Napi::String::New(addon->stdoutLogger.Env(), message) });
   }
-  close(pipefd[1]);
-
-  func();
-
-  fflush(stdout);
-  dup2(stdout_fd, STDOUT_FILENO);
-  close(stdout_fd);
-
-  char buffer[BUFFER_SIZE];
-  ssize_t count = read(pipefd[0], buffer, BUFFER_SIZE - 1);
-  close(pipefd[0]);
-  buffer[(count > 0) ? count : 0] = '\0';
-
-  return std::string(buffer);
 }
 
-std::string dlErrorWrapper(void* handle, const std::string& context) {
-  std::string err(dlerror());
-  if (handle) dlclose(handle);
+std::string dlErrorWrapper(const std::string& context, const std::string& err) {
   return "[ERROR] " + context + ": " + err;
 }
 
-void* safeDlopen(const std::string& path) {
-  void* handle = dlopen(path.c_str(), RTLD_LAZY);
-  if (!handle) logToJs("[ERROR] dlopen failed: " + std::string(dlerror()));
-  return handle;
-}
-
-template<typename T>
-T safeDlsym(void* handle, const std::string& name, std::string& error) {
-  dlerror(); // Clear old error
-  T sym = reinterpret_cast<T>(dlsym(handle, name.c_str()));
-  const char* err = dlerror();
-  if (err) {
-    error = std::string(err);
-    return nullptr;
-  }
-  return sym;
+LibraryLease safeDlopen(const Napi::Value& target) {
+  std::string err;
+  LibraryLease lib = leaseLibrary(target, err);
+  if (!lib) logToJs("[ERROR] dlopen failed: " + err);
+  return lib;
 }
 
-std::string executeTextSymbol(const std::string& soPath, const std::string& symbolName) {
-  void* handle = safeDlopen(soPath);
+std::string executeTextSymbol(void* handle, const std::string& symbolName) {
   if (!handle) return "[ERROR] Cannot open .so file";
 
   std::string err;
   auto func = safeDlsym<void(*)()>(handle, symbolName, err);
-  if (!func) return dlErrorWrapper(handle, "symbol lookup");
+  if (!func) {
+    recordSymbolError(handle, symbolName);
+    return dlErrorWrapper("symbol lookup", err);
+  }
 
-  std::string output = captureStdout(func);
-  dlclose(handle);
-  return output;
+  return captureStdout([&]() { timedCall(handle, symbolName, func); });
 }
 
-int executeValueSymbol(const std::string& soPath, const std::string& symbolName, bool& ok) {
-  void* handle = safeDlopen(soPath);
+int executeValueSymbol(void* handle, const std::string& symbolName, bool& ok) {
   if (!handle) {
     ok = false;
     return -1;
@@ -108,53 +101,55 @@ int executeValueSymbol(const std::string& soPath, const std::string& symbolName,
   std::string err;
   auto func = safeDlsym<int(*)()>(handle, symbolName, err);
   if (!func) {
-    logToJs(dlErrorWrapper(handle, "symbol lookup"));
+    recordSymbolError(handle, symbolName);
+    logToJs(dlErrorWrapper("symbol lookup", err));
     ok = false;
     return -1;
   }
 
-  int result = func();
-  dlclose(handle);
   ok = true;
-  return result;
+  return timedCall(handle, symbolName, func);
 }
 
 std::vector<std::string> inspectSymbols(const std::string& soPath) {
-  std::vector<std::string> symbols;
-  std::string command = "nm -D --defined-only " + soPath + " 2>/dev/null";
-
-  std::unique_ptr<FILE, decltype(&pclose)> pipe(popen(command.c_str(), "r"), pclose);
-  if (!pipe) return { "[ERROR] Failed to execute nm" };
+  std::string error;
+  auto table = readDynamicSymbols(soPath, error);
+  if (!table) return { "[ERROR] " + error };
 
-  char line[256];
-  while (fgets(line, sizeof(line), pipe.get()) != nullptr)
-    symbols.emplace_back(line);
+  // Same line layout as `nm -D --defined-only`
+  std::vector<std::string> symbols;
+  symbols.reserve(table->symbols.size());
+  char address[32];
+  for (const ElfSymbol& sym : table->symbols) {
+    snprintf(address, sizeof(address), table->is64 ? "%016llx" : "%08llx", static_cast<unsigned long long>(sym.value));
+    std::string line = std::string(address) + " " + sym.letter + " " + sym.name;
+    if (!sym.version.empty()) line += (sym.defaultVersion ? "@@" : "@") + sym.version;
+    symbols.push_back(line + "\n");
+  }
 
   if (symbols.empty()) symbols.push_back("No dynamic symbols found.");
   return symbols;
 }
 
-std::string executeTextArgs(const std::string& soPath, const std::string& symbolName, const std::vector<std::string>& args) {
-  void* handle = safeDlopen(soPath);
+std::string executeTextArgs(void* handle, const std::string& symbolName, const std::vector<std::string>& args) {
   if (!handle) return "[ERROR] Cannot open .so file";
 
   std::string err;
   auto func = safeDlsym<void(*)(int, const char**)>(handle, symbolName, err);
-  if (!func) return dlErrorWrapper(handle, "symbol lookup");
+  if (!func) {
+    recordSymbolError(handle, symbolName);
+    return dlErrorWrapper("symbol lookup", err);
+  }
 
   std::vector<const char*> cargs;
   for (const auto& s : args) cargs.push_back(s.c_str());
 
-  std::string output = captureStdout([&]() {
-    func(static_cast<int>(cargs.size()), cargs.data());
+  return captureStdout([&]() {
+    timedCall(handle, symbolName, [&]() { func(static_cast<int>(cargs.size()), cargs.data()); });
   });
-
-  dlclose(handle);
-  return output;
 }
 
-int executeValueArgs(const std::string& soPath, const std::string& symbolName, const std::vector<std::string>& args, bool& ok) {
-  void* handle = safeDlopen(soPath);
+int executeValueArgs(void* handle, const std::string& symbolName, const std::vector<std::string>& args, bool& ok) {
   if (!handle) {
     ok = false;
     return -1;
@@ -163,7 +158,8 @@ int executeValueArgs(const std::string& soPath, const std::string& symbolName, c
   std::string err;
   auto func = safeDlsym<int(*)(int, const char**)>(handle, symbolName, err);
   if (!func) {
-    logToJs(dlErrorWrapper(handle, "symbol lookup"));
+    recordSymbolError(handle, symbolName);
+    logToJs(dlErrorWrapper("symbol lookup", err));
     ok = false;
     return -1;
   }
@@ -171,20 +167,19 @@ int executeValueArgs(const std::string& soPath, const std::string& symbolName, c
   std::vector<const char*> cargs;
   for (const auto& s : args) cargs.push_back(s.c_str());
 
-  int result = func(static_cast<int>(cargs.size()), cargs.data());
-  dlclose(handle);
+  int result = timedCall(handle, symbolName, [&]() { return func(static_cast<int>(cargs.size()), cargs.data()); });
   ok = true;
   return result;
 }
 
-std::string executeStringArgs(const std::string& soPath, const std::string& symbolName, const std::vector<std::string>& args) {
-  void* handle = safeDlopen(soPath);
+std::string executeStringArgs(void* handle, const std::string& symbolName, const std::vector<std::string>& args) {
   if (!handle) return "[ERROR] Cannot open .so file";
 
   std::string err;
   auto func = safeDlsym<const char*(*)(int, const char**)>(handle, symbolName, err);
   if (!func) {
-    std::string errorMessage = dlErrorWrapper(handle, "symbol lookup");
+    recordSymbolError(handle, symbolName);
+    std::string errorMessage = dlErrorWrapper("symbol lookup", err);
     logToJs(errorMessage);
     return errorMessage;
   }
@@ -196,29 +191,29 @@ std::string executeStringArgs(const std::string& soPath, const std::string& symb
   std::string output;
 
   try {
-    result = func(static_cast<int>(cargs.size()), cargs.data());
+    result = timedCall(handle, symbolName, [&]() { return func(static_cast<int>(cargs.size()), cargs.data()); });
+    if (!result) recordSymbolError(handle, symbolName);
     output = result ? std::string(result) : "[ERROR] Null result";
   } catch (...) {
     output = "[ERROR] Exception during function execution";
   }
 
-  if (!jsStdoutLogger.IsEmpty()) {
+  if (hasStdoutLogger()) {
     logToJs("[StringArgs Output] " + output);
     output = "[output sent via jsStdoutLogger]";
   }
 
-  dlclose(handle);
   return output;
 }
 
-std::string executeStringReturnSymbol(const std::string& soPath, const std::string& symbolName) {
-  void* handle = safeDlopen(soPath);
+std::string executeStringReturnSymbol(void* handle, const std::string& symbolName) {
   if (!handle) return "[ERROR] Cannot open .so file";
 
   std::string err;
   auto func = safeDlsym<const char*(*)()>(handle, symbolName, err);
   if (!func) {
-    std::string errorMessage = dlErrorWrapper(handle, "symbol lookup");
+    recordSymbolError(handle, symbolName);
+    std::string errorMessage = dlErrorWrapper("symbol lookup", err);
     logToJs(errorMessage);
     return errorMessage;
   }
@@ -227,18 +222,18 @@ std::string executeStringReturnSymbol(const std::string& soPath, const std::stri
   std::string output;
 
   try {
-    result = func();
+    result = timedCall(handle, symbolName, func);
+    if (!result) recordSymbolError(handle, symbolName);
     output = result ? std::string(result) : "[ERROR] Null result";
   } catch (...) {
     output = "[ERROR] Exception during function execution";
   }
 
-  if (!jsStdoutLogger.IsEmpty()) {
+  if (hasStdoutLogger()) {
     logToJs("[StringReturn Output] " + output);
     output = "[output sent via jsStdoutLogger]";
   }
 
-  dlclose(handle);
   return output;
 }
 
@@ -246,34 +241,60 @@ std::string executeStringReturnSymbol(const std::string& soPath, const std::stri
 Napi::Value SmartInspect(const Napi::CallbackInfo& info) {
   Napi::Env env = info.Env();
   std::string soPath = info[0].As<Napi::String>();
+  bool demangle = info[1].IsObject() && info[1].As<Napi::Object>().Get("demangle").ToBoolean().Value();
 
-  auto rawSymbols = inspectSymbols(soPath);
-  Napi::Array result = Napi::Array::New(env);
-
-  size_t i = 0;
-  for (const std::string& line : rawSymbols) {
-    std::istringstream iss(line);
-    std::string addr, type, name;
-    if (iss >> addr >> type >> name) {
-      Napi::Object sym = Napi::Object::New(env);
-      sym.Set("address", addr);
-      sym.Set("type", type);
-      sym.Set("name", name);
-      result.Set(i++, sym);
+  std::string error;
+  auto table = readDynamicSymbols(soPath, error);
+  if (!table) {
+    Napi::Error::New(env, "Failed to inspect " + soPath + ": " + error).ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  Napi::Array result = Napi::Array::New(env, table->symbols.size());
+  char address[32];
+  for (size_t i = 0; i < table->symbols.size(); ++i) {
+    const ElfSymbol& sym = table->symbols[i];
+    snprintf(address, sizeof(address), table->is64 ? "%016llx" : "%08llx", static_cast<unsigned long long>(sym.value));
+
+    Napi::Object entry = Napi::Object::New(env);
+    entry.Set("address", address);
+    entry.Set("type", std::string(1, sym.letter));
+    entry.Set("name", sym.name);
+    entry.Set("value", Napi::Number::New(env, static_cast<double>(sym.value)));
+    entry.Set("size", Napi::Number::New(env, static_cast<double>(sym.size)));
+    entry.Set("symbolType", elfSymbolTypeName(sym.type));
+    entry.Set("binding", elfBindingName(sym.binding));
+    entry.Set("visibility", elfVisibilityName(sym.visibility));
+    entry.Set("section", sym.section);
+    if (!sym.version.empty()) {
+      entry.Set("version", sym.version);
+      entry.Set("defaultVersion", Napi::Boolean::New(env, sym.defaultVersion));
     }
+    if (demangle) entry.Set("demangled", demangleSymbol(sym.name));
+    result.Set(i, entry);
   }
 
   return result;
 }
 
 // N-API bindings
+static std::vector<std::string> toStringArgs(const Napi::Value& value) {
+  std::vector<std::string> args;
+  Napi::Array inputArgs = value.As<Napi::Array>();
+  for (uint32_t i = 0; i < inputArgs.Length(); ++i)
+    args.push_back(inputArgs.Get(i).As<Napi::String>());
+  return args;
+}
+
 Napi::Value RunText(const Napi::CallbackInfo& info) {
-  return Napi::String::New(info.Env(), executeTextSymbol(info[0].As<Napi::String>(), info[1].As<Napi::String>()));
+  LibraryLease lib = safeDlopen(info[0]);
+  return Napi::String::New(info.Env(), executeTextSymbol(lib.handle(), info[1].As<Napi::String>()));
 }
 
 Napi::Value RunValue(const Napi::CallbackInfo& info) {
+  LibraryLease lib = safeDlopen(info[0]);
   bool ok;
-  int result = executeValueSymbol(info[0].As<Napi::String>(), info[1].As<Napi::String>(), ok);
+  int result = executeValueSymbol(lib.handle(), info[1].As<Napi::String>(), ok);
   if (!ok) {
     Napi::Error::New(info.Env(), "Function call failed").ThrowAsJavaScriptException();
     return info.Env().Null();
@@ -290,20 +311,16 @@ Napi::Value Inspect(const Napi::CallbackInfo& info) {
 }
 
 Napi::Value RunArgsText(const Napi::CallbackInfo& info) {
-  std::vector<std::string> args;
-  Napi::Array inputArgs = info[2].As<Napi::Array>();
-  for (uint32_t i = 0; i < inputArgs.Length(); ++i)
-    args.push_back(inputArgs.Get(i).As<Napi::String>());
-  return Napi::String::New(info.Env(), executeTextArgs(info[0].As<Napi::String>(), info[1].As<Napi::String>(), args));
+  LibraryLease lib = safeDlopen(info[0]);
+  std::vector<std::string> args = toStringArgs(info[2]);
+  return Napi::String::New(info.Env(), executeTextArgs(lib.handle(), info[1].As<Napi::String>(), args));
 }
 
 Napi::Value RunArgsValue(const Napi::CallbackInfo& info) {
-  std::vector<std::string> args;
-  Napi::Array inputArgs = info[2].As<Napi::Array>();
-  for (uint32_t i = 0; i < inputArgs.Length(); ++i)
-    args.push_back(inputArgs.Get(i).As<Napi::String>());
+  LibraryLease lib = safeDlopen(info[0]);
+  std::vector<std::string> args = toStringArgs(info[2]);
   bool ok;
-  int result = executeValueArgs(info[0].As<Napi::String>(), info[1].As<Napi::String>(), args, ok);
+  int result = executeValueArgs(lib.handle(), info[1].As<Napi::String>(), args, ok);
   if (!ok) {
     Napi::Error::New(info.Env(), "Function call failed").ThrowAsJavaScriptException();
     return info.Env().Null();
@@ -312,139 +329,297 @@ Napi::Value RunArgsValue(const Napi::CallbackInfo& info) {
 }
 
 Napi::Value RunArgsString(const Napi::CallbackInfo& info) {
-  std::vector<std::string> args;
-  Napi::Array inputArgs = info[2].As<Napi::Array>();
-  for (uint32_t i = 0; i < inputArgs.Length(); ++i)
-    args.push_back(inputArgs.Get(i).As<Napi::String>());
-  return Napi::String::New(info.Env(), executeStringArgs(info[0].As<Napi::String>(), info[1].As<Napi::String>(), args));
+  LibraryLease lib = safeDlopen(info[0]);
+  std::vector<std::string> args = toStringArgs(info[2]);
+  return Napi::String::New(info.Env(), executeStringArgs(lib.handle(), info[1].As<Napi::String>(), args));
 }
 
 Napi::Value RunStringReturn(const Napi::CallbackInfo& info) {
-  return Napi::String::New(info.Env(), executeStringReturnSymbol(info[0].As<Napi::String>(), info[1].As<Napi::String>()));
+  LibraryLease lib = safeDlopen(info[0]);
+  return Napi::String::New(info.Env(), executeStringReturnSymbol(lib.handle(), info[1].As<Napi::String>()));
 }
 
 // Game Logics Supoorts
 
 // Memory Handler
 
-Napi::Value RunBufferFunc(const Napi::CallbackInfo& info) {
-  std::string soPath = info[0].As<Napi::String>();
-  std::string symbolName = info[1].As<Napi::String>();
-  Napi::Buffer<uint8_t> buf = info[2].As<Napi::Buffer<uint8_t>>();
-
-  void* handle = safeDlopen(soPath);
-  if (!handle) return Napi::String::New(info.Env(), "[ERROR] Cannot open .so file");
+std::string executeBufferSymbol(void* handle, const std::string& symbolName, uint8_t* data, size_t length) {
+  if (!handle) return "[ERROR] Cannot open .so file";
 
   std::string err;
   using FuncType = void(*)(uint8_t*, size_t);
   auto func = safeDlsym<FuncType>(handle, symbolName, err);
   if (!func) {
-    dlclose(handle);
-    return Napi::String::New(info.Env(), "[ERROR] Symbol not found: " + err);
+    recordSymbolError(handle, symbolName);
+    return "[ERROR] Symbol not found: " + err;
   }
 
-  func(buf.Data(), buf.Length());
-  dlclose(handle);
+  timedCall(handle, symbolName, [&]() { func(data, length); });
+  return "Executed buffer function successfully";
+}
 
-  return Napi::String::New(info.Env(), "Executed buffer function successfully");
+Napi::Value RunBufferFunc(const Napi::CallbackInfo& info) {
+  LibraryLease lib = safeDlopen(info[0]);
+  uint8_t* data = nullptr;
+  size_t length = 0;
+  if (!viewBytes(info.Env(), info[2], data, length)) return Napi::String::New(info.Env(), "[ERROR] Expected a Buffer, TypedArray, DataView or ArrayBuffer");
+  return Napi::String::New(info.Env(), executeBufferSymbol(lib.handle(), info[1].As<Napi::String>(), data, length));
 }
 
 // Expose Game Loops
-Napi::Value RunGameTick(const Napi::CallbackInfo& info) {
-  std::string soPath = info[0].As<Napi::String>();
-  std::string symbolName = info[1].As<Napi::String>();
-  float deltaTime = info[2].As<Napi::Number>().FloatValue();
-
-  void* handle = safeDlopen(soPath);
-  if (!handle) return Napi::String::New(info.Env(), "[ERROR] Cannot open .so");
+std::string executeTickSymbol(void* handle, const std::string& symbolName, float deltaTime) {
+  if (!handle) return "[ERROR] Cannot open .so";
 
   std::string err;
   using TickFunc = void(*)(float);
   auto func = safeDlsym<TickFunc>(handle, symbolName, err);
   if (!func) {
-    dlclose(handle);
-    return Napi::String::New(info.Env(), "[ERROR] Symbol not found: " + err);
+    recordSymbolError(handle, symbolName);
+    return "[ERROR] Symbol not found: " + err;
   }
 
-  func(deltaTime);
-  dlclose(handle);
-  return Napi::String::New(info.Env(), "Game tick executed");
+  timedCall(handle, symbolName, [&]() { func(deltaTime); });
+  return "Game tick executed";
 }
 
-// Expose Rendering Function (example of rendering game scenes)
-Napi::Value RunRender(const Napi::CallbackInfo& info) {
-  std::string soPath = info[0].As<Napi::String>();    // path to .so file
-  std::string symbolName = info[1].As<Napi::String>(); // name of the symbol for rendering function
+Napi::Value RunGameTick(const Napi::CallbackInfo& info) {
+  LibraryLease lib = safeDlopen(info[0]);
+  float deltaTime = info[2].As<Napi::Number>().FloatValue();
+  return Napi::String::New(info.Env(), executeTickSymbol(lib.handle(), info[1].As<Napi::String>(), deltaTime));
+}
 
-  // Load the shared object file
-  void* handle = safeDlopen(soPath);
-  if (!handle) return Napi::String::New(info.Env(), "[ERROR] Cannot open .so");
+// Expose Rendering Function (example of rendering game scenes)
+std::string executeRenderSymbol(void* handle, const std::string& symbolName) {
+  if (!handle) return "[ERROR] Cannot open .so";
 
   // Lookup the symbol (rendering function) in the .so file
   std::string err;
   using RenderFunc = void(*)();  // Define the function pointer type for the render function
   auto func = safeDlsym<RenderFunc>(handle, symbolName, err);
   if (!func) {
-    dlclose(handle);
-    return Napi::String::New(info.Env(), "[ERROR] Symbol not found: " + err);
+    recordSymbolError(handle, symbolName);
+    return "[ERROR] Symbol not found: " + err;
   }
 
   // Call the rendering function
-  func();  // This will invoke the rendering logic
+  timedCall(handle, symbolName, func);  // This will invoke the rendering logic
 
-  // Close the shared object file
-  dlclose(handle);
+  return "Rendering function executed";
+}
 
-  return Napi::String::New(info.Env(), "Rendering function executed");
+Napi::Value RunRender(const Napi::CallbackInfo& info) {
+  // Load the shared object file (path or Library)
+  LibraryLease lib = safeDlopen(info[0]);
+  return Napi::String::New(info.Env(), executeRenderSymbol(lib.handle(), info[1].As<Napi::String>()));
 }
 
 // Arm Execution
 
-Napi::Value RunARMFunc(const Napi::CallbackInfo& info) {
-  Napi::Env env = info.Env();
-  
-  std::string soPath = info[0].As<Napi::String>();
-  std::string symbolName = info[1].As<Napi::String>();
-  
-  void* handle = safeDlopen(soPath);
-  if (!handle) {
-    return Napi::String::New(env, "[ERROR] Cannot open .so file");
-  }
+std::string executeARMSymbol(void* handle, const std::string& symbolName) {
+  if (!handle) return "[ERROR] Cannot open .so file";
 
   std::string err;
-  using ARMFunc = void(*)();  
-
+  using ARMFunc = void(*)();
   auto func = safeDlsym<ARMFunc>(handle, symbolName, err);
   if (!func) {
-    dlclose(handle);
-    return Napi::String::New(env, "[ERROR] Symbol not found: " + err);
+    recordSymbolError(handle, symbolName);
+    return "[ERROR] Symbol not found: " + err;
   }
 
   try {
-    func();
+    timedCall(handle, symbolName, func);
   } catch (...) {
-    dlclose(handle);
-    return Napi::String::New(env, "[ERROR] Exception during function execution");
+    return "[ERROR] Exception during function execution";
+  }
+
+  return "ARM function executed successfully";
+}
+
+Napi::Value RunARMFunc(const Napi::CallbackInfo& info) {
+  LibraryLease lib = safeDlopen(info[0]);
+  return Napi::String::New(info.Env(), executeARMSymbol(lib.handle(), info[1].As<Napi::String>()));
+}
+
+// Async variants: the library lease, symbol name and arguments are copied
+// (buffers pinned) on the JS thread, the native call runs on the shared
+// ThreadPool and the returned Promise settles back on the JS thread.
+
+struct AsyncRun {
+  LibraryLease lib;
+  std::string symbol;
+  std::vector<std::string> args;
+  std::string text;
+  int value = 0;
+  bool ok = false;
+};
+
+static std::shared_ptr<AsyncRun> prepareAsync(const Napi::CallbackInfo& info) {
+  auto run = std::make_shared<AsyncRun>();
+  run->lib = safeDlopen(info[0]);
+  run->symbol = info[1].As<Napi::String>();
+  return run;
+}
+
+static Napi::Value resolveText(const std::shared_ptr<AsyncRun>& run, Napi::Env env) {
+  return Napi::String::New(env, run->text);
+}
+
+static Napi::Value resolveValue(const std::shared_ptr<AsyncRun>& run, Napi::Env env) {
+  if (!run->ok) {
+    Napi::Error::New(env, "Function call failed").ThrowAsJavaScriptException();
+    return env.Null();
   }
+  return Napi::Number::New(env, run->value);
+}
+
+Napi::Value RunTextAsync(const Napi::CallbackInfo& info) {
+  auto run = prepareAsync(info);
+  return queueAsync(info.Env(),
+    [run]() { run->text = executeTextSymbol(run->lib.handle(), run->symbol); },
+    [run](Napi::Env env) { return resolveText(run, env); });
+}
+
+Napi::Value RunValueAsync(const Napi::CallbackInfo& info) {
+  auto run = prepareAsync(info);
+  return queueAsync(info.Env(),
+    [run]() { run->value = executeValueSymbol(run->lib.handle(), run->symbol, run->ok); },
+    [run](Napi::Env env) { return resolveValue(run, env); });
+}
+
+Napi::Value RunArgsTextAsync(const Napi::CallbackInfo& info) {
+  auto run = prepareAsync(info);
+  run->args = toStringArgs(info[2]);
+  return queueAsync(info.Env(),
+    [run]() { run->text = executeTextArgs(run->lib.handle(), run->symbol, run->args); },
+    [run](Napi::Env env) { return resolveText(run, env); });
+}
+
+Napi::Value RunArgsValueAsync(const Napi::CallbackInfo& info) {
+  auto run = prepareAsync(info);
+  run->args = toStringArgs(info[2]);
+  return queueAsync(info.Env(),
+    [run]() { run->value = executeValueArgs(run->lib.handle(), run->symbol, run->args, run->ok); },
+    [run](Napi::Env env) { return resolveValue(run, env); });
+}
+
+Napi::Value RunArgsStringAsync(const Napi::CallbackInfo& info) {
+  auto run = prepareAsync(info);
+  run->args = toStringArgs(info[2]);
+  return queueAsync(info.Env(),
+    [run]() { run->text = executeStringArgs(run->lib.handle(), run->symbol, run->args); },
+    [run](Napi::Env env) { return resolveText(run, env); });
+}
+
+Napi::Value RunStringReturnAsync(const Napi::CallbackInfo& info) {
+  auto run = prepareAsync(info);
+  return queueAsync(info.Env(),
+    [run]() { run->text = executeStringReturnSymbol(run->lib.handle(), run->symbol); },
+    [run](Napi::Env env) { return resolveText(run, env); });
+}
+
+Napi::Value RunBufferFuncAsync(const Napi::CallbackInfo& info) {
+  auto run = prepareAsync(info);
+  uint8_t* data = nullptr;
+  size_t length = 0;
+  if (!viewBytes(info.Env(), info[2], data, length)) {
+    Napi::TypeError::New(info.Env(), "Expected a Buffer, TypedArray, DataView or ArrayBuffer").ThrowAsJavaScriptException();
+    return info.Env().Null();
+  }
+  // Keeps the buffer alive until the Promise settles; released on the JS thread
+  auto pinned = std::make_shared<Napi::Reference<Napi::Object>>(Napi::Persistent(info[2].As<Napi::Object>()));
+  auto arena = std::make_shared<ArenaPin>(data);
+  return queueAsync(info.Env(),
+    [run, data, length]() { run->text = executeBufferSymbol(run->lib.handle(), run->symbol, data, length); },
+    [run, pinned, arena](Napi::Env env) { return resolveText(run, env); });
+}
+
+Napi::Value RunGameTickAsync(const Napi::CallbackInfo& info) {
+  auto run = prepareAsync(info);
+  float deltaTime = info[2].As<Napi::Number>().FloatValue();
+  return queueAsync(info.Env(),
+    [run, deltaTime]() { run->text = executeTickSymbol(run->lib.handle(), run->symbol, deltaTime); },
+    [run](Napi::Env env) { return resolveText(run, env); });
+}
+
+Napi::Value RunRenderAsync(const Napi::CallbackInfo& info) {
+  auto run = prepareAsync(info);
+  return queueAsync(info.Env(),
+    [run]() { run->text = executeRenderSymbol(run->lib.handle(), run->symbol); },
+    [run](Napi::Env env) { return resolveText(run, env); });
+}
 
-  dlclose(handle);
-  return Napi::String::New(env, "ARM function executed successfully");
+Napi::Value RunARMFuncAsync(const Napi::CallbackInfo& info) {
+  auto run = prepareAsync(info);
+  return queueAsync(info.Env(),
+    [run]() { run->text = executeARMSymbol(run->lib.handle(), run->symbol); },
+    [run](Napi::Env env) { return resolveText(run, env); });
 }
 
 Napi::Object Init(Napi::Env env, Napi::Object exports) {
+  env.SetInstanceData(new AddonData());
+  exports.Set("Library", Library::Define(env));
+  exports.Set("open", Napi::Function::New(env, OpenLibrary));
+  exports.Set("preload", Napi::Function::New(env, Preload));
+  exports.Set("signatures", listSignatures(env));
+  exports.Set("runBatch", Napi::Function::New(env, RunBatch));
+  exports.Set("runTyped", Napi::Function::New(env, RunTyped));
+  exports.Set("RTLD_LAZY", Napi::Number::New(env, RTLD_LAZY));
+  exports.Set("RTLD_NOW", Napi::Number::New(env, RTLD_NOW));
+  exports.Set("RTLD_GLOBAL", Napi::Number::New(env, RTLD_GLOBAL));
+  exports.Set("RTLD_LOCAL", Napi::Number::New(env, RTLD_LOCAL));
+  exports.Set("RTLD_NODELETE", Napi::Number::New(env, RTLD_NODELETE));
+#ifdef RTLD_DEEPBIND
+  exports.Set("RTLD_DEEPBIND", Napi::Number::New(env, RTLD_DEEPBIND));
+#endif
   exports.Set("setStdoutLogger", Napi::Function::New(env, SetStdoutLogger));
+  exports.Set("setCaptureOptions", Napi::Function::New(env, SetCaptureOptions));
+  exports.Set("Session", Session::Define(env));
+  exports.Set("createSession", Napi::Function::New(env, Session::Create));
   exports.Set("runText", Napi::Function::New(env, RunText));
   exports.Set("runValue", Napi::Function::New(env, RunValue));
   exports.Set("inspect", Napi::Function::New(env, Inspect));
   exports.Set("smartInspect", Napi::Function::New(env, SmartInspect));
+  exports.Set("SymbolIndex", SymbolIndex::Define(env));
+  exports.Set("indexDirectory", Napi::Function::New(env, SymbolIndex::Create));
   exports.Set("runArgsText", Napi::Function::New(env, RunArgsText));
   exports.Set("runArgsValue", Napi::Function::New(env, RunArgsValue));
   exports.Set("runArgsString", Napi::Function::New(env, RunArgsString));
   exports.Set("runStringReturn", Napi::Function::New(env, RunStringReturn));
   exports.Set("runBufferFunc", Napi::Function::New(env, RunBufferFunc));
+  exports.Set("runBuffers", Napi::Function::New(env, RunBuffers));
+  exports.Set("runBufferAlloc", Napi::Function::New(env, RunBufferAlloc));
+  exports.Set("Arena", Arena::Define(env));
+  exports.Set("createArena", Napi::Function::New(env, Arena::Create));
+  exports.Set("NativeCallback", NativeCallback::Define(env));
+  exports.Set("createCallback", Napi::Function::New(env, NativeCallback::Create));
+  exports.Set("parallelMap", Napi::Function::New(env, ParallelMap));
   exports.Set("runGameTick", Napi::Function::New(env, RunGameTick));
+  exports.Set("GameLoop", GameLoop::Define(env));
+  exports.Set("startLoop", Napi::Function::New(env, GameLoop::Start));
+  exports.Set("FramePipeline", FramePipeline::Define(env));
+  exports.Set("createPipeline", Napi::Function::New(env, FramePipeline::Create));
+  exports.Set("Channel", Channel::Define(env));
+  exports.Set("createChannel", Napi::Function::New(env, Channel::Create));
   exports.Set("runRender", Napi::Function::New(env, RunRender));
   exports.Set("runARMFunc", Napi::Function::New(env, RunARMFunc));
+  exports.Set("IsolatedPool", IsolatedPool::Define(env));
+  exports.Set("createIsolatedPool", Napi::Function::New(env, IsolatedPool::Create));
+  exports.Set("runTextAsync", Napi::Function::New(env, RunTextAsync));
+  exports.Set("runValueAsync", Napi::Function::New(env, RunValueAsync));
+  exports.Set("runArgsTextAsync", Napi::Function::New(env, RunArgsTextAsync));
+  exports.Set("runArgsValueAsync", Napi::Function::New(env, RunArgsValueAsync));
+  exports.Set("runArgsStringAsync", Napi::Function::New(env, RunArgsStringAsync));
+  exports.Set("runStringReturnAsync", Napi::Function::New(env, RunStringReturnAsync));
+  exports.Set("runBufferFuncAsync", Napi::Function::New(env, RunBufferFuncAsync));
+  exports.Set("parallelMapAsync", Napi::Function::New(env, ParallelMapAsync));
+  exports.Set("runGameTickAsync", Napi::Function::New(env, RunGameTickAsync));
+  exports.Set("runRenderAsync", Napi::Function::New(env, RunRenderAsync));
+  exports.Set("runARMFuncAsync", Napi::Function::New(env, RunARMFuncAsync));
+  exports.Set("setThreadPoolSize", Napi::Function::New(env, SetThreadPoolSize));
+  exports.Set("getThreadPoolStats", Napi::Function::New(env, GetThreadPoolStats));
+  exports.Set("setStatsEnabled", Napi::Function::New(env, SetStatsEnabled));
+  exports.Set("getStats", Napi::Function::New(env, GetStats));
+  exports.Set("resetStats", Napi::Function::New(env, ResetStats));
   return exports;
 }
 
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <napi.h>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+struct AsyncQueue;
+struct CaptureStream;
+
+// Per-env addon state, stored with env.SetInstanceData(). The main thread
+// and every worker_thread that loads the addon get their own class
+// constructors, so an object is never created from another env's function.
+struct AddonData {
+  Napi::FunctionReference library;
+  Napi::FunctionReference loop;
+  Napi::FunctionReference isolatedPool;
+  Napi::FunctionReference channel;
+  Napi::FunctionReference session;
+  Napi::FunctionReference symbolIndex;
+  Napi::FunctionReference pipeline;
+  Napi::FunctionReference arena;
+  Napi::FunctionReference callback;
+
+  // Completion queue for queueAsync(), created on first use (async.cpp)
+  std::shared_ptr<AsyncQueue> async;
+
+  // setStdoutLogger() target, and capture options plus streaming queue (capture.h)
+  Napi::FunctionReference stdoutLogger;
+  std::shared_ptr<CaptureStream> capture;
+
+  AddonData();
+  ~AddonData();
+};
+
+inline AddonData& addonData(Napi::Env env) { return *env.GetInstanceData<AddonData>(); }
+
+// The AddonData of the env whose JS runs on the calling thread, null on
+// native threads. Node runs at most one env per thread.
+AddonData* threadAddonData();
+
+// Sends a message to the JS stdout logger. Off the JS thread the message is
+// appended to `deferredLogs` instead and flushed once the call completes.
+void logToJs(const std::string& message);
+extern thread_local std::vector<std::string>* deferredLogs;
+
+// Runs `func` with stdout (and stderr, if enabled) redirected; see capture.cpp
+std::string captureStdout(const std::function<void()>& func);
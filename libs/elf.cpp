@@ -0,0 +1,478 @@
+#include "elf.h"
+
+#include <cxxabi.h>
+#include <elf.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <unordered_map>
+
+// Read-only mapping of the whole file with bounds-checked accessors
+class MappedFile {
+ public:
+  ~MappedFile() {
+    if (data_) munmap(data_, size_);
+  }
+
+  bool Open(const std::string& path, struct stat& st, std::string& error) {
+    int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd == -1) {
+      error = "cannot open " + path + ": " + strerror(errno);
+      return false;
+    }
+    if (fstat(fd, &st) != 0 || st.st_size <= 0) {
+      close(fd);
+      error = "cannot stat " + path;
+      return false;
+    }
+    size_ = static_cast<size_t>(st.st_size);
+    void* mapped = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (mapped == MAP_FAILED) {
+      error = "cannot mmap " + path + ": " + strerror(errno);
+      return false;
+    }
+    data_ = static_cast<uint8_t*>(mapped);
+    return true;
+  }
+
+  template <typename T>
+  const T* At(uint64_t offset, uint64_t count = 1) const {
+    if (offset > size_ || count > (size_ - offset) / sizeof(T)) return nullptr;
+    return reinterpret_cast<const T*>(data_ + offset);
+  }
+
+  // NUL-terminated string inside [base, base + limit)
+  const char* String(uint64_t base, uint64_t limit, uint64_t offset) const {
+    if (offset >= limit || base + limit > size_) return nullptr;
+    const char* s = reinterpret_cast<const char*>(data_ + base + offset);
+    if (!memchr(s, '\0', limit - offset)) return nullptr;
+    return s;
+  }
+
+  size_t Size() const { return size_; }
+
+ private:
+  uint8_t* data_ = nullptr;
+  size_t size_ = 0;
+};
+
+template <int Bits> struct ElfTypes;
+
+template <> struct ElfTypes<64> {
+  using Ehdr = Elf64_Ehdr; using Phdr = Elf64_Phdr; using Shdr = Elf64_Shdr;
+  using Sym = Elf64_Sym; using Dyn = Elf64_Dyn; using Addr = Elf64_Addr;
+  using Verdef = Elf64_Verdef; using Verdaux = Elf64_Verdaux;
+  using Verneed = Elf64_Verneed; using Vernaux = Elf64_Vernaux;
+};
+
+template <> struct ElfTypes<32> {
+  using Ehdr = Elf32_Ehdr; using Phdr = Elf32_Phdr; using Shdr = Elf32_Shdr;
+  using Sym = Elf32_Sym; using Dyn = Elf32_Dyn; using Addr = Elf32_Addr;
+  using Verdef = Elf32_Verdef; using Verdaux = Elf32_Verdaux;
+  using Verneed = Elf32_Verneed; using Vernaux = Elf32_Vernaux;
+};
+
+// Where the dynamic symbol data lives, found either through the section
+// headers or, when those are stripped, through PT_DYNAMIC.
+struct DynamicLayout {
+  uint64_t symtab = 0, count = 0;
+  uint64_t strtab = 0, strsz = 0;
+  uint64_t versym = 0;
+  uint64_t verdef = 0, verdefnum = 0, verdefStrtab = 0, verdefStrsz = 0;
+  uint64_t verneed = 0, verneednum = 0, verneedStrtab = 0, verneedStrsz = 0;
+};
+
+template <int Bits>
+class ElfReader {
+  using T = ElfTypes<Bits>;
+
+ public:
+  explicit ElfReader(const MappedFile& file) : file_(file) {}
+
+  bool Read(ElfSymbolTable& table, std::string& error) {
+    const auto* ehdr = file_.At<typename T::Ehdr>(0);
+    if (!ehdr) return Fail(error, "truncated ELF header");
+
+    if (ehdr->e_shoff && ehdr->e_shnum) {
+      shdrs_ = file_.At<typename T::Shdr>(ehdr->e_shoff, ehdr->e_shnum);
+      shnum_ = shdrs_ ? ehdr->e_shnum : 0;
+      if (shdrs_ && ehdr->e_shstrndx < shnum_) shstrtab_ = &shdrs_[ehdr->e_shstrndx];
+    }
+
+    DynamicLayout layout;
+    if (!FromSections(layout) && !FromDynamic(*ehdr, layout)) return Fail(error, "no dynamic symbol table");
+
+    const auto* syms = file_.At<typename T::Sym>(layout.symtab, layout.count);
+    if (!syms) return Fail(error, "dynamic symbol table out of bounds");
+    const uint16_t* versym = layout.versym ? file_.At<uint16_t>(layout.versym, layout.count) : nullptr;
+    LoadVersions(layout);
+
+    table.is64 = Bits == 64;
+    for (uint64_t i = 1; i < layout.count; ++i) {
+      const auto& sym = syms[i];
+      const char* name = file_.String(layout.strtab, layout.strsz, sym.st_name);
+      if (!name || !*name) continue;
+      if (sym.st_shndx == SHN_UNDEF) {
+        if ((sym.st_info >> 4) == STB_GLOBAL) table.undefined.push_back(name);
+        continue;
+      }
+
+      ElfSymbol out;
+      out.name = name;
+      out.value = sym.st_value;
+      out.size = sym.st_size;
+      out.type = sym.st_info & 0xf;
+      out.binding = sym.st_info >> 4;
+      out.visibility = sym.st_other & 0x3;
+      out.shndx = sym.st_shndx;
+
+      const typename T::Shdr* section = nullptr;
+      if (sym.st_shndx < SHN_LORESERVE && sym.st_shndx < shnum_) {
+        section = &shdrs_[sym.st_shndx];
+        if (shstrtab_) {
+          const char* sname = file_.String(shstrtab_->sh_offset, shstrtab_->sh_size, section->sh_name);
+          if (sname) out.section = sname;
+        }
+      }
+
+      if (versym) {
+        uint16_t index = versym[i] & 0x7fff;
+        if (index > VER_NDX_GLOBAL && index < versions_.size() && versions_[index] != out.name) {
+          out.version = versions_[index];
+          out.defaultVersion = !(versym[i] & 0x8000);
+        }
+      }
+
+      out.letter = Letter(out, section);
+      table.symbols.push_back(std::move(out));
+    }
+    return true;
+  }
+
+ private:
+  static bool Fail(std::string& error, const char* message) {
+    error = message;
+    return false;
+  }
+
+  const typename T::Shdr* Section(uint32_t index) const {
+    return index < shnum_ ? &shdrs_[index] : nullptr;
+  }
+
+  bool FromSections(DynamicLayout& layout) {
+    bool found = false;
+    for (uint32_t i = 0; i < shnum_; ++i) {
+      const auto& sh = shdrs_[i];
+      const auto* link = Section(sh.sh_link);
+      switch (sh.sh_type) {
+        case SHT_DYNSYM:
+          if (!link || !sh.sh_entsize) break;
+          layout.symtab = sh.sh_offset;
+          layout.count = sh.sh_size / sh.sh_entsize;
+          layout.strtab = link->sh_offset;
+          layout.strsz = link->sh_size;
+          found = true;
+          break;
+        case SHT_GNU_versym:
+          layout.versym = sh.sh_offset;
+          break;
+        case SHT_GNU_verdef:
+          if (!link) break;
+          layout.verdef = sh.sh_offset;
+          layout.verdefnum = sh.sh_info;
+          layout.verdefStrtab = link->sh_offset;
+          layout.verdefStrsz = link->sh_size;
+          break;
+        case SHT_GNU_verneed:
+          if (!link) break;
+          layout.verneed = sh.sh_offset;
+          layout.verneednum = sh.sh_info;
+          layout.verneedStrtab = link->sh_offset;
+          layout.verneedStrsz = link->sh_size;
+          break;
+      }
+    }
+    return found;
+  }
+
+  // Section headers are optional at run time; the loader only needs
+  // PT_DYNAMIC, whose entries hold virtual addresses. The symbol count
+  // is not recorded there and has to be recovered from .hash or .gnu.hash.
+  bool FromDynamic(const typename T::Ehdr& ehdr, DynamicLayout& layout) {
+    phdrs_ = file_.At<typename T::Phdr>(ehdr.e_phoff, ehdr.e_phnum);
+    if (!phdrs_) return false;
+    phnum_ = ehdr.e_phnum;
+
+    const typename T::Phdr* dynamic = nullptr;
+    for (uint32_t i = 0; i < phnum_; ++i)
+      if (phdrs_[i].p_type == PT_DYNAMIC) dynamic = &phdrs_[i];
+    if (!dynamic) return false;
+
+    const auto* dyn = file_.At<typename T::Dyn>(dynamic->p_offset, dynamic->p_filesz / sizeof(typename T::Dyn));
+    if (!dyn) return false;
+
+    uint64_t hash = 0, gnuHash = 0;
+    size_t entries = dynamic->p_filesz / sizeof(typename T::Dyn);
+    for (size_t i = 0; i < entries && dyn[i].d_tag != DT_NULL; ++i) {
+      uint64_t v = dyn[i].d_un.d_val;
+      switch (dyn[i].d_tag) {
+        case DT_SYMTAB: layout.symtab = ToOffset(v); break;
+        case DT_STRTAB: layout.strtab = ToOffset(v); break;
+        case DT_STRSZ: layout.strsz = v; break;
+        case DT_HASH: hash = ToOffset(v); break;
+        case DT_GNU_HASH: gnuHash = ToOffset(v); break;
+        case DT_VERSYM: layout.versym = ToOffset(v); break;
+        case DT_VERDEF: layout.verdef = ToOffset(v); break;
+        case DT_VERDEFNUM: layout.verdefnum = v; break;
+        case DT_VERNEED: layout.verneed = ToOffset(v); break;
+        case DT_VERNEEDNUM: layout.verneednum = v; break;
+      }
+    }
+    if (!layout.symtab || !layout.strtab) return false;
+    layout.verdefStrtab = layout.verneedStrtab = layout.strtab;
+    layout.verdefStrsz = layout.verneedStrsz = layout.strsz;
+
+    if (hash) {
+      const uint32_t* words = file_.At<uint32_t>(hash, 2);
+      if (words) layout.count = words[1]; // nchain == number of symbols
+    } else if (gnuHash) {
+      layout.count = GnuHashCount(gnuHash);
+    }
+    return layout.count > 0;
+  }
+
+  const typename T::Phdr* Segment(uint64_t vaddr) const {
+    for (uint32_t i = 0; i < phnum_; ++i) {
+      const auto& ph = phdrs_[i];
+      if (ph.p_type == PT_LOAD && vaddr >= ph.p_vaddr && vaddr < ph.p_vaddr + ph.p_memsz) return &ph;
+    }
+    return nullptr;
+  }
+
+  uint64_t ToOffset(uint64_t vaddr) const {
+    for (uint32_t i = 0; i < phnum_; ++i) {
+      const auto& ph = phdrs_[i];
+      if (ph.p_type == PT_LOAD && vaddr >= ph.p_vaddr && vaddr < ph.p_vaddr + ph.p_filesz)
+        return vaddr - ph.p_vaddr + ph.p_offset;
+    }
+    return 0;
+  }
+
+  // .gnu.hash: symbols below symoffset are unhashed; the highest chain
+  // start plus its run (ended by a set low bit) gives the last symbol.
+  uint64_t GnuHashCount(uint64_t offset) const {
+    const uint32_t* header = file_.At<uint32_t>(offset, 4);
+    if (!header) return 0;
+    uint32_t nbuckets = header[0], symoffset = header[1], bloomSize = header[2];
+
+    uint64_t bucketsAt = offset + 16 + uint64_t(bloomSize) * sizeof(typename T::Addr);
+    const uint32_t* buckets = file_.At<uint32_t>(bucketsAt, nbuckets);
+    if (!buckets) return 0;
+
+    uint32_t last = 0;
+    for (uint32_t i = 0; i < nbuckets; ++i) last = std::max(last, buckets[i]);
+    if (last < symoffset) return symoffset;
+
+    uint64_t chainsAt = bucketsAt + uint64_t(nbuckets) * 4;
+    for (;;) {
+      const uint32_t* chain = file_.At<uint32_t>(chainsAt + uint64_t(last - symoffset) * 4);
+      if (!chain) return 0;
+      if (*chain & 1) return uint64_t(last) + 1;
+      last++;
+    }
+  }
+
+  void LoadVersions(const DynamicLayout& layout) {
+    uint64_t at = layout.verdef;
+    for (uint64_t i = 0; at && i < layout.verdefnum; ++i) {
+      const auto* vd = file_.At<typename T::Verdef>(at);
+      if (!vd) break;
+      const auto* aux = file_.At<typename T::Verdaux>(at + vd->vd_aux);
+      const char* name = aux ? file_.String(layout.verdefStrtab, layout.verdefStrsz, aux->vda_name) : nullptr;
+      if (name && !(vd->vd_flags & VER_FLG_BASE)) SetVersion(vd->vd_ndx, name);
+      if (!vd->vd_next) break;
+      at += vd->vd_next;
+    }
+
+    at = layout.verneed;
+    for (uint64_t i = 0; at && i < layout.verneednum; ++i) {
+      const auto* vn = file_.At<typename T::Verneed>(at);
+      if (!vn) break;
+      uint64_t auxAt = at + vn->vn_aux;
+      for (uint32_t j = 0; j < vn->vn_cnt; ++j) {
+        const auto* aux = file_.At<typename T::Vernaux>(auxAt);
+        if (!aux) break;
+        const char* name = file_.String(layout.verneedStrtab, layout.verneedStrsz, aux->vna_name);
+        if (name) SetVersion(aux->vna_other & 0x7fff, name);
+        if (!aux->vna_next) break;
+        auxAt += aux->vna_next;
+      }
+      if (!vn->vn_next) break;
+      at += vn->vn_next;
+    }
+  }
+
+  void SetVersion(uint32_t index, const char* name) {
+    if (index >= versions_.size()) versions_.resize(index + 1);
+    versions_[index] = name;
+  }
+
+  // Same classification nm uses for its one-letter symbol type
+  char Letter(const ElfSymbol& sym, const typename T::Shdr* section) {
+    if (sym.shndx == SHN_COMMON) return 'C';
+    if (sym.type == STT_GNU_IFUNC) return 'i';
+    if (sym.binding == STB_WEAK) return sym.type == STT_OBJECT ? 'V' : 'W';
+    if (sym.binding == STB_GNU_UNIQUE) return 'u';
+    if (sym.shndx == SHN_ABS) return sym.binding == STB_LOCAL ? 'a' : 'A';
+
+    char c = '?';
+    if (section) {
+      if (section->sh_flags & SHF_EXECINSTR) c = 't';
+      else if (section->sh_type == SHT_NOBITS) c = 'b';
+      else if ((section->sh_flags & SHF_ALLOC) && !(section->sh_flags & SHF_WRITE)) c = 'r';
+      else if (section->sh_flags & SHF_ALLOC) c = 'd';
+      else c = 'n';
+    } else if (const typename T::Phdr* segment = sym.type == STT_TLS ? nullptr : Segment(sym.value)) {
+      // No section headers: fall back to the flags of the PT_LOAD segment
+      if (segment->p_flags & PF_X) c = 't';
+      else if (sym.value >= segment->p_vaddr + segment->p_filesz) c = 'b';
+      else if (!(segment->p_flags & PF_W)) c = 'r';
+      else c = 'd';
+    } else if (sym.type == STT_FUNC) {
+      c = 't';
+    } else if (sym.type == STT_OBJECT || sym.type == STT_TLS) {
+      c = 'd';
+    }
+    return sym.binding == STB_LOCAL || c == '?' ? c : static_cast<char>(c - 'a' + 'A');
+  }
+
+  const MappedFile& file_;
+  const typename T::Shdr* shdrs_ = nullptr;
+  const typename T::Shdr* shstrtab_ = nullptr;
+  uint32_t shnum_ = 0;
+  const typename T::Phdr* phdrs_ = nullptr;
+  uint32_t phnum_ = 0;
+  std::vector<std::string> versions_;
+};
+
+static std::shared_ptr<ElfSymbolTable> parseElf(const MappedFile& file, std::string& error) {
+  const unsigned char* ident = file.At<unsigned char>(0, EI_NIDENT);
+  if (!ident || memcmp(ident, ELFMAG, SELFMAG) != 0) {
+    error = "not an ELF file";
+    return nullptr;
+  }
+
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+  const unsigned char hostData = ELFDATA2LSB;
+#else
+  const unsigned char hostData = ELFDATA2MSB;
+#endif
+  if (ident[EI_DATA] != hostData) {
+    error = "ELF byte order differs from the host";
+    return nullptr;
+  }
+
+  auto table = std::make_shared<ElfSymbolTable>();
+  bool ok = false;
+  if (ident[EI_CLASS] == ELFCLASS64) ok = ElfReader<64>(file).Read(*table, error);
+  else if (ident[EI_CLASS] == ELFCLASS32) ok = ElfReader<32>(file).Read(*table, error);
+  else error = "unknown ELF class";
+  if (!ok) return nullptr;
+
+  std::stable_sort(table->symbols.begin(), table->symbols.end(),
+                   [](const ElfSymbol& a, const ElfSymbol& b) { return a.name < b.name; });
+  return table;
+}
+
+struct CachedTable {
+  dev_t dev;
+  ino_t ino;
+  struct timespec mtime;
+  off_t size;
+  std::shared_ptr<const ElfSymbolTable> table;
+};
+
+static std::mutex elfCacheMutex;
+static std::unordered_map<std::string, CachedTable> elfCache;
+
+std::shared_ptr<const ElfSymbolTable> readDynamicSymbols(const std::string& path, std::string& error) {
+  struct stat st;
+  if (stat(path.c_str(), &st) != 0) {
+    error = "cannot stat " + path + ": " + strerror(errno);
+    return nullptr;
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(elfCacheMutex);
+    auto it = elfCache.find(path);
+    if (it != elfCache.end() && it->second.dev == st.st_dev && it->second.ino == st.st_ino &&
+        it->second.size == st.st_size && it->second.mtime.tv_sec == st.st_mtim.tv_sec &&
+        it->second.mtime.tv_nsec == st.st_mtim.tv_nsec)
+      return it->second.table;
+  }
+
+  MappedFile file;
+  if (!file.Open(path, st, error)) return nullptr;
+  std::shared_ptr<const ElfSymbolTable> table = parseElf(file, error);
+  if (!table) return nullptr;
+
+  std::lock_guard<std::mutex> lock(elfCacheMutex);
+  elfCache[path] = { st.st_dev, st.st_ino, st.st_mtim, st.st_size, table };
+  return table;
+}
+
+std::shared_ptr<const ElfSymbolTable> parseDynamicSymbols(const std::string& path, std::string& error) {
+  struct stat st;
+  MappedFile file;
+  if (!file.Open(path, st, error)) return nullptr;
+  return parseElf(file, error);
+}
+
+std::string demangleSymbol(const std::string& name) {
+  int status = 0;
+  char* demangled = abi::__cxa_demangle(name.c_str(), nullptr, nullptr, &status);
+  if (status != 0 || !demangled) return name;
+  std::string out(demangled);
+  free(demangled);
+  return out;
+}
+
+const char* elfSymbolTypeName(unsigned char type) {
+  switch (type) {
+    case STT_NOTYPE: return "NOTYPE";
+    case STT_OBJECT: return "OBJECT";
+    case STT_FUNC: return "FUNC";
+    case STT_SECTION: return "SECTION";
+    case STT_FILE: return "FILE";
+    case STT_COMMON: return "COMMON";
+    case STT_TLS: return "TLS";
+    case STT_GNU_IFUNC: return "IFUNC";
+    default: return "UNKNOWN";
+  }
+}
+
+const char* elfBindingName(unsigned char binding) {
+  switch (binding) {
+    case STB_LOCAL: return "LOCAL";
+    case STB_GLOBAL: return "GLOBAL";
+    case STB_WEAK: return "WEAK";
+    case STB_GNU_UNIQUE: return "UNIQUE";
+    default: return "UNKNOWN";
+  }
+}
+
+const char* elfVisibilityName(unsigned char visibility) {
+  switch (visibility) {
+    case STV_DEFAULT: return "DEFAULT";
+    case STV_INTERNAL: return "INTERNAL";
+    case STV_HIDDEN: return "HIDDEN";
+    case STV_PROTECTED: return "PROTECTED";
+    default: return "UNKNOWN";
+  }
+}
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+// One defined dynamic symbol as read from .dynsym
+struct ElfSymbol {
+  std::string name;
+  uint64_t value = 0;
+  uint64_t size = 0;
+  unsigned char type = 0;       // STT_*
+  unsigned char binding = 0;    // STB_*
+  unsigned char visibility = 0; // STV_*
+  uint16_t shndx = 0;
+  std::string section;
+  std::string version;
+  bool defaultVersion = false;  // name@@VER rather than name@VER
+  char letter = '?';            // nm-style type letter
+};
+
+struct ElfSymbolTable {
+  bool is64 = true;
+  std::vector<ElfSymbol> symbols; // sorted by name, like nm
+  // Names the object needs from elsewhere (undefined, non-weak)
+  std::vector<std::string> undefined;
+};
+
+// Reads the defined dynamic symbols of an ELF32/ELF64 shared object without
+// running nm. Results are cached per (path, inode, mtime), so repeated
+// inspections of an unchanged file cost one stat().
+std::shared_ptr<const ElfSymbolTable> readDynamicSymbols(const std::string& path, std::string& error);
+
+// Same read without going through the cache, for one-off scans of many files
+std::shared_ptr<const ElfSymbolTable> parseDynamicSymbols(const std::string& path, std::string& error);
+
+std::string demangleSymbol(const std::string& name);
+const char* elfSymbolTypeName(unsigned char type);
+const char* elfBindingName(unsigned char binding);
+const char* elfVisibilityName(unsigned char visibility);
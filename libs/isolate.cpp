@@ -0,0 +1,510 @@
+#include "isolate.h"
+#include "arena.h"
+#include "bind.h"
+#include "core.h"
+#include "sljs.h"
+#include "stats.h"
+
+#include <errno.h>
+#include <poll.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/prctl.h>
+#include <sys/socket.h>
+#include <sys/syscall.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <climits>
+#include <cstdio>
+#include <cstring>
+
+enum IsolatedKind : uint32_t {
+  kIsolatedVoid,       // void symbol()
+  kIsolatedValue,      // int symbol()
+  kIsolatedBufferFunc, // void symbol(uint8_t* data, size_t length)
+  kIsolatedBuffers,    // int symbol(sljs_buffer* buffers, size_t count)
+};
+
+// The only bytes that cross the socket. Pointers are valid in the worker
+// as-is: it is a fork of this process, so the library and the arena sit at
+// the same addresses on both sides.
+struct IsolatedRequest {
+  uint64_t id;
+  uint32_t kind;
+  uint32_t count;
+  void* fn;
+  sljs_buffer* buffers;
+};
+
+struct IsolatedReply {
+  uint64_t id;
+  int64_t value;
+};
+
+struct IsolatedCall {
+  uint32_t kind = kIsolatedVoid;
+  void* fn = nullptr;
+  std::string symbol;
+  SymbolStats* stats = nullptr;
+  std::vector<sljs_buffer> views; // JS memory, kept alive by `pins`
+  std::vector<Napi::Reference<Napi::Object>> pins;
+  std::vector<ArenaPin> arenaPins;
+  Napi::Promise::Deferred deferred;
+  int64_t value = 0;
+  std::string error;
+
+  explicit IsolatedCall(Napi::Env env) : deferred(Napi::Promise::Deferred::New(env)) {}
+};
+
+// Held from socketpair() until the parent has closed the worker's end, so a
+// worker forked concurrently by another pool thread never inherits it (the
+// parent would then miss the EOF when this worker dies).
+static std::mutex spawnMutex;
+
+static constexpr double kMaxArena = 4294967296.0;
+
+static size_t alignArena(size_t n) {
+  return (n + 63) & ~size_t(63);
+}
+
+static void closeFrom(int first) {
+#ifdef SYS_close_range
+  if (syscall(SYS_close_range, first, ~0U, 0) == 0) return;
+#endif
+  long max = sysconf(_SC_OPEN_MAX);
+  for (int fd = first; fd < (max > 0 ? max : 1024); fd++) close(fd);
+}
+
+// Body of a worker process. Only plain syscalls and the library's own code
+// run here: the V8 heap was copied by fork() but none of its threads were.
+[[noreturn]] static void workerMain(int socket, pid_t parent) {
+  prctl(PR_SET_PDEATHSIG, SIGKILL);
+  if (getppid() != parent) _exit(0);
+
+  // A fault has to end this process, not run a handler inherited from the parent
+  for (int sig : { SIGSEGV, SIGBUS, SIGFPE, SIGILL, SIGABRT, SIGTERM, SIGINT }) signal(sig, SIG_DFL);
+  sigset_t none;
+  sigemptyset(&none);
+  pthread_sigmask(SIG_SETMASK, &none, nullptr);
+
+  // Nothing else the parent had open belongs here, least of all its ends of
+  // sibling workers' sockets
+  if (socket != 3) {
+    dup2(socket, 3);
+    socket = 3;
+  }
+  closeFrom(4);
+
+  // exit() from the library would otherwise run the parent's atexit
+  // handlers, Node's included; this one is registered last, so it runs first
+  on_exit([](int status, void*) { _exit(status); }, nullptr);
+
+  IsolatedRequest request;
+  for (;;) {
+    if (recv(socket, &request, sizeof request, 0) != sizeof request) _exit(0);
+    IsolatedReply reply{ request.id, 0 };
+    switch (request.kind) {
+      case kIsolatedVoid:
+        reinterpret_cast<void (*)()>(request.fn)();
+        break;
+      case kIsolatedValue:
+        reply.value = reinterpret_cast<int (*)()>(request.fn)();
+        break;
+      case kIsolatedBufferFunc:
+        reinterpret_cast<void (*)(uint8_t*, size_t)>(request.fn)(static_cast<uint8_t*>(request.buffers[0].data), request.buffers[0].length);
+        break;
+      case kIsolatedBuffers:
+        reply.value = reinterpret_cast<sljs_buffers_fn>(request.fn)(request.buffers, request.count);
+        break;
+    }
+    if (send(socket, &reply, sizeof reply, MSG_NOSIGNAL) != sizeof reply) _exit(0);
+  }
+}
+
+Napi::Function IsolatedPool::Define(Napi::Env env) {
+  Napi::Function ctor = DefineClass(env, "IsolatedPool", {
+    InstanceMethod("run", &IsolatedPool::Run),
+    InstanceMethod("runValue", &IsolatedPool::RunValue),
+    InstanceMethod("runBufferFunc", &IsolatedPool::RunBufferFunc),
+    InstanceMethod("runBuffers", &IsolatedPool::RunBuffers),
+    InstanceMethod("stats", &IsolatedPool::Stats),
+    InstanceMethod("close", &IsolatedPool::Close),
+  });
+  addonData(env).isolatedPool = Napi::Persistent(ctor);
+  return ctor;
+}
+
+// createIsolatedPool(lib, { workers, arena, timeout })
+Napi::Value IsolatedPool::Create(const Napi::CallbackInfo& info) {
+  return addonData(info.Env()).isolatedPool.New({ info[0], info[1] });
+}
+
+IsolatedPool::IsolatedPool(const Napi::CallbackInfo& info) : Napi::ObjectWrap<IsolatedPool>(info) {
+  Napi::Env env = info.Env();
+  std::string error;
+  lib_ = leaseLibrary(info[0], error);
+  if (!lib_) {
+    Napi::Error::New(env, error).ThrowAsJavaScriptException();
+    return;
+  }
+
+  size_t count = 2;
+  double arena = static_cast<double>(arenaSize_), timeout = 0;
+  if (info[1].IsObject()) {
+    Napi::Object options = info[1].As<Napi::Object>();
+    if (options.Get("workers").IsNumber()) count = options.Get("workers").As<Napi::Number>().Uint32Value();
+    if (options.Get("arena").IsNumber()) arena = options.Get("arena").As<Napi::Number>().DoubleValue();
+    if (options.Get("timeout").IsNumber()) timeout = options.Get("timeout").As<Napi::Number>().DoubleValue();
+  }
+  if (count < 1 || count > 256) {
+    Napi::RangeError::New(env, "workers must be between 1 and 256").ThrowAsJavaScriptException();
+    return;
+  }
+  // Doubles are checked before conversion, so -1 cannot wrap around into a
+  // size_t or an int
+  if (!(arena >= 0 && arena <= kMaxArena)) {
+    Napi::RangeError::New(env, "arena must be between 0 and 4294967296 bytes").ThrowAsJavaScriptException();
+    return;
+  }
+  if (!(timeout >= 0 && timeout <= INT_MAX)) {
+    Napi::RangeError::New(env, "timeout must be between 0 and 2147483647 ms").ThrowAsJavaScriptException();
+    return;
+  }
+  arenaSize_ = static_cast<size_t>(arena);
+  timeoutMs_ = static_cast<uint32_t>(timeout);
+  long page = sysconf(_SC_PAGESIZE);
+  arenaSize_ = std::max<size_t>((arenaSize_ + page - 1) / page * page, page);
+
+  completions_ = CompletionQueue::New(env, "sljs-isolated", 0, 1, this);
+  completions_.Unref(env);
+  open_ = true;
+  napi_add_env_cleanup_hook(env, Cleanup, this);
+
+  // Arenas are mapped before the first fork so every worker inherits them
+  workers_.resize(count);
+  for (Worker& worker : workers_) {
+    int fd = memfd_create("sljs-isolated", MFD_CLOEXEC);
+    void* arena = MAP_FAILED;
+    if (fd >= 0 && ftruncate(fd, arenaSize_) == 0) arena = mmap(nullptr, arenaSize_, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (fd >= 0) close(fd);
+    if (arena == MAP_FAILED) {
+      error = std::string("Could not map a worker arena: ") + strerror(errno);
+      break;
+    }
+    worker.arena = static_cast<uint8_t*>(arena);
+  }
+  for (Worker& worker : workers_) {
+    if (!error.empty() || !Spawn(worker, error)) break;
+  }
+  if (!error.empty()) {
+    Shutdown();
+    napi_remove_env_cleanup_hook(env, Cleanup, this);
+    Napi::Error::New(env, error).ThrowAsJavaScriptException();
+    return;
+  }
+
+  for (Worker& worker : workers_) worker.thread = std::thread(&IsolatedPool::Serve, this, std::ref(worker));
+}
+
+IsolatedPool::~IsolatedPool() {
+  if (open_) {
+    Shutdown();
+    napi_remove_env_cleanup_hook(Env(), Cleanup, this);
+  }
+}
+
+void IsolatedPool::Cleanup(void* arg) {
+  static_cast<IsolatedPool*>(arg)->Shutdown();
+}
+
+bool IsolatedPool::Spawn(Worker& worker, std::string& error) {
+  std::lock_guard<std::mutex> lock(spawnMutex);
+  int fds[2];
+  if (socketpair(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0, fds) != 0) {
+    error = std::string("socketpair: ") + strerror(errno);
+    return false;
+  }
+  fflush(nullptr); // or the worker would write out our buffered stdio again
+  pid_t parent = getpid();
+  pid_t pid = fork();
+  if (pid < 0) {
+    error = std::string("fork: ") + strerror(errno);
+    close(fds[0]);
+    close(fds[1]);
+    return false;
+  }
+  if (pid == 0) workerMain(fds[1], parent);
+
+  close(fds[1]);
+  std::lock_guard<std::mutex> guard(mutex_);
+  worker.pid = pid;
+  worker.socket = fds[0];
+  return true;
+}
+
+// Closes the socket (an idle worker exits on EOF) and collects the exit
+// status; returns how the worker ended.
+std::string IsolatedPool::Reap(Worker& worker) {
+  pid_t pid;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    pid = worker.pid;
+    worker.pid = -1;
+  }
+  if (worker.socket >= 0) close(worker.socket);
+  worker.socket = -1;
+
+  int status = 0;
+  if (pid <= 0 || waitpid(pid, &status, 0) != pid) return "lost";
+  if (WIFSIGNALED(status)) return std::string(strsignal(WTERMSIG(status))) + " (signal " + std::to_string(WTERMSIG(status)) + ")";
+  return "exited with status " + std::to_string(WEXITSTATUS(status));
+}
+
+void IsolatedPool::Serve(Worker& worker) {
+  for (;;) {
+    IsolatedCall* call;
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      wake_.wait(lock, [&] { return stopping_ || !queue_.empty(); });
+      if (stopping_) break;
+      call = queue_.front();
+      queue_.pop_front();
+      worker.busy = true;
+      calls_++;
+    }
+    Execute(worker, *call);
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      worker.busy = false;
+    }
+    completions_.NonBlockingCall(call);
+  }
+  Reap(worker);
+}
+
+void IsolatedPool::Execute(Worker& worker, IsolatedCall& call) {
+  std::string error;
+  if (worker.pid < 0) {
+    if (!Spawn(worker, error)) {
+      call.error = "Could not start a worker: " + error;
+      return;
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    restarts_++;
+  }
+
+  // Descriptors first, then each view's bytes on its own cache line
+  size_t count = call.views.size();
+  auto* descriptors = reinterpret_cast<sljs_buffer*>(worker.arena);
+  size_t offset = alignArena(count * sizeof(sljs_buffer));
+  for (size_t i = 0; i < count; i++) {
+    const sljs_buffer& view = call.views[i];
+    if (offset + view.length > arenaSize_) {
+      call.error = "Arguments do not fit in the " + std::to_string(arenaSize_) + "-byte worker arena";
+      return;
+    }
+    descriptors[i] = { worker.arena + offset, view.length };
+    memcpy(worker.arena + offset, view.data, view.length);
+    offset = alignArena(offset + view.length);
+  }
+
+  uint64_t start = monotonicNs();
+  IsolatedRequest request{ start, call.kind, static_cast<uint32_t>(count), call.fn, descriptors };
+  IsolatedReply reply{};
+  bool timedOut = false;
+  bool replied = false;
+  if (send(worker.socket, &request, sizeof request, MSG_NOSIGNAL) == sizeof request) {
+    pollfd pending{ worker.socket, POLLIN, 0 };
+    int ready;
+    do {
+      ready = poll(&pending, 1, timeoutMs_ ? static_cast<int>(timeoutMs_) : -1);
+    } while (ready < 0 && errno == EINTR);
+    if (ready == 0) {
+      timedOut = true;
+      kill(worker.pid, SIGKILL);
+    } else {
+      replied = recv(worker.socket, &reply, sizeof reply, 0) == sizeof reply && reply.id == request.id;
+    }
+  }
+
+  if (replied) {
+    for (size_t i = 0; i < count; i++) memcpy(call.views[i].data, descriptors[i].data, descriptors[i].length);
+    call.value = reply.value;
+  } else {
+    std::string how = Reap(worker);
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (stopping_) {
+      call.error = "Pool closed while " + call.symbol + " was running";
+    } else if (timedOut) {
+      timeouts_++;
+      call.error = call.symbol + " timed out after " + std::to_string(timeoutMs_) + " ms; worker killed";
+    } else {
+      crashes_++;
+      call.error = "Worker crashed running " + call.symbol + ": " + how;
+    }
+  }
+  if (call.stats) {
+    call.stats->latency.Record(monotonicNs() - start);
+    if (!replied) call.stats->errors.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  // Replace a lost worker now rather than on the next call
+  if (!replied) {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (stopping_) return;
+    }
+    if (Spawn(worker, error)) {
+      std::lock_guard<std::mutex> lock(mutex_);
+      restarts_++;
+    }
+  }
+}
+
+// Stops taking calls, cuts short the ones running and fails the queued
+// ones; safe to call more than once.
+void IsolatedPool::Shutdown() {
+  if (!open_) return;
+  open_ = false;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stopping_ = true;
+    for (Worker& worker : workers_) {
+      if (worker.busy && worker.pid > 0) kill(worker.pid, SIGKILL);
+    }
+  }
+  wake_.notify_all();
+  for (Worker& worker : workers_) {
+    if (worker.thread.joinable()) worker.thread.join();
+    if (worker.pid > 0) Reap(worker);
+    if (worker.arena) munmap(worker.arena, arenaSize_);
+    worker.arena = nullptr;
+  }
+  for (IsolatedCall* call : queue_) {
+    call->error = "Pool closed before " + call->symbol + " ran";
+    completions_.NonBlockingCall(call);
+  }
+  queue_.clear();
+  completions_.Release();
+}
+
+void IsolatedPool::Deliver(Napi::Env env, Napi::Function, IsolatedPool* pool, IsolatedCall* call) {
+  if (env != nullptr) {
+    Napi::HandleScope scope(env);
+    if (!call->error.empty()) {
+      call->deferred.Reject(Napi::Error::New(env, call->error).Value());
+    } else if (call->kind == kIsolatedValue || call->kind == kIsolatedBuffers) {
+      call->deferred.Resolve(Napi::Number::New(env, static_cast<double>(call->value)));
+    } else {
+      call->deferred.Resolve(env.Undefined());
+    }
+    if (--pool->pending_ == 0) {
+      pool->completions_.Unref(env);
+      pool->Unref();
+    }
+  }
+  delete call;
+}
+
+Napi::Value IsolatedPool::Submit(const Napi::CallbackInfo& info, uint32_t kind, size_t viewArg) {
+  Napi::Env env = info.Env();
+  auto* call = new IsolatedCall(env);
+  Napi::Promise promise = call->deferred.Promise();
+  auto fail = [&](const std::string& message) {
+    call->deferred.Reject(Napi::Error::New(env, message).Value());
+    delete call;
+    return promise;
+  };
+
+  if (!open_) return fail("Pool is closed");
+  if (!info[0].IsString()) return fail("Expected a symbol name");
+  call->kind = kind;
+  call->symbol = info[0].As<Napi::String>();
+  std::string error;
+  call->fn = safeDlsym<void*>(lib_.handle(), call->symbol, error);
+  if (!call->fn) {
+    recordSymbolError(lib_.handle(), call->symbol);
+    return fail("Symbol not found: " + error);
+  }
+  if (statsEnabled()) call->stats = symbolStats(lib_.handle(), call->symbol);
+
+  if (viewArg) {
+    Napi::Value arg = info[viewArg - 1];
+    std::vector<Napi::Value> values;
+    if (kind == kIsolatedBuffers && arg.IsArray()) {
+      Napi::Array array = arg.As<Napi::Array>();
+      for (uint32_t i = 0; i < array.Length(); i++) values.push_back(array.Get(i));
+    } else if (kind == kIsolatedBufferFunc) {
+      values.push_back(arg);
+    } else {
+      return fail("Expected an array of views");
+    }
+    for (const Napi::Value& value : values) {
+      uint8_t* data = nullptr;
+      size_t length = 0;
+      if (!viewBytes(env, value, data, length)) return fail("Expected a Buffer, TypedArray, DataView or ArrayBuffer");
+      call->views.push_back({ data, length });
+      call->pins.push_back(Napi::Persistent(value.As<Napi::Object>()));
+      call->arenaPins.emplace_back(data);
+    }
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    queue_.push_back(call);
+  }
+  wake_.notify_one();
+  if (pending_++ == 0) {
+    Ref();
+    completions_.Ref(env);
+  }
+  return promise;
+}
+
+// pool.run(symbol) -> Promise<undefined> for void symbol()
+Napi::Value IsolatedPool::Run(const Napi::CallbackInfo& info) {
+  return Submit(info, kIsolatedVoid, 0);
+}
+
+// pool.runValue(symbol) -> Promise<number> for int symbol()
+Napi::Value IsolatedPool::RunValue(const Napi::CallbackInfo& info) {
+  return Submit(info, kIsolatedValue, 0);
+}
+
+// pool.runBufferFunc(symbol, view) -> Promise<undefined>; the view is
+// updated with whatever the worker wrote
+Napi::Value IsolatedPool::RunBufferFunc(const Napi::CallbackInfo& info) {
+  return Submit(info, kIsolatedBufferFunc, 2);
+}
+
+// pool.runBuffers(symbol, [views...]) -> Promise<number>, sljs_buffer ABI
+Napi::Value IsolatedPool::RunBuffers(const Napi::CallbackInfo& info) {
+  return Submit(info, kIsolatedBuffers, 2);
+}
+
+// stats() -> { workers, busy, queued, pending, calls, crashes, timeouts, restarts, arena }
+Napi::Value IsolatedPool::Stats(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+  std::lock_guard<std::mutex> lock(mutex_);
+  size_t busy = 0;
+  for (const Worker& worker : workers_) busy += worker.busy;
+  Napi::Object stats = Napi::Object::New(env);
+  stats.Set("workers", Napi::Number::New(env, workers_.size()));
+  stats.Set("busy", Napi::Number::New(env, busy));
+  stats.Set("queued", Napi::Number::New(env, queue_.size()));
+  stats.Set("pending", Napi::Number::New(env, pending_));
+  stats.Set("calls", Napi::Number::New(env, calls_));
+  stats.Set("crashes", Napi::Number::New(env, crashes_));
+  stats.Set("timeouts", Napi::Number::New(env, timeouts_));
+  stats.Set("restarts", Napi::Number::New(env, restarts_));
+  stats.Set("arena", Napi::Number::New(env, arenaSize_));
+  return stats;
+}
+
+Napi::Value IsolatedPool::Close(const Napi::CallbackInfo& info) {
+  if (open_) {
+    Shutdown();
+    napi_remove_env_cleanup_hook(info.Env(), Cleanup, this);
+  }
+  return info.Env().Undefined();
+}
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <napi.h>
+#include <sys/types.h>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "library.h"
+
+// One call queued on an IsolatedPool; settles its Promise on the JS thread
+struct IsolatedCall;
+
+// Crash-isolated pool returned by createIsolatedPool(lib, options). Each
+// worker is a process forked from this one with the library already
+// mapped, paired with a thread here that feeds it calls one at a time over
+// a socket. Buffers travel through a shared memory arena per worker, so
+// only a small fixed-size request crosses the socket. A worker that dies
+// fails the call it was running and is forked again straight away.
+class IsolatedPool : public Napi::ObjectWrap<IsolatedPool> {
+ public:
+  static Napi::Function Define(Napi::Env env);
+  static Napi::Value Create(const Napi::CallbackInfo& info);
+
+  IsolatedPool(const Napi::CallbackInfo& info);
+  ~IsolatedPool();
+
+ private:
+  struct Worker {
+    pid_t pid = -1;
+    int socket = -1;
+    uint8_t* arena = nullptr;
+    bool busy = false;
+    std::thread thread;
+  };
+
+  Napi::Value Run(const Napi::CallbackInfo& info);
+  Napi::Value RunValue(const Napi::CallbackInfo& info);
+  Napi::Value RunBufferFunc(const Napi::CallbackInfo& info);
+  Napi::Value RunBuffers(const Napi::CallbackInfo& info);
+  Napi::Value Stats(const Napi::CallbackInfo& info);
+  Napi::Value Close(const Napi::CallbackInfo& info);
+
+  Napi::Value Submit(const Napi::CallbackInfo& info, uint32_t kind, size_t viewArg);
+  void Serve(Worker& worker);
+  void Execute(Worker& worker, IsolatedCall& call);
+  bool Spawn(Worker& worker, std::string& error);
+  std::string Reap(Worker& worker);
+  void Shutdown();
+  static void Deliver(Napi::Env env, Napi::Function, IsolatedPool* pool, IsolatedCall* call);
+  static void Cleanup(void* arg);
+
+  using CompletionQueue = Napi::TypedThreadSafeFunction<IsolatedPool, IsolatedCall, Deliver>;
+
+  LibraryLease lib_;
+  size_t arenaSize_ = 1 << 20;
+  uint32_t timeoutMs_ = 0;
+
+  std::vector<Worker> workers_;
+  std::mutex mutex_;
+  std::condition_variable wake_;
+  std::deque<IsolatedCall*> queue_;
+  bool stopping_ = false;
+  bool open_ = false;
+
+  CompletionQueue completions_;
+  size_t pending_ = 0;
+
+  // Guarded by mutex_
+  uint64_t calls_ = 0;
+  uint64_t crashes_ = 0;
+  uint64_t timeouts_ = 0;
+  uint64_t restarts_ = 0;
+};
@@ -0,0 +1,232 @@
+#include "library.h"
+#include "bind.h"
+#include "core.h"
+#include "elf.h"
+#include "reload.h"
+
+#include <link.h>
+#include <sys/stat.h>
+#include <limits.h>
+#include <stdlib.h>
+#include <mutex>
+#include <unordered_map>
+
+static std::mutex libraryCacheMutex;
+static std::unordered_map<std::string, SharedLibrary*> libraryCache;
+
+// Bare sonames ("libm.so.6") are resolved by the dynamic linker search path,
+// so they are cached by name; real files by canonical path + inode + mtime.
+static std::string fileKeyFor(const std::string& path, std::string& canonical) {
+  canonical = path;
+  if (path.find('/') == std::string::npos) return "name:" + path;
+
+  char resolved[PATH_MAX];
+  struct stat st;
+  if (!realpath(path.c_str(), resolved) || stat(resolved, &st) != 0) return "path:" + path;
+
+  canonical = resolved;
+  return canonical + "#" + std::to_string(st.st_dev) + ":" + std::to_string(st.st_ino) +
+         ":" + std::to_string(st.st_mtim.tv_sec) + "." + std::to_string(st.st_mtim.tv_nsec);
+}
+
+// Another cached entry for the same file that was opened with `flag`.
+// Caller holds libraryCacheMutex.
+static bool cachedWith(const std::string& file, int flag) {
+  for (const auto& entry : libraryCache)
+    if (entry.second->file == file && (entry.second->flags & flag)) return true;
+  return false;
+}
+
+// glibc binds an object only on its first dlopen; opening it again with
+// stricter flags returns the same lazily bound handle. When the file was
+// already mapped, RTLD_NOW is checked by hand by resolving every undefined
+// reference the way an eager load would have. RTLD_DEEPBIND cannot be
+// applied afterwards, so such a request is refused.
+static bool checkLateBinding(const std::string& file, void* handle, int flags, std::string& error) {
+  struct link_map* map = nullptr;
+  if (dlinfo(handle, RTLD_DI_LINKMAP, &map) != 0 || !map) return true;
+  std::string path = map->l_name;
+#ifdef RTLD_DEEPBIND
+  if ((flags & RTLD_DEEPBIND) && !cachedWith(file, RTLD_DEEPBIND)) {
+    error = path + ": already loaded without RTLD_DEEPBIND";
+    return false;
+  }
+#endif
+  if (!(flags & RTLD_NOW) || cachedWith(file, RTLD_NOW)) return true;
+
+  std::string readError;
+  std::shared_ptr<const ElfSymbolTable> table = readDynamicSymbols(path, readError);
+  if (!table) return true; // nothing to check against; keep what dlopen gave
+  for (const std::string& name : table->undefined) {
+    if (dlsym(handle, name.c_str()) || dlsym(RTLD_DEFAULT, name.c_str())) continue;
+    error = path + ": undefined symbol: " + name;
+    return false;
+  }
+  return true;
+}
+
+SharedLibrary* acquireLibrary(const std::string& path, int flags, std::string& error) {
+  std::string canonical;
+  std::string file = fileKeyFor(path, canonical);
+  // The flags are part of the key, so a lazy handle never answers a
+  // request for RTLD_NOW, RTLD_GLOBAL or RTLD_DEEPBIND
+  std::string key = file + "|" + std::to_string(flags);
+
+  std::lock_guard<std::mutex> lock(libraryCacheMutex);
+  auto it = libraryCache.find(key);
+  if (it != libraryCache.end()) {
+    it->second->refs++;
+    return it->second;
+  }
+
+  uint64_t start = statsEnabled() ? monotonicNs() : 0;
+  void* mapped = dlopen(canonical.c_str(), RTLD_LAZY | RTLD_NOLOAD);
+  void* handle = dlopen(canonical.c_str(), flags);
+  if (start) recordPhase(StatsPhase::Dlopen, monotonicNs() - start);
+  if (mapped) dlclose(mapped);
+  if (!handle) {
+    const char* err = dlerror();
+    error = err ? err : "unknown dlopen error";
+    return nullptr;
+  }
+  if (mapped && !checkLateBinding(file, handle, flags, error)) {
+    dlclose(handle);
+    return nullptr;
+  }
+
+  auto* lib = new SharedLibrary();
+  lib->key = key;
+  lib->file = file;
+  lib->path = canonical;
+  lib->handle = handle;
+  lib->flags = flags;
+  lib->refs = 1;
+  libraryCache.emplace(key, lib);
+  return lib;
+}
+
+void retainLibrary(SharedLibrary* lib) {
+  std::lock_guard<std::mutex> lock(libraryCacheMutex);
+  lib->refs++;
+}
+
+void releaseLibrary(SharedLibrary* lib) {
+  std::lock_guard<std::mutex> lock(libraryCacheMutex);
+  if (--lib->refs > 0) return;
+
+  libraryCache.erase(lib->key);
+  dlclose(lib->handle);
+  delete lib;
+}
+
+LibraryLease leaseLibrary(const Napi::Value& target, std::string& error) {
+  if (target.IsString()) {
+    return LibraryLease(acquireLibrary(target.As<Napi::String>(), RTLD_LAZY, error));
+  }
+
+  if (Library::IsLibrary(target)) {
+    SharedLibrary* lib = Library::Unwrap(target.As<Napi::Object>())->shared();
+    if (!lib) {
+      error = "library is closed";
+      return LibraryLease();
+    }
+    retainLibrary(lib);
+    return LibraryLease(lib);
+  }
+
+  error = "expected a path or a Library";
+  return LibraryLease();
+}
+
+// Library object
+
+Napi::Function Library::Define(Napi::Env env) {
+  Napi::Function ctor = DefineClass(env, "Library", {
+    InstanceMethod("close", &Library::Close),
+    InstanceMethod("bind", &Library::Bind),
+    InstanceMethod("watch", &Library::Watch),
+    InstanceMethod("unwatch", &Library::Unwatch),
+    InstanceMethod("reload", &Library::Reload),
+    InstanceAccessor("path", &Library::GetPath, nullptr),
+    InstanceAccessor("isOpen", &Library::GetIsOpen, nullptr),
+    InstanceAccessor("generation", &Library::GetGeneration, nullptr),
+    InstanceAccessor("watching", &Library::GetWatching, nullptr),
+  });
+  addonData(env).library = Napi::Persistent(ctor);
+  return ctor;
+}
+
+bool Library::IsLibrary(const Napi::Value& value) {
+  if (!value.IsObject()) return false;
+  Napi::FunctionReference& ctor = addonData(value.Env()).library;
+  return !ctor.IsEmpty() && value.As<Napi::Object>().InstanceOf(ctor.Value());
+}
+
+Library::Library(const Napi::CallbackInfo& info) : Napi::ObjectWrap<Library>(info) {
+  Napi::Env env = info.Env();
+  if (!info[0].IsString()) {
+    Napi::TypeError::New(env, "Expected a path to a .so file").ThrowAsJavaScriptException();
+    return;
+  }
+
+  int flags = info[1].IsNumber() ? info[1].As<Napi::Number>().Int32Value() : RTLD_LAZY;
+  std::string error;
+  lib_ = acquireLibrary(info[0].As<Napi::String>(), flags, error);
+  if (!lib_) {
+    Napi::Error::New(env, "[ERROR] dlopen failed: " + error).ThrowAsJavaScriptException();
+    return;
+  }
+  path_ = lib_->path;
+  sourcePath_ = sourceFileFor(info[0].As<Napi::String>(), lib_->handle);
+}
+
+Library::~Library() {
+  StopWatching();
+  if (lib_) releaseLibrary(lib_);
+}
+
+Napi::Value Library::Close(const Napi::CallbackInfo& info) {
+  StopWatching();
+  if (lib_) {
+    releaseLibrary(lib_);
+    lib_ = nullptr;
+  }
+  return info.Env().Undefined();
+}
+
+// bind(symbol, signature): resolve once, return a JS function holding the raw pointer
+Napi::Value Library::Bind(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+  if (!lib_) {
+    Napi::Error::New(env, "Library is closed").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+  if (!info[0].IsString() || !info[1].IsString()) {
+    Napi::TypeError::New(env, "Expected (symbol, signature) strings").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+  return bindSymbol(env, lib_, info[0].As<Napi::String>(), info[1].As<Napi::String>(), bindings_);
+}
+
+Napi::Value Library::GetPath(const Napi::CallbackInfo& info) {
+  if (!lib_) return info.Env().Null();
+  return Napi::String::New(info.Env(), path_);
+}
+
+Napi::Value Library::GetIsOpen(const Napi::CallbackInfo& info) {
+  return Napi::Boolean::New(info.Env(), lib_ != nullptr);
+}
+
+Napi::Value OpenLibrary(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+  if (!info[0].IsString()) {
+    Napi::TypeError::New(env, "Expected a path to a .so file").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+  int flags = info[1].IsNumber() ? info[1].As<Napi::Number>().Int32Value() : RTLD_LAZY;
+  return newLibrary(env, info[0].As<Napi::String>(), flags);
+}
+
+Napi::Value newLibrary(Napi::Env env, const std::string& path, int flags) {
+  return addonData(env).library.New({ Napi::String::New(env, path), Napi::Number::New(env, flags) });
+}
@@ -0,0 +1,146 @@
+#pragma once
+
+#include <napi.h>
+#include <dlfcn.h>
+#include <memory>
+#include <string>
+#include <unordered_set>
+#include "stats.h"
+
+// One dlopen handle shared by every caller that opened the same file with
+// the same flags. Entries live in a process-wide cache keyed by canonical
+// path plus device/inode/mtime and the flags, and are dlclose'd when the
+// last reference goes away.
+struct SharedLibrary {
+  std::string key;
+  std::string file; // the key without the flags
+  std::string path;
+  void* handle = nullptr;
+  int flags = RTLD_LAZY;
+  int refs = 0;
+};
+
+SharedLibrary* acquireLibrary(const std::string& path, int flags, std::string& error);
+void retainLibrary(SharedLibrary* lib);
+void releaseLibrary(SharedLibrary* lib);
+
+// Holds one reference to a cached library for the duration of a call.
+class LibraryLease {
+ public:
+  LibraryLease() = default;
+  explicit LibraryLease(SharedLibrary* lib) : lib_(lib) {}
+  ~LibraryLease() { if (lib_) releaseLibrary(lib_); }
+
+  LibraryLease(LibraryLease&& other) noexcept : lib_(other.lib_) { other.lib_ = nullptr; }
+  LibraryLease& operator=(LibraryLease&& other) noexcept {
+    if (this != &other) {
+      if (lib_) releaseLibrary(lib_);
+      lib_ = other.lib_;
+      other.lib_ = nullptr;
+    }
+    return *this;
+  }
+  LibraryLease(const LibraryLease&) = delete;
+  LibraryLease& operator=(const LibraryLease&) = delete;
+
+  explicit operator bool() const { return lib_ != nullptr; }
+  void* handle() const { return lib_ ? lib_->handle : nullptr; }
+  SharedLibrary* get() const { return lib_; }
+
+ private:
+  SharedLibrary* lib_ = nullptr;
+};
+
+struct SymbolBinding;
+
+// Every function bound through one Library; a hot reload re-resolves each
+// member against the new generation (reload.h).
+using BindingSet = std::unordered_set<SymbolBinding*>;
+
+// A resolved symbol plus the reference that keeps its library loaded: the
+// part shared by bound functions of both calling conventions.
+struct SymbolBinding {
+  void* fn = nullptr;
+  SharedLibrary* lib = nullptr;
+  std::string name;
+  // Call metrics entry, looked up on the first call made with stats on
+  SymbolStats* stats = nullptr;
+  // Set when bound through a Library, which may swap `fn` and `lib` on reload
+  std::shared_ptr<BindingSet> registry;
+
+  ~SymbolBinding() {
+    if (registry) registry->erase(this);
+  }
+};
+
+class LibraryWatcher;
+struct GenerationLoad;
+
+// JS-visible library object returned by open(path, flags)
+class Library : public Napi::ObjectWrap<Library> {
+ public:
+  static Napi::Function Define(Napi::Env env);
+  static bool IsLibrary(const Napi::Value& value);
+
+  Library(const Napi::CallbackInfo& info);
+  ~Library();
+
+  SharedLibrary* shared() const { return lib_; }
+
+  // Switches this Library and everything bound through it to `next`, which
+  // must carry one reference for the Library; see reload.cpp.
+  bool Adopt(SharedLibrary* next, std::string& error);
+
+ private:
+  Napi::Value Close(const Napi::CallbackInfo& info);
+  Napi::Value Bind(const Napi::CallbackInfo& info);
+  Napi::Value GetPath(const Napi::CallbackInfo& info);
+  Napi::Value GetIsOpen(const Napi::CallbackInfo& info);
+
+  // Hot reload (reload.cpp)
+  Napi::Value Watch(const Napi::CallbackInfo& info);
+  Napi::Value Unwatch(const Napi::CallbackInfo& info);
+  Napi::Value Reload(const Napi::CallbackInfo& info);
+  Napi::Value GetGeneration(const Napi::CallbackInfo& info);
+  Napi::Value GetWatching(const Napi::CallbackInfo& info);
+  void StopWatching();
+  static void DeliverGeneration(Napi::Env env, Napi::Function, Library* library, GenerationLoad* load);
+  static void CleanupWatcher(void* arg);
+
+  SharedLibrary* lib_ = nullptr;
+  // Canonical path of the first generation, as reported by `path`
+  std::string path_;
+  // Absolute path as opened (symlinks kept); reloads copy this file
+  std::string sourcePath_;
+  uint64_t generation_ = 0;
+  std::shared_ptr<BindingSet> bindings_ = std::make_shared<BindingSet>();
+
+  std::unique_ptr<LibraryWatcher> watcher_;
+  Napi::FunctionReference onReload_;
+  Napi::FunctionReference onError_;
+
+  friend class LibraryWatcher;
+};
+
+// Accepts either a path string or a Library object (first argument of every run* call)
+LibraryLease leaseLibrary(const Napi::Value& target, std::string& error);
+
+Napi::Value OpenLibrary(const Napi::CallbackInfo& info);
+
+// The Library object open(path, flags) returns; throws and returns an empty
+// value if the library cannot be opened
+Napi::Value newLibrary(Napi::Env env, const std::string& path, int flags);
+
+template<typename T>
+T safeDlsym(void* handle, const std::string& name, std::string& error) {
+  uint64_t start = statsEnabled() ? monotonicNs() : 0;
+  dlerror(); // Clear old error
+  T sym = reinterpret_cast<T>(dlsym(handle, name.c_str()));
+  const char* err = dlerror();
+  if (start) recordPhase(StatsPhase::Dlsym, monotonicNs() - start);
+  if (err) {
+    error = std::string(err);
+    return nullptr;
+  }
+  return sym;
+}
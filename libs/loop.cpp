@@ -0,0 +1,276 @@
+#include "loop.h"
+#include "core.h"
+
+#include <algorithm>
+#include <cmath>
+
+// Frame and work times kept for the percentiles (most recent samples)
+static constexpr size_t kSampleWindow = 1024;
+
+static double toMs(GameLoop::Clock::duration d) {
+  return std::chrono::duration<double, std::milli>(d).count();
+}
+
+Napi::Function GameLoop::Define(Napi::Env env) {
+  Napi::Function ctor = DefineClass(env, "GameLoop", {
+    InstanceMethod("pause", &GameLoop::Pause),
+    InstanceMethod("resume", &GameLoop::Resume),
+    InstanceMethod("stop", &GameLoop::Stop),
+    InstanceMethod("stats", &GameLoop::Stats),
+    InstanceAccessor("running", &GameLoop::GetRunning, nullptr),
+    InstanceAccessor("paused", &GameLoop::GetPaused, nullptr),
+  });
+  addonData(env).loop = Napi::Persistent(ctor);
+  return ctor;
+}
+
+// startLoop(lib, tickSymbol, { hz, maxCatchUpSteps, renderSymbol, onFrame })
+Napi::Value GameLoop::Start(const Napi::CallbackInfo& info) {
+  return addonData(info.Env()).loop.New({ info[0], info[1], info[2] });
+}
+
+GameLoop::GameLoop(const Napi::CallbackInfo& info) : Napi::ObjectWrap<GameLoop>(info) {
+  Napi::Env env = info.Env();
+  std::string error;
+  lib_ = leaseLibrary(info[0], error);
+  if (!lib_) {
+    Napi::Error::New(env, error).ThrowAsJavaScriptException();
+    return;
+  }
+  if (!info[1].IsString()) {
+    Napi::TypeError::New(env, "Expected a tick symbol name").ThrowAsJavaScriptException();
+    return;
+  }
+
+  std::string tickSymbol = info[1].As<Napi::String>();
+  tick_ = safeDlsym<void(*)(float)>(lib_.handle(), tickSymbol, error);
+  if (!tick_) {
+    Napi::Error::New(env, "Symbol not found: " + tickSymbol + ": " + error).ThrowAsJavaScriptException();
+    return;
+  }
+
+  double hz = 60;
+  if (info[2].IsObject()) {
+    Napi::Object options = info[2].As<Napi::Object>();
+    if (options.Get("hz").IsNumber()) hz = options.Get("hz").As<Napi::Number>().DoubleValue();
+    if (options.Get("maxCatchUpSteps").IsNumber())
+      maxCatchUp_ = std::max<int64_t>(1, options.Get("maxCatchUpSteps").As<Napi::Number>().Int64Value());
+    if (options.Get("renderSymbol").IsString()) {
+      std::string renderSymbol = options.Get("renderSymbol").As<Napi::String>();
+      render_ = safeDlsym<void(*)()>(lib_.handle(), renderSymbol, error);
+      if (!render_) {
+        Napi::Error::New(env, "Symbol not found: " + renderSymbol + ": " + error).ThrowAsJavaScriptException();
+        return;
+      }
+    }
+    if (options.Get("onFrame").IsFunction()) onFrame_ = Napi::Persistent(options.Get("onFrame").As<Napi::Function>());
+  }
+  if (!(hz > 0) || !std::isfinite(hz)) {
+    Napi::RangeError::New(env, "hz must be a positive number").ThrowAsJavaScriptException();
+    return;
+  }
+  step_ = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(1.0 / hz));
+  if (step_.count() == 0) {
+    // The backlog is counted in whole steps, so a step must last at least one clock tick
+    Napi::RangeError::New(env, "hz is too high: one step would be shorter than the clock resolution").ThrowAsJavaScriptException();
+    return;
+  }
+
+  intervals_.reserve(kSampleWindow);
+  work_.reserve(kSampleWindow);
+
+  // Like setInterval, a running loop keeps the process alive; the wrapper
+  // itself stays reachable until the frame queue has drained.
+  Ref();
+  frames_ = FrameQueue::New(env, "sljs-loop", 0, 1, this, [](Napi::Env, void*, GameLoop* loop) { loop->Unref(); });
+  napi_add_env_cleanup_hook(env, Cleanup, this);
+
+  running_ = true;
+  thread_ = std::thread(&GameLoop::Run, this);
+}
+
+GameLoop::~GameLoop() {
+  if (thread_.joinable() || running_) {
+    Halt();
+    napi_remove_env_cleanup_hook(Env(), Cleanup, this);
+  }
+}
+
+void GameLoop::Cleanup(void* arg) {
+  static_cast<GameLoop*>(arg)->Halt();
+}
+
+// Stops and joins the loop thread; safe to call more than once
+void GameLoop::Halt() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!running_) return;
+    stopping_ = true;
+    running_ = false;
+  }
+  wake_.notify_all();
+  if (thread_.joinable()) thread_.join();
+  frames_.Release();
+}
+
+void GameLoop::Record(std::vector<float>& samples, size_t& next, float ms) {
+  if (samples.size() < kSampleWindow) samples.push_back(ms);
+  else samples[next] = ms;
+  next = (next + 1) % kSampleWindow;
+}
+
+void GameLoop::Run() {
+  const double stepSeconds = std::chrono::duration<double>(step_).count();
+  const Clock::time_point started = Clock::now();
+  Clock::time_point previous = started;
+  Clock::duration accumulator{};
+  uint64_t frame = 0, ticks = 0;
+
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (!stopping_) {
+    if (paused_) {
+      wake_.wait(lock, [this] { return stopping_ || !paused_; });
+      // Time spent paused is not simulated
+      previous = Clock::now();
+      accumulator = Clock::duration::zero();
+      continue;
+    }
+    lock.unlock();
+
+    Clock::time_point frameStart = Clock::now();
+    Clock::duration interval = frameStart - previous;
+    previous = frameStart;
+    accumulator += interval;
+
+    uint32_t steps = 0;
+    while (accumulator >= step_ && steps < maxCatchUp_) {
+      tick_(static_cast<float>(stepSeconds));
+      accumulator -= step_;
+      steps++;
+    }
+    // Past the catch-up limit the backlog is dropped rather than replayed
+    uint64_t dropped = 0;
+    if (accumulator >= step_) {
+      dropped = accumulator / step_;
+      accumulator %= step_;
+    }
+    if (render_) render_();
+    Clock::duration work = Clock::now() - frameStart;
+    ticks += steps;
+
+    lock.lock();
+    if (frame > 0) Record(intervals_, nextInterval_, static_cast<float>(toMs(interval)));
+    Record(work_, nextWork_, static_cast<float>(toMs(work)));
+    // A frame misses its deadline when it had to catch up or overran its budget
+    if (steps > 1 || dropped > 0 || work > step_) missed_++;
+    droppedSteps_ += dropped;
+    latest_ = { ++frame, ticks, steps, std::chrono::duration<double>(accumulator) / step_,
+                std::chrono::duration<double>(frameStart - started).count() };
+
+    // At most one frame event is in flight; later frames overwrite the
+    // snapshot it will read.
+    if (eventQueued_.exchange(true)) coalesced_++;
+    else if (frames_.NonBlockingCall() != napi_ok) eventQueued_ = false;
+
+    Clock::time_point deadline = frameStart + (step_ - accumulator);
+    wake_.wait_until(lock, deadline, [this] { return stopping_ || paused_; });
+  }
+}
+
+void GameLoop::DeliverFrame(Napi::Env env, Napi::Function, GameLoop* loop, std::nullptr_t*) {
+  Frame frame;
+  {
+    std::lock_guard<std::mutex> lock(loop->mutex_);
+    frame = loop->latest_;
+    loop->eventQueued_ = false;
+  }
+  if (env == nullptr || loop->onFrame_.IsEmpty()) return;
+
+  Napi::HandleScope scope(env);
+  Napi::Object event = Napi::Object::New(env);
+  event.Set("frame", Napi::Number::New(env, static_cast<double>(frame.frame)));
+  event.Set("ticks", Napi::Number::New(env, static_cast<double>(frame.ticks)));
+  event.Set("steps", Napi::Number::New(env, frame.steps));
+  event.Set("alpha", Napi::Number::New(env, frame.alpha));
+  event.Set("elapsed", Napi::Number::New(env, frame.elapsed));
+  loop->onFrame_.Call(loop->Value(), { event });
+}
+
+Napi::Value GameLoop::Pause(const Napi::CallbackInfo& info) {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    paused_ = true;
+  }
+  wake_.notify_all();
+  return info.Env().Undefined();
+}
+
+Napi::Value GameLoop::Resume(const Napi::CallbackInfo& info) {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    paused_ = false;
+  }
+  wake_.notify_all();
+  return info.Env().Undefined();
+}
+
+Napi::Value GameLoop::Stop(const Napi::CallbackInfo& info) {
+  if (running_) {
+    Halt();
+    napi_remove_env_cleanup_hook(info.Env(), Cleanup, this);
+  }
+  return info.Env().Undefined();
+}
+
+Napi::Object percentiles(Napi::Env env, std::vector<float> samples) {
+  Napi::Object out = Napi::Object::New(env);
+  auto at = [&](double q) -> double {
+    if (samples.empty()) return 0;
+    size_t k = std::min(samples.size() - 1, static_cast<size_t>(q * samples.size()));
+    std::nth_element(samples.begin(), samples.begin() + k, samples.end());
+    return samples[k];
+  };
+  out.Set("p50", at(0.50));
+  out.Set("p90", at(0.90));
+  out.Set("p99", at(0.99));
+  out.Set("max", samples.empty() ? 0.0 : static_cast<double>(*std::max_element(samples.begin(), samples.end())));
+  return out;
+}
+
+// stats() -> { frames, ticks, missedDeadlines, droppedSteps, coalescedEvents,
+//              frameTime: { p50, p90, p99, max }, workTime: {...} } (ms)
+Napi::Value GameLoop::Stats(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+  std::vector<float> intervals, work;
+  Frame frame;
+  uint64_t missed, dropped, coalesced;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    intervals = intervals_;
+    work = work_;
+    frame = latest_;
+    missed = missed_;
+    dropped = droppedSteps_;
+    coalesced = coalesced_;
+  }
+
+  Napi::Object stats = Napi::Object::New(env);
+  stats.Set("frames", Napi::Number::New(env, static_cast<double>(frame.frame)));
+  stats.Set("ticks", Napi::Number::New(env, static_cast<double>(frame.ticks)));
+  stats.Set("missedDeadlines", Napi::Number::New(env, static_cast<double>(missed)));
+  stats.Set("droppedSteps", Napi::Number::New(env, static_cast<double>(dropped)));
+  stats.Set("coalescedEvents", Napi::Number::New(env, static_cast<double>(coalesced)));
+  stats.Set("targetMs", Napi::Number::New(env, toMs(step_)));
+  stats.Set("frameTime", percentiles(env, std::move(intervals)));
+  stats.Set("workTime", percentiles(env, std::move(work)));
+  return stats;
+}
+
+Napi::Value GameLoop::GetRunning(const Napi::CallbackInfo& info) {
+  return Napi::Boolean::New(info.Env(), running_);
+}
+
+Napi::Value GameLoop::GetPaused(const Napi::CallbackInfo& info) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return Napi::Boolean::New(info.Env(), paused_);
+}
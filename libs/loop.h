@@ -0,0 +1,80 @@
+#pragma once
+
+#include <napi.h>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "library.h"
+
+// { p50, p90, p99, max } of a window of millisecond samples
+Napi::Object percentiles(Napi::Env env, std::vector<float> samples);
+
+// Fixed-timestep loop returned by startLoop(lib, tickSymbol, options).
+// Ticks run on a dedicated thread against a monotonic clock; JS only sees
+// coalesced frame events, so a slow event loop or a GC pause never delays
+// or bunches up the simulation.
+class GameLoop : public Napi::ObjectWrap<GameLoop> {
+ public:
+  using Clock = std::chrono::steady_clock;
+
+  static Napi::Function Define(Napi::Env env);
+  static Napi::Value Start(const Napi::CallbackInfo& info);
+
+  GameLoop(const Napi::CallbackInfo& info);
+  ~GameLoop();
+
+  // Snapshot handed to the onFrame callback
+  struct Frame {
+    uint64_t frame = 0;
+    uint64_t ticks = 0;
+    uint32_t steps = 0;
+    double alpha = 0;
+    double elapsed = 0;
+  };
+
+ private:
+  Napi::Value Pause(const Napi::CallbackInfo& info);
+  Napi::Value Resume(const Napi::CallbackInfo& info);
+  Napi::Value Stop(const Napi::CallbackInfo& info);
+  Napi::Value Stats(const Napi::CallbackInfo& info);
+  Napi::Value GetRunning(const Napi::CallbackInfo& info);
+  Napi::Value GetPaused(const Napi::CallbackInfo& info);
+
+  void Run();
+  void Halt();
+  void Record(std::vector<float>& samples, size_t& next, float ms);
+  static void DeliverFrame(Napi::Env env, Napi::Function, GameLoop* loop, std::nullptr_t*);
+  static void Cleanup(void* arg);
+
+  using FrameQueue = Napi::TypedThreadSafeFunction<GameLoop, std::nullptr_t, DeliverFrame>;
+
+  LibraryLease lib_;
+  void (*tick_)(float) = nullptr;
+  void (*render_)() = nullptr;
+  Clock::duration step_{};
+  uint32_t maxCatchUp_ = 5;
+
+  std::thread thread_;
+  std::mutex mutex_;
+  std::condition_variable wake_;
+  bool stopping_ = false;
+  bool paused_ = false;
+  bool running_ = false;
+
+  Napi::FunctionReference onFrame_;
+  FrameQueue frames_;
+  std::atomic<bool> eventQueued_{false};
+
+  // Guarded by mutex_
+  Frame latest_;
+  uint64_t missed_ = 0;
+  uint64_t droppedSteps_ = 0;
+  uint64_t coalesced_ = 0;
+  std::vector<float> intervals_;
+  std::vector<float> work_;
+  size_t nextInterval_ = 0;
+  size_t nextWork_ = 0;
+};
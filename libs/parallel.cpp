@@ -0,0 +1,181 @@
+#include "parallel.h"
+#include "arena.h"
+#include "async.h"
+#include "bind.h"
+#include "library.h"
+#include "pool.h"
+#include "stats.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+using MapFunc = void(*)(uint8_t*, size_t);
+using ReduceFunc = void(*)(uint8_t*, size_t, const uint8_t*, size_t);
+
+// Everything one parallelMap call needs, resolved on the JS thread
+struct MapPlan {
+  LibraryLease lib;
+  MapFunc map = nullptr;
+  ReduceFunc reduce = nullptr;
+  SymbolStats* stats = nullptr; // one sample per map chunk while stats are on
+  uint8_t* data = nullptr;
+  size_t length = 0;
+  size_t head = 0;      // unaligned prefix handled as its own chunk
+  size_t chunkSize = 0;
+  size_t chunks = 0;
+  size_t threads = 0;
+  std::vector<uint8_t> acc;
+
+  // Chunk boundaries sit on `alignment` multiples of the absolute address,
+  // so SIMD kernels see aligned starts and no two threads share a cache line.
+  void Chunk(size_t i, uint8_t*& start, size_t& size) const {
+    size_t offset = i == 0 || head == 0 ? i * chunkSize : head + (i - 1) * chunkSize;
+    size_t end = head && i == 0 ? head : offset + chunkSize;
+    start = data + offset;
+    size = std::min(end, length) - offset;
+  }
+};
+
+// Folds chunks into the accumulator strictly in index order while the map
+// is still running: whichever thread completes the next chunk in line
+// drains as far as the completed prefix reaches.
+class OrderedFold {
+ public:
+  explicit OrderedFold(MapPlan& plan) : plan_(plan), done_(new std::atomic<bool>[plan.chunks]) {
+    for (size_t i = 0; i < plan.chunks; ++i) done_[i] = false;
+  }
+
+  void Complete(size_t index) {
+    done_[index].store(true, std::memory_order_release);
+    for (;;) {
+      {
+        std::unique_lock<std::mutex> lock(mutex_, std::try_to_lock);
+        if (!lock) return;
+        size_t next = next_.load(std::memory_order_relaxed);
+        while (next < plan_.chunks && done_[next].load(std::memory_order_acquire)) {
+          uint8_t* start;
+          size_t size;
+          plan_.Chunk(next, start, size);
+          plan_.reduce(plan_.acc.data(), plan_.acc.size(), start, size);
+          next_.store(++next, std::memory_order_release);
+        }
+      }
+      // A chunk finished while we held the lock: its thread could not take
+      // it and left, so check again before leaving too.
+      size_t next = next_.load(std::memory_order_acquire);
+      if (next >= plan_.chunks || !done_[next].load(std::memory_order_acquire)) return;
+    }
+  }
+
+ private:
+  MapPlan& plan_;
+  std::unique_ptr<std::atomic<bool>[]> done_;
+  std::atomic<size_t> next_{0};
+  std::mutex mutex_;
+};
+
+static void runPlan(MapPlan& plan) {
+  std::unique_ptr<OrderedFold> fold;
+  if (plan.reduce) fold.reset(new OrderedFold(plan));
+
+  WorkStealingPool::shared().ParallelFor(plan.chunks, plan.threads, [&](size_t i) {
+    uint8_t* start;
+    size_t size;
+    plan.Chunk(i, start, size);
+    timedCall(plan.stats, [&]() { plan.map(start, size); });
+    if (fold) fold->Complete(i);
+  });
+}
+
+static size_t roundUp(size_t value, size_t multiple) {
+  return (value + multiple - 1) / multiple * multiple;
+}
+
+static std::shared_ptr<MapPlan> preparePlan(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+  auto plan = std::make_shared<MapPlan>();
+
+  std::string error;
+  plan->lib = leaseLibrary(info[0], error);
+  if (!plan->lib) {
+    Napi::Error::New(env, error).ThrowAsJavaScriptException();
+    return nullptr;
+  }
+
+  std::string symbol = info[1].IsString() ? info[1].As<Napi::String>().Utf8Value() : "";
+  plan->map = safeDlsym<MapFunc>(plan->lib.handle(), symbol, error);
+  if (!plan->map) {
+    recordSymbolError(plan->lib.handle(), symbol);
+    Napi::Error::New(env, "Symbol not found: " + symbol + ": " + error).ThrowAsJavaScriptException();
+    return nullptr;
+  }
+
+  if (statsEnabled()) plan->stats = symbolStats(plan->lib.handle(), symbol);
+
+  if (!viewBytes(env, info[2], plan->data, plan->length)) {
+    Napi::TypeError::New(env, "Expected a Buffer, TypedArray, DataView, ArrayBuffer or SharedArrayBuffer").ThrowAsJavaScriptException();
+    return nullptr;
+  }
+
+  Napi::Object options = info[3].IsObject() ? info[3].As<Napi::Object>() : Napi::Object::New(env);
+  auto number = [&](const char* key, size_t fallback) -> size_t {
+    Napi::Value v = options.Get(key);
+    if (!v.IsNumber()) return fallback;
+    int64_t n = v.As<Napi::Number>().Int64Value();
+    return n > 0 ? static_cast<size_t>(n) : fallback;
+  };
+
+  size_t alignment = number("alignment", 64);
+  plan->threads = std::min(number("threads", WorkStealingPool::shared().Size()), WorkStealingPool::shared().Size());
+  // Default: ~8 chunks per thread for stealing to balance, but never tiny
+  size_t fallbackChunk = std::max<size_t>(64 * 1024, plan->length / (plan->threads * 8) + 1);
+  plan->chunkSize = roundUp(number("chunkSize", fallbackChunk), alignment);
+
+  size_t misalignment = reinterpret_cast<uintptr_t>(plan->data) % alignment;
+  plan->head = misalignment ? std::min(alignment - misalignment, plan->length) : 0;
+  plan->chunks = (plan->head ? 1 : 0) + (plan->length - plan->head + plan->chunkSize - 1) / plan->chunkSize;
+
+  if (options.Get("reduce").IsString()) {
+    std::string reduceSymbol = options.Get("reduce").As<Napi::String>();
+    plan->reduce = safeDlsym<ReduceFunc>(plan->lib.handle(), reduceSymbol, error);
+    if (!plan->reduce) {
+      Napi::Error::New(env, "Symbol not found: " + reduceSymbol + ": " + error).ThrowAsJavaScriptException();
+      return nullptr;
+    }
+    uint8_t* initial = nullptr;
+    size_t initialLength = 0;
+    if (viewBytes(env, options.Get("initial"), initial, initialLength)) {
+      plan->acc.assign(initial, initial + initialLength);
+    } else {
+      plan->acc.assign(number("resultSize", 8), 0);
+    }
+  }
+  return plan;
+}
+
+static Napi::Value planResult(Napi::Env env, const MapPlan& plan, const Napi::Value& buffer) {
+  if (!plan.reduce) return buffer;
+  return Napi::Buffer<uint8_t>::Copy(env, plan.acc.data(), plan.acc.size());
+}
+
+Napi::Value ParallelMap(const Napi::CallbackInfo& info) {
+  auto plan = preparePlan(info);
+  if (!plan) return info.Env().Null();
+  runPlan(*plan);
+  return planResult(info.Env(), *plan, info[2]);
+}
+
+Napi::Value ParallelMapAsync(const Napi::CallbackInfo& info) {
+  auto plan = preparePlan(info);
+  if (!plan) return info.Env().Null();
+  // Keeps the buffer alive until the Promise settles; released on the JS thread
+  auto pinned = std::make_shared<Napi::Reference<Napi::Object>>(Napi::Persistent(info[2].As<Napi::Object>()));
+  auto arena = std::make_shared<ArenaPin>(plan->data);
+  return queueAsync(info.Env(),
+    [plan]() { runPlan(*plan); },
+    [plan, pinned, arena](Napi::Env env) { return planResult(env, *plan, pinned->Value()); });
+}
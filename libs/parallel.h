@@ -0,0 +1,11 @@
+#pragma once
+
+#include <napi.h>
+
+// parallelMap(lib, symbol, buffer, { chunkSize, threads, alignment, reduce, resultSize, initial })
+// Runs `void symbol(uint8_t*, size_t)` over aligned chunks of `buffer` on
+// the WorkStealingPool. With `reduce`, every mapped chunk is folded in
+// order into an accumulator by `void reduce(uint8_t* acc, size_t accLen,
+// const uint8_t* chunk, size_t chunkLen)` and the accumulator is returned.
+Napi::Value ParallelMap(const Napi::CallbackInfo& info);
+Napi::Value ParallelMapAsync(const Napi::CallbackInfo& info);
@@ -0,0 +1,341 @@
+#include "pipeline.h"
+#include "bind.h"
+#include "core.h"
+#include "loop.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+// Stage times kept for the percentiles (most recent samples)
+static constexpr size_t kSampleWindow = 1024;
+
+// Slots start on their own cache lines so the two stages never share one
+static constexpr size_t kSlotAlignment = 64;
+
+static double toMs(FramePipeline::Clock::duration d) {
+  return std::chrono::duration<double, std::milli>(d).count();
+}
+
+// new Uint8Array(buffer, offset, length); N-API only builds typed arrays
+// over plain ArrayBuffers
+static napi_value sliceView(napi_env env, napi_value buffer, size_t offset, size_t length) {
+  napi_value global, ctor, args[3], view;
+  args[0] = buffer;
+  if (napi_get_global(env, &global) != napi_ok ||
+      napi_get_named_property(env, global, "Uint8Array", &ctor) != napi_ok ||
+      napi_create_double(env, static_cast<double>(offset), &args[1]) != napi_ok ||
+      napi_create_double(env, static_cast<double>(length), &args[2]) != napi_ok ||
+      napi_new_instance(env, ctor, 3, args, &view) != napi_ok)
+    return nullptr;
+  return view;
+}
+
+void FramePipeline::Samples::Add(float ms) {
+  if (values.size() < kSampleWindow) values.push_back(ms);
+  else values[next] = ms;
+  next = (next + 1) % kSampleWindow;
+}
+
+Napi::Function FramePipeline::Define(Napi::Env env) {
+  Napi::Function ctor = DefineClass(env, "FramePipeline", {
+    InstanceMethod("latest", &FramePipeline::Latest),
+    InstanceMethod("release", &FramePipeline::Unpin),
+    InstanceMethod("stop", &FramePipeline::Stop),
+    InstanceMethod("stats", &FramePipeline::Stats),
+    InstanceAccessor("running", &FramePipeline::GetRunning, nullptr),
+  });
+  addonData(env).pipeline = Napi::Persistent(ctor);
+  return ctor;
+}
+
+// createPipeline(lib, { tick, render, stateSize, depth, hz, paced, initial, onFrame })
+Napi::Value FramePipeline::Create(const Napi::CallbackInfo& info) {
+  return addonData(info.Env()).pipeline.New({ info[0], info[1] });
+}
+
+FramePipeline::FramePipeline(const Napi::CallbackInfo& info) : Napi::ObjectWrap<FramePipeline>(info) {
+  Napi::Env env = info.Env();
+  std::string error;
+  lib_ = leaseLibrary(info[0], error);
+  if (!lib_) {
+    Napi::Error::New(env, error).ThrowAsJavaScriptException();
+    return;
+  }
+  if (!info[1].IsObject() || !info[1].As<Napi::Object>().Get("tick").IsString()) {
+    Napi::TypeError::New(env, "Expected options with a tick symbol").ThrowAsJavaScriptException();
+    return;
+  }
+  Napi::Object options = info[1].As<Napi::Object>();
+
+  std::string tickSymbol = options.Get("tick").As<Napi::String>();
+  tick_ = safeDlsym<void(*)(void*, const void*, float)>(lib_.handle(), tickSymbol, error);
+  if (!tick_) {
+    Napi::Error::New(env, "Symbol not found: " + tickSymbol + ": " + error).ThrowAsJavaScriptException();
+    return;
+  }
+  if (options.Get("render").IsString()) {
+    std::string renderSymbol = options.Get("render").As<Napi::String>();
+    render_ = safeDlsym<void(*)(const void*)>(lib_.handle(), renderSymbol, error);
+    if (!render_) {
+      Napi::Error::New(env, "Symbol not found: " + renderSymbol + ": " + error).ThrowAsJavaScriptException();
+      return;
+    }
+  }
+
+  uint8_t* initial = nullptr;
+  size_t initialSize = 0;
+  Napi::Value initialValue = options.Get("initial");
+  if (!initialValue.IsUndefined() && !viewBytes(env, initialValue, initial, initialSize)) {
+    Napi::TypeError::New(env, "initial must be a Buffer, TypedArray or ArrayBuffer").ThrowAsJavaScriptException();
+    return;
+  }
+  stateSize_ = initialSize;
+  if (options.Get("stateSize").IsNumber())
+    stateSize_ = static_cast<size_t>(std::max<int64_t>(0, options.Get("stateSize").As<Napi::Number>().Int64Value()));
+  if (stateSize_ == 0 || initialSize > stateSize_) {
+    Napi::RangeError::New(env, "stateSize must be positive and at least the size of initial").ThrowAsJavaScriptException();
+    return;
+  }
+
+  if (options.Get("depth").IsNumber()) depth_ = options.Get("depth").As<Napi::Number>().Int32Value();
+  if (depth_ != 2 && depth_ != 3) {
+    Napi::RangeError::New(env, "depth must be 2 or 3").ThrowAsJavaScriptException();
+    return;
+  }
+
+  double hz = 60;
+  if (options.Get("hz").IsNumber()) hz = options.Get("hz").As<Napi::Number>().DoubleValue();
+  if (!(hz > 0) || !std::isfinite(hz)) {
+    Napi::RangeError::New(env, "hz must be a positive number").ThrowAsJavaScriptException();
+    return;
+  }
+  dt_ = static_cast<float>(1.0 / hz);
+  step_ = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(1.0 / hz));
+  paced_ = options.Get("paced").ToBoolean().Value() || options.Get("paced").IsUndefined();
+
+  // All slots share one SharedArrayBuffer, so latest() hands out views
+  // without copying and JS can never detach memory the threads write to
+  stride_ = (stateSize_ + kSlotAlignment - 1) & ~(kSlotAlignment - 1);
+  napi_value buffer = newSharedArrayBuffer(env, stride_ * depth_, memory_);
+  if (!buffer) {
+    Napi::Error::New(env, "Could not allocate a SharedArrayBuffer for the pipeline").ThrowAsJavaScriptException();
+    return;
+  }
+  buffer_ = Napi::Persistent(Napi::Value(env, buffer));
+  for (int i = 0; i < depth_; ++i) {
+    napi_value view = sliceView(env, buffer, i * stride_, stateSize_);
+    if (!view) {
+      Napi::Error::New(env, "Could not create a view of the pipeline state").ThrowAsJavaScriptException();
+      return;
+    }
+    views_.push_back(Napi::Persistent(Napi::Value(env, view)));
+  }
+  if (initial) memcpy(Slot(0), initial, initialSize);
+
+  if (options.Get("onFrame").IsFunction()) onFrame_ = Napi::Persistent(options.Get("onFrame").As<Napi::Function>());
+
+  // Like startLoop, a running pipeline keeps the process alive
+  Ref();
+  frames_ = FrameQueue::New(env, "sljs-pipeline", 0, 1, this, [](Napi::Env, void*, FramePipeline* p) { p->Unref(); });
+  napi_add_env_cleanup_hook(env, Cleanup, this);
+
+  running_ = true;
+  started_ = Clock::now();
+  ticker_ = std::thread(&FramePipeline::TickLoop, this);
+  if (render_) renderer_ = std::thread(&FramePipeline::RenderLoop, this);
+}
+
+FramePipeline::~FramePipeline() {
+  if (running_) {
+    Halt();
+    napi_remove_env_cleanup_hook(Env(), Cleanup, this);
+  }
+}
+
+void FramePipeline::Cleanup(void* arg) {
+  static_cast<FramePipeline*>(arg)->Halt();
+}
+
+// Stops and joins both stage threads; safe to call more than once
+void FramePipeline::Halt() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!running_) return;
+    stopping_ = true;
+    running_ = false;
+    stopped_ = Clock::now();
+  }
+  changed_.notify_all();
+  if (ticker_.joinable()) ticker_.join();
+  if (renderer_.joinable()) renderer_.join();
+  frames_.Release();
+}
+
+int FramePipeline::FreeSlot() const {
+  for (int i = 0; i < depth_; ++i)
+    if (i != latest_ && i != rendering_ && i != pinned_) return i;
+  return -1;
+}
+
+void FramePipeline::TickLoop() {
+  Clock::time_point deadline = Clock::now();
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (!stopping_) {
+    int out = FreeSlot();
+    if (out < 0) {
+      // Every other slot is being read: the slower stage sets the pace
+      Clock::time_point waited = Clock::now();
+      stalls_++;
+      changed_.wait(lock, [&] { return stopping_ || (out = FreeSlot()) >= 0; });
+      stallMs_ += toMs(Clock::now() - waited);
+      if (stopping_) break;
+    }
+    int in = latest_;
+    lock.unlock();
+
+    Clock::time_point start = Clock::now();
+    tick_(Slot(out), Slot(in), dt_);
+    Clock::time_point end = Clock::now();
+
+    lock.lock();
+    latest_ = out;
+    latestFrame_++;
+    tickTime_.Add(static_cast<float>(toMs(end - start)));
+    changed_.notify_all();
+
+    // At most one frame event is in flight, as with startLoop
+    if (eventQueued_.exchange(true)) coalesced_++;
+    else if (frames_.NonBlockingCall() != napi_ok) eventQueued_ = false;
+
+    if (paced_) {
+      deadline += step_;
+      // A late tick moves the schedule instead of bursting to catch up
+      if (deadline < end) deadline = end;
+      changed_.wait_until(lock, deadline, [this] { return stopping_; });
+    }
+  }
+}
+
+// Always renders the newest completed frame; frames completed while a
+// render was running are skipped rather than queued
+void FramePipeline::RenderLoop() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  for (;;) {
+    changed_.wait(lock, [this] { return stopping_ || latestFrame_ > renderedFrame_; });
+    if (stopping_) break;
+    int slot = latest_;
+    uint64_t frame = latestFrame_;
+    skipped_ += frame - renderedFrame_ - 1;
+    rendering_ = slot;
+    lock.unlock();
+
+    Clock::time_point start = Clock::now();
+    render_(Slot(slot));
+    Clock::time_point end = Clock::now();
+
+    lock.lock();
+    rendering_ = -1;
+    renderedFrame_ = frame;
+    rendered_++;
+    renderTime_.Add(static_cast<float>(toMs(end - start)));
+    changed_.notify_all();
+  }
+}
+
+void FramePipeline::DeliverFrame(Napi::Env env, Napi::Function, FramePipeline* pipeline, std::nullptr_t*) {
+  uint64_t frame, rendered;
+  {
+    std::lock_guard<std::mutex> lock(pipeline->mutex_);
+    frame = pipeline->latestFrame_;
+    rendered = pipeline->rendered_;
+    pipeline->eventQueued_ = false;
+  }
+  if (env == nullptr || pipeline->onFrame_.IsEmpty()) return;
+
+  Napi::HandleScope scope(env);
+  Napi::Object event = Napi::Object::New(env);
+  event.Set("frame", Napi::Number::New(env, static_cast<double>(frame)));
+  event.Set("rendered", Napi::Number::New(env, static_cast<double>(rendered)));
+  pipeline->onFrame_.Call(pipeline->Value(), { event });
+}
+
+// latest() -> { frame, state }: `state` is a Uint8Array over the slot itself.
+// The slot is pinned, so tick leaves it alone until the next latest() or
+// release().
+Napi::Value FramePipeline::Latest(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+  int slot;
+  uint64_t frame;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    pinned_ = latest_;
+    slot = pinned_;
+    frame = latestFrame_;
+  }
+  // The previous pin may have been the slot tick was waiting for
+  changed_.notify_all();
+
+  Napi::Object result = Napi::Object::New(env);
+  result.Set("frame", Napi::Number::New(env, static_cast<double>(frame)));
+  result.Set("state", views_[slot].Value());
+  return result;
+}
+
+Napi::Value FramePipeline::Unpin(const Napi::CallbackInfo& info) {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    pinned_ = -1;
+  }
+  changed_.notify_all();
+  return info.Env().Undefined();
+}
+
+Napi::Value FramePipeline::Stop(const Napi::CallbackInfo& info) {
+  if (running_) {
+    Halt();
+    napi_remove_env_cleanup_hook(info.Env(), Cleanup, this);
+  }
+  return info.Env().Undefined();
+}
+
+// stats() -> { depth, frames, rendered, skipped, stalls, stallMs, tickRate,
+//              renderRate, tickTime: { p50, p90, p99, max }, renderTime: {...} }
+Napi::Value FramePipeline::Stats(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+  std::vector<float> tickTime, renderTime;
+  uint64_t frames, rendered, skipped, stalls, coalesced;
+  double stallMs, elapsed;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    tickTime = tickTime_.values;
+    renderTime = renderTime_.values;
+    frames = latestFrame_;
+    rendered = rendered_;
+    skipped = skipped_;
+    stalls = stalls_;
+    stallMs = stallMs_;
+    coalesced = coalesced_;
+    elapsed = std::chrono::duration<double>((running_ ? Clock::now() : stopped_) - started_).count();
+  }
+
+  Napi::Object stats = Napi::Object::New(env);
+  stats.Set("depth", Napi::Number::New(env, depth_));
+  stats.Set("stateSize", Napi::Number::New(env, static_cast<double>(stateSize_)));
+  stats.Set("frames", Napi::Number::New(env, static_cast<double>(frames)));
+  stats.Set("rendered", Napi::Number::New(env, static_cast<double>(rendered)));
+  stats.Set("skipped", Napi::Number::New(env, static_cast<double>(skipped)));
+  stats.Set("stalls", Napi::Number::New(env, static_cast<double>(stalls)));
+  stats.Set("stallMs", Napi::Number::New(env, stallMs));
+  stats.Set("coalescedEvents", Napi::Number::New(env, static_cast<double>(coalesced)));
+  stats.Set("elapsed", Napi::Number::New(env, elapsed));
+  stats.Set("tickRate", Napi::Number::New(env, elapsed > 0 ? frames / elapsed : 0));
+  stats.Set("renderRate", Napi::Number::New(env, elapsed > 0 ? rendered / elapsed : 0));
+  stats.Set("tickTime", percentiles(env, std::move(tickTime)));
+  stats.Set("renderTime", percentiles(env, std::move(renderTime)));
+  return stats;
+}
+
+Napi::Value FramePipeline::GetRunning(const Napi::CallbackInfo& info) {
+  return Napi::Boolean::New(info.Env(), running_);
+}
@@ -0,0 +1,95 @@
+#pragma once
+
+#include <napi.h>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "library.h"
+
+// Frame pipeline returned by createPipeline(lib, options). The library's
+// tick(out, in, dt) and render(state) run on two threads of their own over
+// two or three state slots in one SharedArrayBuffer: tick writes frame N+1
+// into a free slot while render reads frame N from another, so a frame
+// costs the slower of the two stages rather than their sum. JS reads the
+// newest completed state in place through latest().
+class FramePipeline : public Napi::ObjectWrap<FramePipeline> {
+ public:
+  using Clock = std::chrono::steady_clock;
+
+  static Napi::Function Define(Napi::Env env);
+  static Napi::Value Create(const Napi::CallbackInfo& info);
+
+  FramePipeline(const Napi::CallbackInfo& info);
+  ~FramePipeline();
+
+ private:
+  // Most recent stage times in ms, for the percentiles in stats()
+  struct Samples {
+    void Add(float ms);
+    std::vector<float> values;
+    size_t next = 0;
+  };
+
+  Napi::Value Latest(const Napi::CallbackInfo& info);
+  Napi::Value Unpin(const Napi::CallbackInfo& info);
+  Napi::Value Stop(const Napi::CallbackInfo& info);
+  Napi::Value Stats(const Napi::CallbackInfo& info);
+  Napi::Value GetRunning(const Napi::CallbackInfo& info);
+
+  void TickLoop();
+  void RenderLoop();
+  int FreeSlot() const;
+  uint8_t* Slot(int index) const { return memory_ + index * stride_; }
+  void Halt();
+  static void DeliverFrame(Napi::Env env, Napi::Function, FramePipeline* pipeline, std::nullptr_t*);
+  static void Cleanup(void* arg);
+
+  using FrameQueue = Napi::TypedThreadSafeFunction<FramePipeline, std::nullptr_t, DeliverFrame>;
+
+  LibraryLease lib_;
+  void (*tick_)(void*, const void*, float) = nullptr;
+  void (*render_)(const void*) = nullptr;
+  int depth_ = 3;
+  size_t stateSize_ = 0;
+  size_t stride_ = 0;
+  float dt_ = 1.0f / 60;
+  Clock::duration step_{};
+  bool paced_ = true;
+
+  Napi::Reference<Napi::Value> buffer_;
+  std::vector<Napi::Reference<Napi::Value>> views_;
+  uint8_t* memory_ = nullptr;
+
+  std::thread ticker_;
+  std::thread renderer_;
+  std::mutex mutex_;
+  std::condition_variable changed_;
+  bool stopping_ = false;
+  bool running_ = false;
+
+  // Slot ownership, guarded by mutex_. Tick only ever writes a slot that is
+  // neither the latest one nor held by the renderer or by JS.
+  int latest_ = 0;
+  uint64_t latestFrame_ = 0;
+  int rendering_ = -1;
+  int pinned_ = -1;
+  uint64_t renderedFrame_ = 0;
+
+  Napi::FunctionReference onFrame_;
+  FrameQueue frames_;
+  std::atomic<bool> eventQueued_{false};
+
+  // Guarded by mutex_
+  Clock::time_point started_;
+  Clock::time_point stopped_;
+  uint64_t rendered_ = 0;
+  uint64_t skipped_ = 0;
+  uint64_t stalls_ = 0;
+  double stallMs_ = 0;
+  uint64_t coalesced_ = 0;
+  Samples tickTime_;
+  Samples renderTime_;
+};
@@ -0,0 +1,195 @@
+#include "pool.h"
+
+#include <algorithm>
+#include <thread>
+
+ThreadPool& ThreadPool::shared() {
+  // Intentionally leaked: workers may still be parked on the condition
+  // variable while static destructors run at process exit.
+  static ThreadPool* pool = new ThreadPool(std::max(2u, std::thread::hardware_concurrency()));
+  return *pool;
+}
+
+ThreadPool::ThreadPool(size_t threads) : target_(threads ? threads : 1) {}
+
+void ThreadPool::Submit(std::function<void()> task) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  queue_.push_back(std::move(task));
+
+  if (running_ < target_ && running_ < queue_.size() + inFlight_.load()) {
+    running_++;
+    std::thread(&ThreadPool::WorkerLoop, this).detach();
+  } else {
+    wake_.notify_one();
+  }
+}
+
+void ThreadPool::Resize(size_t threads) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  target_ = threads ? threads : 1;
+  while (running_ < target_ && running_ < queue_.size()) {
+    running_++;
+    std::thread(&ThreadPool::WorkerLoop, this).detach();
+  }
+  // Surplus workers notice the smaller target when they wake up
+  wake_.notify_all();
+}
+
+size_t ThreadPool::Size() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return target_;
+}
+
+size_t ThreadPool::Queued() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return queue_.size();
+}
+
+void ThreadPool::WorkerLoop() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  for (;;) {
+    wake_.wait(lock, [this] { return !queue_.empty() || running_ > target_; });
+    if (running_ > target_) break;
+
+    std::function<void()> task = std::move(queue_.front());
+    queue_.pop_front();
+    inFlight_++;
+
+    lock.unlock();
+    task();
+    task = nullptr;
+    lock.lock();
+
+    inFlight_--;
+  }
+  running_--;
+}
+
+// Work-stealing pool
+
+// One thread's share of a job: [lo, hi) packed into a single word so the
+// owner (taking from the front) and thieves (taking the upper half) can
+// both claim indices with one CAS.
+struct alignas(64) StealRange {
+  std::atomic<uint64_t> packed{0};
+
+  static uint64_t Pack(uint32_t lo, uint32_t hi) { return (uint64_t(hi) << 32) | lo; }
+  static uint32_t Lo(uint64_t v) { return static_cast<uint32_t>(v); }
+  static uint32_t Hi(uint64_t v) { return static_cast<uint32_t>(v >> 32); }
+
+  bool Pop(size_t& index) {
+    uint64_t v = packed.load(std::memory_order_acquire);
+    while (Lo(v) < Hi(v)) {
+      if (packed.compare_exchange_weak(v, Pack(Lo(v) + 1, Hi(v)), std::memory_order_acq_rel)) {
+        index = Lo(v);
+        return true;
+      }
+    }
+    return false;
+  }
+
+  bool Steal(uint32_t& lo, uint32_t& hi) {
+    uint64_t v = packed.load(std::memory_order_acquire);
+    while (Lo(v) < Hi(v)) {
+      uint32_t mid = Lo(v) + (Hi(v) - Lo(v)) / 2;
+      if (packed.compare_exchange_weak(v, Pack(Lo(v), mid), std::memory_order_acq_rel)) {
+        lo = mid;
+        hi = Hi(v);
+        return true;
+      }
+    }
+    return false;
+  }
+};
+
+struct WorkStealingPool::Job {
+  Job(size_t count, size_t threads, const std::function<void(size_t)>& body)
+      : body(body), slots(threads), remaining(count) {
+    for (size_t s = 0; s < threads; ++s)
+      slots[s].packed = StealRange::Pack(static_cast<uint32_t>(s * count / threads),
+                                         static_cast<uint32_t>((s + 1) * count / threads));
+  }
+
+  const std::function<void(size_t)>& body;
+  std::vector<StealRange> slots;
+  std::atomic<size_t> joined{0};
+  std::atomic<size_t> remaining;
+  std::mutex doneMutex;
+  std::condition_variable done;
+};
+
+WorkStealingPool& WorkStealingPool::shared() {
+  // Leaked for the same reason as ThreadPool::shared()
+  static WorkStealingPool* pool = new WorkStealingPool(std::max(1u, std::thread::hardware_concurrency()) - 1);
+  return *pool;
+}
+
+WorkStealingPool::WorkStealingPool(size_t workers) : workers_(workers) {
+  for (size_t i = 0; i < workers_; ++i) std::thread(&WorkStealingPool::WorkerLoop, this).detach();
+}
+
+void WorkStealingPool::ParallelFor(size_t count, size_t threads, const std::function<void(size_t)>& body) {
+  if (count == 0) return;
+  threads = std::max<size_t>(1, std::min({ threads, Size(), count }));
+
+  auto job = std::make_shared<Job>(count, threads, body);
+  job->joined = 1; // slot 0 is the caller's
+  if (threads > 1) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    jobs_.push_back(job);
+    for (size_t i = 1; i < threads; ++i) wake_.notify_one();
+  }
+
+  Work(*job, 0);
+
+  std::unique_lock<std::mutex> doneLock(job->doneMutex);
+  job->done.wait(doneLock, [&] { return job->remaining.load() == 0; });
+  doneLock.unlock();
+
+  if (threads > 1) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = std::find(jobs_.begin(), jobs_.end(), job);
+    if (it != jobs_.end()) jobs_.erase(it);
+  }
+}
+
+void WorkStealingPool::Work(Job& job, size_t slot) {
+  StealRange& own = job.slots[slot];
+  for (;;) {
+    size_t index;
+    if (!own.Pop(index)) {
+      // Own range is empty: steal half of someone else's, starting with
+      // the next slot so thieves spread out instead of piling on one.
+      uint32_t lo = 0, hi = 0;
+      bool stolen = false;
+      for (size_t k = 1; k < job.slots.size() && !stolen; ++k)
+        stolen = job.slots[(slot + k) % job.slots.size()].Steal(lo, hi);
+      if (!stolen) return;
+      index = lo;
+      own.packed.store(StealRange::Pack(lo + 1, hi), std::memory_order_release);
+    }
+
+    job.body(index);
+    if (job.remaining.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+      std::lock_guard<std::mutex> lock(job.doneMutex);
+      job.done.notify_all();
+    }
+  }
+}
+
+void WorkStealingPool::WorkerLoop() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  for (;;) {
+    wake_.wait(lock, [this] { return !jobs_.empty(); });
+
+    std::shared_ptr<Job> job = jobs_.front();
+    size_t slot = job->joined.fetch_add(1);
+    if (slot + 1 >= job->slots.size()) jobs_.pop_front();
+    if (slot >= job->slots.size()) continue;
+
+    lock.unlock();
+    Work(*job, slot);
+    job = nullptr;
+    lock.lock();
+  }
+}
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+// Bounded set of native worker threads shared by every *Async call.
+// Threads are started lazily and can be resized at runtime; the queue and
+// in-flight counters are exposed to JS for backpressure.
+class ThreadPool {
+ public:
+  static ThreadPool& shared();
+
+  explicit ThreadPool(size_t threads);
+
+  void Submit(std::function<void()> task);
+  void Resize(size_t threads);
+
+  size_t Size();
+  size_t Queued();
+  size_t InFlight() const { return inFlight_.load(std::memory_order_relaxed); }
+
+ private:
+  void WorkerLoop();
+
+  std::mutex mutex_;
+  std::condition_variable wake_;
+  std::deque<std::function<void()>> queue_;
+  size_t target_;
+  size_t running_ = 0;
+  std::atomic<size_t> inFlight_{0};
+};
+
+// Data-parallel companion to ThreadPool used by parallelMap. Each call
+// splits [0, count) into one contiguous range per participating thread;
+// a thread that runs out steals the upper half of another thread's range,
+// so uneven chunks still keep every core busy. The calling thread always
+// takes part, so a call never waits on a busy pool to make progress.
+class WorkStealingPool {
+ public:
+  static WorkStealingPool& shared();
+
+  explicit WorkStealingPool(size_t workers);
+
+  // Runs body(i) for every i in [0, count) on up to `threads` threads,
+  // the caller included, and returns once all of them have finished.
+  void ParallelFor(size_t count, size_t threads, const std::function<void(size_t)>& body);
+
+  size_t Size() const { return workers_ + 1; }
+
+ private:
+  struct Job;
+
+  void WorkerLoop();
+  static void Work(Job& job, size_t slot);
+
+  std::mutex mutex_;
+  std::condition_variable wake_;
+  std::deque<std::shared_ptr<Job>> jobs_;
+  size_t workers_;
+};
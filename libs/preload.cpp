@@ -0,0 +1,154 @@
+#include "preload.h"
+#include "async.h"
+#include "bind.h"
+#include "library.h"
+#include "pool.h"
+#include "typed.h"
+
+#include <dlfcn.h>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+struct PreloadEntry {
+  std::string path;
+  int flags = RTLD_NOW;
+  std::vector<std::pair<std::string, std::string>> symbols; // name, signature
+
+  // Filled in on the worker threads
+  LibraryLease lib;
+  uint64_t loadNs = 0;
+  uint64_t resolveNs = 0;
+  std::vector<std::string> failures;
+};
+
+struct PreloadJob {
+  std::vector<PreloadEntry> entries;
+  size_t threads = 0;
+  uint64_t totalNs = 0;
+};
+
+static bool validSignature(const std::string& signature, std::string& error) {
+  if (findSignature(signature)) return true;
+  TypedSignature parsed;
+  return parseTypedSignature(signature, parsed, error);
+}
+
+// Runs on a worker: open (or find in the cache) and look up every symbol.
+// The cache keys on the flags, so a handle opened lazily elsewhere never
+// stands in for the eager load asked for here.
+static void loadEntry(PreloadEntry& entry) {
+  std::string error;
+  uint64_t start = monotonicNs();
+  entry.lib = LibraryLease(acquireLibrary(entry.path, entry.flags, error));
+  entry.loadNs = monotonicNs() - start;
+  if (!entry.lib) {
+    // dlerror() already names the file
+    entry.failures.push_back(error.find(entry.path) == std::string::npos ? entry.path + ": " + error : error);
+    return;
+  }
+
+  start = monotonicNs();
+  for (const auto& symbol : entry.symbols) {
+    if (!safeDlsym<void*>(entry.lib.handle(), symbol.first, error)) entry.failures.push_back(entry.path + ": missing symbol " + symbol.first);
+  }
+  entry.resolveNs = monotonicNs() - start;
+}
+
+static Napi::Value settlePreload(Napi::Env env, PreloadJob& job) {
+  std::vector<std::string> failures;
+  for (PreloadEntry& entry : job.entries) failures.insert(failures.end(), entry.failures.begin(), entry.failures.end());
+  if (!failures.empty()) {
+    for (PreloadEntry& entry : job.entries) entry.lib = LibraryLease();
+    std::string message = "preload failed: " + failures[0];
+    if (failures.size() > 1) message += " (and " + std::to_string(failures.size() - 1) + " more)";
+    Napi::Error error = Napi::Error::New(env, message);
+    Napi::Array list = Napi::Array::New(env, failures.size());
+    for (size_t i = 0; i < failures.size(); i++) list.Set(static_cast<uint32_t>(i), failures[i]);
+    error.Set("failures", list);
+    error.ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  // Everything is mapped and resolved; these are cache hits and table lookups
+  Napi::Array libraries = Napi::Array::New(env, job.entries.size());
+  for (size_t i = 0; i < job.entries.size(); i++) {
+    PreloadEntry& entry = job.entries[i];
+    Napi::Value lib = newLibrary(env, entry.path, entry.flags);
+    if (lib.IsEmpty()) return env.Null();
+    Napi::Function bind = lib.As<Napi::Object>().Get("bind").As<Napi::Function>();
+    Napi::Object functions = Napi::Object::New(env);
+    for (const auto& symbol : entry.symbols) {
+      Napi::Value fn = bind.Call(lib, { Napi::String::New(env, symbol.first), Napi::String::New(env, symbol.second) });
+      if (env.IsExceptionPending()) return env.Null();
+      functions.Set(symbol.first, fn);
+    }
+    entry.lib = LibraryLease(); // the Library object holds its own reference now
+
+    Napi::Object result = Napi::Object::New(env);
+    result.Set("path", lib.As<Napi::Object>().Get("path"));
+    result.Set("lib", lib);
+    result.Set("functions", functions);
+    result.Set("loadMs", Napi::Number::New(env, entry.loadNs / 1e6));
+    result.Set("resolveMs", Napi::Number::New(env, entry.resolveNs / 1e6));
+    libraries.Set(static_cast<uint32_t>(i), result);
+  }
+
+  Napi::Object out = Napi::Object::New(env);
+  out.Set("totalMs", Napi::Number::New(env, job.totalNs / 1e6));
+  out.Set("libraries", libraries);
+  return out;
+}
+
+Napi::Value Preload(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+  if (!info[0].IsArray()) {
+    Napi::TypeError::New(env, "Expected a manifest array").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  // The manifest is checked in full before anything is loaded
+  auto job = std::make_shared<PreloadJob>();
+  Napi::Array manifest = info[0].As<Napi::Array>();
+  for (uint32_t i = 0; i < manifest.Length(); i++) {
+    Napi::Value item = manifest.Get(i);
+    if (!item.IsObject() || !item.As<Napi::Object>().Get("path").IsString()) {
+      Napi::TypeError::New(env, "Manifest entry " + std::to_string(i) + " needs a path").ThrowAsJavaScriptException();
+      return env.Null();
+    }
+    Napi::Object spec = item.As<Napi::Object>();
+    PreloadEntry entry;
+    entry.path = spec.Get("path").As<Napi::String>();
+    if (spec.Get("flags").IsNumber()) {
+      entry.flags = spec.Get("flags").As<Napi::Number>().Int32Value();
+      if (!(entry.flags & (RTLD_LAZY | RTLD_NOW))) entry.flags |= RTLD_NOW;
+    }
+    if (spec.Get("symbols").IsObject()) {
+      Napi::Object symbols = spec.Get("symbols").As<Napi::Object>();
+      Napi::Array names = symbols.GetPropertyNames();
+      for (uint32_t j = 0; j < names.Length(); j++) {
+        std::string name = names.Get(j).ToString();
+        std::string signature = symbols.Get(name).ToString();
+        std::string error;
+        if (!validSignature(signature, error)) {
+          Napi::TypeError::New(env, entry.path + ": " + name + ": " + error).ThrowAsJavaScriptException();
+          return env.Null();
+        }
+        entry.symbols.emplace_back(name, signature);
+      }
+    }
+    job->entries.push_back(std::move(entry));
+  }
+  if (info[1].IsObject() && info[1].As<Napi::Object>().Get("threads").IsNumber())
+    job->threads = info[1].As<Napi::Object>().Get("threads").As<Napi::Number>().Uint32Value();
+  if (job->threads == 0) job->threads = WorkStealingPool::shared().Size();
+
+  return queueAsync(env,
+    [job]() {
+      uint64_t start = monotonicNs();
+      WorkStealingPool::shared().ParallelFor(job->entries.size(), job->threads, [&](size_t i) { loadEntry(job->entries[i]); });
+      job->totalNs = monotonicNs() - start;
+    },
+    [job](Napi::Env env) { return settlePreload(env, *job); });
+}
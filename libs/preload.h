@@ -0,0 +1,10 @@
+#pragma once
+
+#include <napi.h>
+
+// preload([{ path, flags, symbols: { name: signature } }], { threads })
+//   -> Promise<{ totalMs, libraries: [{ path, lib, functions, loadMs, resolveMs }] }>
+// Opens every library (RTLD_NOW unless flags say otherwise) and resolves
+// every listed symbol on worker threads, then binds them on the JS thread.
+// Rejects, with nothing left loaded, if any library or symbol is missing.
+Napi::Value Preload(const Napi::CallbackInfo& info);
@@ -0,0 +1,367 @@
+#include "reload.h"
+#include "core.h"
+#include "stats.h"
+
+#include <dlfcn.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <link.h>
+#include <poll.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/inotify.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <atomic>
+#include <memory>
+#include <utility>
+#include <vector>
+
+FileSignature fileSignature(const std::string& path) {
+  FileSignature signature;
+  struct stat st;
+  if (stat(path.c_str(), &st) != 0) return signature;
+  signature.exists = true;
+  signature.device = st.st_dev;
+  signature.inode = st.st_ino;
+  signature.size = st.st_size;
+  signature.mtimeNs = static_cast<int64_t>(st.st_mtim.tv_sec) * 1000000000 + st.st_mtim.tv_nsec;
+  return signature;
+}
+
+std::string sourceFileFor(const std::string& opened, void* handle) {
+  if (opened.find('/') == std::string::npos) {
+    link_map* map = nullptr;
+    if (dlinfo(handle, RTLD_DI_LINKMAP, &map) == 0 && map && map->l_name && *map->l_name) return map->l_name;
+    return opened;
+  }
+  if (opened[0] == '/') return opened;
+  char cwd[PATH_MAX];
+  if (!getcwd(cwd, sizeof(cwd))) return opened;
+  return std::string(cwd) + "/" + opened;
+}
+
+static bool copyFile(int in, int out, std::string& error) {
+  std::vector<char> buffer(256 * 1024);
+  for (;;) {
+    ssize_t got = read(in, buffer.data(), buffer.size());
+    if (got == 0) return true;
+    if (got < 0) {
+      if (errno == EINTR) continue;
+      error = std::string("read failed: ") + strerror(errno);
+      return false;
+    }
+    for (ssize_t done = 0; done < got;) {
+      ssize_t put = write(out, buffer.data() + done, got - done);
+      if (put < 0) {
+        if (errno == EINTR) continue;
+        error = std::string("write failed: ") + strerror(errno);
+        return false;
+      }
+      done += put;
+    }
+  }
+}
+
+SharedLibrary* loadGeneration(const std::string& path, int flags, std::string& error) {
+  static std::atomic<uint64_t> counter{0};
+
+  // The copy sits next to the original, hidden and uniquely named, so
+  // $ORIGIN-relative dependencies still resolve and a noexec /tmp does not
+  // matter. It is unlinked as soon as it is mapped.
+  size_t slash = path.rfind('/');
+  std::string dir = slash == std::string::npos ? "." : path.substr(0, slash == 0 ? 1 : slash);
+  std::string copy = (dir == "/" ? "" : dir) + "/." + path.substr(slash + 1) + ".sljs-" +
+                     std::to_string(getpid()) + "-" + std::to_string(++counter);
+
+  int in = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+  if (in < 0) {
+    error = "cannot open " + path + ": " + strerror(errno);
+    return nullptr;
+  }
+  int out = open(copy.c_str(), O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC, 0700);
+  if (out < 0) {
+    error = "cannot create " + copy + ": " + strerror(errno);
+    close(in);
+    return nullptr;
+  }
+
+  bool copied = copyFile(in, out, error);
+  close(in);
+  if (close(out) != 0 && copied) {
+    error = std::string("write failed: ") + strerror(errno);
+    copied = false;
+  }
+
+  SharedLibrary* lib = copied ? acquireLibrary(copy, flags, error) : nullptr;
+  unlink(copy.c_str());
+  return lib;
+}
+
+// Watcher thread
+
+LibraryWatcher::LibraryWatcher(Queue queue, std::string path, int flags, Options options)
+    : queue_(queue), path_(std::move(path)), flags_(flags), options_(options) {
+  size_t slash = path_.rfind('/');
+  name_ = path_.substr(slash + 1);
+  loaded_ = fileSignature(path_);
+
+  if (pipe2(wake_, O_CLOEXEC) != 0) wake_[0] = wake_[1] = -1;
+
+  // The directory is watched rather than the file, so replacing the file
+  // by rename (how `install` and most deploy tools do it) is seen as well.
+  if (!options_.poll) {
+    inotify_ = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    std::string dir = slash == 0 ? "/" : path_.substr(0, slash);
+    uint32_t mask = IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE | IN_DELETE | IN_MODIFY | IN_ATTRIB;
+    if (inotify_ >= 0 && inotify_add_watch(inotify_, dir.c_str(), mask) < 0) {
+      close(inotify_);
+      inotify_ = -1;
+    }
+  }
+
+  thread_ = std::thread(&LibraryWatcher::Run, this);
+}
+
+LibraryWatcher::~LibraryWatcher() {
+  Stop();
+}
+
+void LibraryWatcher::Stop() {
+  if (stopped_) return;
+  stopped_ = true;
+
+  if (wake_[1] >= 0) {
+    char byte = 1;
+    while (write(wake_[1], &byte, 1) < 0 && errno == EINTR) {}
+  }
+  if (thread_.joinable()) thread_.join();
+
+  for (int fd : { inotify_, wake_[0], wake_[1] })
+    if (fd >= 0) close(fd);
+  inotify_ = wake_[0] = wake_[1] = -1;
+  queue_.Release();
+}
+
+void LibraryWatcher::MarkLoaded(const FileSignature& signature) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  loaded_ = signature;
+}
+
+// True if an event names the watched file (or events were lost)
+bool LibraryWatcher::DrainEvents() {
+  alignas(inotify_event) char buffer[4096];
+  bool relevant = false;
+  for (;;) {
+    ssize_t got = read(inotify_, buffer, sizeof(buffer));
+    if (got <= 0) return relevant;
+    for (char* p = buffer; p < buffer + got;) {
+      auto* event = reinterpret_cast<inotify_event*>(p);
+      if ((event->mask & IN_Q_OVERFLOW) || (event->len && name_ == event->name)) relevant = true;
+      p += sizeof(inotify_event) + event->len;
+    }
+  }
+}
+
+// Sleeps up to `timeoutMs`; returns false once Stop() has been called
+bool LibraryWatcher::Wait(uint32_t timeoutMs, bool& changed) {
+  pollfd fds[2] = { { wake_[0], POLLIN, 0 }, { inotify_, POLLIN, 0 } };
+  nfds_t count = inotify_ >= 0 ? 2 : 1;
+  if (poll(fds, count, static_cast<int>(timeoutMs)) < 0 && errno != EINTR) return false;
+  if (fds[0].revents) return false;
+  if (count == 2 && (fds[1].revents & POLLIN)) changed = DrainEvents() || changed;
+  return true;
+}
+
+void LibraryWatcher::Run() {
+  for (;;) {
+    bool changed = false;
+    if (!Wait(options_.intervalMs, changed)) return;
+
+    FileSignature current = fileSignature(path_);
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (current == loaded_) continue;
+    }
+
+    // Let the writer finish: the file must look the same for one full
+    // settle period with no events in between.
+    for (;;) {
+      bool busy = false;
+      if (!Wait(options_.settleMs, busy)) return;
+      FileSignature next = fileSignature(path_);
+      if (!busy && next == current) break;
+      current = next;
+    }
+    // A deleted file keeps the running generation until it comes back
+    if (!current.exists) continue;
+
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (current == loaded_) continue;
+      // Recorded before loading so a broken build is reported once, not retried
+      loaded_ = current;
+    }
+
+    auto* load = new GenerationLoad();
+    uint64_t start = monotonicNs();
+    load->lib = loadGeneration(path_, flags_, load->error);
+    load->loadNs = monotonicNs() - start;
+    if (queue_.BlockingCall(load) != napi_ok) {
+      if (load->lib) releaseLibrary(load->lib);
+      delete load;
+      return;
+    }
+  }
+}
+
+// Library side
+
+// Every binding is resolved against `next` before anything changes, so a
+// generation missing a symbol leaves the running one untouched. Calls in
+// flight keep their own lease on the old generation, which is dlclose'd
+// when the last of them (and of these references) lets go.
+bool Library::Adopt(SharedLibrary* next, std::string& error) {
+  std::vector<std::pair<SymbolBinding*, void*>> resolved;
+  resolved.reserve(bindings_->size());
+  for (SymbolBinding* binding : *bindings_) {
+    void* fn = safeDlsym<void*>(next->handle, binding->name, error);
+    if (!fn) {
+      error = "new generation lacks " + binding->name + ": " + error;
+      return false;
+    }
+    resolved.emplace_back(binding, fn);
+  }
+
+  for (auto& [binding, fn] : resolved) {
+    retainLibrary(next);
+    releaseLibrary(binding->lib);
+    binding->lib = next;
+    binding->fn = fn;
+    binding->stats = nullptr;
+  }
+
+  SharedLibrary* previous = lib_;
+  lib_ = next;
+  generation_++;
+  releaseLibrary(previous);
+  return true;
+}
+
+void Library::DeliverGeneration(Napi::Env env, Napi::Function, Library* library, GenerationLoad* load) {
+  std::unique_ptr<GenerationLoad> owned(load);
+  // Torn down, or closed while the load was in flight
+  if (env == nullptr || !library->lib_) {
+    if (load->lib) releaseLibrary(load->lib);
+    return;
+  }
+
+  Napi::HandleScope scope(env);
+  std::string error = load->error;
+  uint64_t start = monotonicNs();
+  bool adopted = load->lib && library->Adopt(load->lib, error);
+  uint64_t switchNs = monotonicNs() - start;
+
+  Napi::Object event = Napi::Object::New(env);
+  event.Set("path", library->sourcePath_);
+  event.Set("generation", Napi::Number::New(env, static_cast<double>(library->generation_)));
+
+  if (!adopted) {
+    if (load->lib) releaseLibrary(load->lib);
+    event.Set("error", error);
+    if (library->onError_.IsEmpty()) logToJs("[ERROR] reload of " + library->sourcePath_ + " failed: " + error);
+    else library->onError_.Call(library->Value(), { event });
+    return;
+  }
+
+  event.Set("bindings", Napi::Number::New(env, static_cast<double>(library->bindings_->size())));
+  event.Set("loadNs", Napi::Number::New(env, static_cast<double>(load->loadNs)));
+  event.Set("switchNs", Napi::Number::New(env, static_cast<double>(switchNs)));
+  if (!library->onReload_.IsEmpty()) library->onReload_.Call(library->Value(), { event });
+}
+
+// watch({ poll, interval, settle, persistent, onReload, onError })
+Napi::Value Library::Watch(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+  if (!lib_) {
+    Napi::Error::New(env, "Library is closed").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+  StopWatching();
+
+  LibraryWatcher::Options options;
+  bool persistent = true;
+  onReload_.Reset();
+  onError_.Reset();
+  if (info[0].IsObject()) {
+    Napi::Object opts = info[0].As<Napi::Object>();
+    auto millis = [&](const char* key, uint32_t fallback) -> uint32_t {
+      Napi::Value v = opts.Get(key);
+      if (!v.IsNumber()) return fallback;
+      int64_t ms = v.As<Napi::Number>().Int64Value();
+      return ms < 1 ? 1 : ms > INT_MAX ? INT_MAX : static_cast<uint32_t>(ms);
+    };
+    options.poll = opts.Get("poll").ToBoolean().Value();
+    options.intervalMs = millis("interval", options.intervalMs);
+    options.settleMs = millis("settle", options.settleMs);
+    if (opts.Has("persistent")) persistent = opts.Get("persistent").ToBoolean().Value();
+    if (opts.Get("onReload").IsFunction()) onReload_ = Napi::Persistent(opts.Get("onReload").As<Napi::Function>());
+    if (opts.Get("onError").IsFunction()) onError_ = Napi::Persistent(opts.Get("onError").As<Napi::Function>());
+  }
+
+  // The wrapper stays reachable while it is watched, like GameLoop
+  Ref();
+  auto queue = LibraryWatcher::Queue::New(env, "sljs-reload", 0, 1, this, [](Napi::Env, void*, Library* library) { library->Unref(); });
+  if (!persistent) queue.Unref(env);
+  watcher_.reset(new LibraryWatcher(queue, sourcePath_, lib_->flags, options));
+  napi_add_env_cleanup_hook(env, CleanupWatcher, this);
+  return Value();
+}
+
+Napi::Value Library::Unwatch(const Napi::CallbackInfo& info) {
+  StopWatching();
+  return info.Env().Undefined();
+}
+
+void Library::StopWatching() {
+  if (!watcher_) return;
+  watcher_->Stop();
+  watcher_.reset();
+  napi_remove_env_cleanup_hook(Env(), CleanupWatcher, this);
+}
+
+void Library::CleanupWatcher(void* arg) {
+  auto* library = static_cast<Library*>(arg);
+  if (library->watcher_) library->watcher_->Stop();
+  library->watcher_.reset();
+}
+
+// reload(): loads the file now and switches over; throws (keeping the
+// running generation) if it cannot be loaded or lacks a bound symbol.
+Napi::Value Library::Reload(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+  if (!lib_) {
+    Napi::Error::New(env, "Library is closed").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  FileSignature signature = fileSignature(sourcePath_);
+  std::string error;
+  SharedLibrary* next = loadGeneration(sourcePath_, lib_->flags, error);
+  if (!next || !Adopt(next, error)) {
+    if (next) releaseLibrary(next);
+    Napi::Error::New(env, "Reload of " + sourcePath_ + " failed: " + error).ThrowAsJavaScriptException();
+    return env.Null();
+  }
+  if (watcher_) watcher_->MarkLoaded(signature);
+  return Napi::Number::New(env, static_cast<double>(generation_));
+}
+
+Napi::Value Library::GetGeneration(const Napi::CallbackInfo& info) {
+  return Napi::Number::New(info.Env(), static_cast<double>(generation_));
+}
+
+Napi::Value Library::GetWatching(const Napi::CallbackInfo& info) {
+  return Napi::Boolean::New(info.Env(), watcher_ != nullptr);
+}
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <napi.h>
+#include <sys/types.h>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include "library.h"
+
+// Identity of the file behind a path; any field changing means the file
+// was rewritten or replaced.
+struct FileSignature {
+  bool exists = false;
+  dev_t device = 0;
+  ino_t inode = 0;
+  off_t size = 0;
+  int64_t mtimeNs = 0;
+
+  bool operator==(const FileSignature& other) const {
+    return exists == other.exists && device == other.device && inode == other.inode &&
+           size == other.size && mtimeNs == other.mtimeNs;
+  }
+  bool operator!=(const FileSignature& other) const { return !(*this == other); }
+};
+
+FileSignature fileSignature(const std::string& path);
+
+// File a Library opened as `opened` should reload from: relative paths are
+// made absolute and bare sonames resolved to the file the linker picked.
+std::string sourceFileFor(const std::string& opened, void* handle);
+
+// Loads `path` as a fresh generation. The file is copied to a unique name
+// first, because the dynamic linker would otherwise hand back the handle
+// it already has for that path; the copy is unlinked once it is mapped.
+SharedLibrary* loadGeneration(const std::string& path, int flags, std::string& error);
+
+// A generation loaded off the JS thread, on its way to Library::Adopt
+struct GenerationLoad {
+  SharedLibrary* lib = nullptr; // null when loading failed
+  std::string error;
+  uint64_t loadNs = 0;
+};
+
+// Background thread behind lib.watch(). It waits on inotify for the file's
+// directory (and re-stats every `intervalMs` as a fallback, or only that
+// with `poll`). Once the file has stopped changing for `settleMs` it loads
+// the new generation itself, so the JS thread only does the switchover.
+class LibraryWatcher {
+ public:
+  using Queue = Napi::TypedThreadSafeFunction<Library, GenerationLoad, Library::DeliverGeneration>;
+
+  struct Options {
+    bool poll = false;
+    uint32_t intervalMs = 250;
+    uint32_t settleMs = 50;
+  };
+
+  LibraryWatcher(Queue queue, std::string path, int flags, Options options);
+  ~LibraryWatcher();
+
+  // Records a generation loaded by reload() so the watcher does not load it again
+  void MarkLoaded(const FileSignature& signature);
+
+  // Joins the thread and releases the queue; safe to call more than once
+  void Stop();
+
+ private:
+  void Run();
+  bool Wait(uint32_t timeoutMs, bool& changed);
+  bool DrainEvents();
+
+  Queue queue_;
+  std::string path_;
+  std::string name_;
+  int flags_;
+  Options options_;
+
+  int inotify_ = -1;
+  int wake_[2] = { -1, -1 };
+  std::thread thread_;
+  bool stopped_ = false;
+
+  std::mutex mutex_;
+  FileSignature loaded_;
+};
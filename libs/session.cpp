@@ -0,0 +1,528 @@
+#include "session.h"
+#include "async.h"
+#include "bind.h"
+#include "core.h"
+#include "stats.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <termios.h>
+#include <unistd.h>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+// Written to the pty after every run. Unlike a pipe, a pty hands data to
+// the master side asynchronously, so "read until EAGAIN" does not prove a
+// run's output is complete; seeing this marker does. It is an APC escape
+// sequence, which terminals ignore and programs have no reason to print.
+static const char kFrameMarker[] = "\x1b_sljs-frame\x1b\\";
+static const size_t kFrameMarkerLength = sizeof(kFrameMarker) - 1;
+
+struct SessionRun {
+  LibraryLease lib;
+  std::string symbol;
+  void* fn = nullptr;
+  bool withArgs = false;
+  std::vector<std::string> args;
+  uint64_t seq = 0;
+  std::string out;
+  std::string err;
+  std::string error;
+};
+
+static void setNonBlocking(int fd, bool on) {
+  int flags = fcntl(fd, F_GETFL);
+  fcntl(fd, F_SETFL, on ? flags | O_NONBLOCK : flags & ~O_NONBLOCK);
+}
+
+Napi::Function Session::Define(Napi::Env env) {
+  Napi::Function ctor = DefineClass(env, "Session", {
+    InstanceMethod("run", &Session::Run),
+    InstanceMethod("runAsync", &Session::RunAsync),
+    InstanceMethod("write", &Session::Write),
+    InstanceMethod("end", &Session::End),
+    InstanceMethod("stats", &Session::Stats),
+    InstanceMethod("close", &Session::Close),
+  });
+  addonData(env).session = Napi::Persistent(ctor);
+  return ctor;
+}
+
+// createSession({ pty, stderr, onOutput })
+Napi::Value Session::Create(const Napi::CallbackInfo& info) {
+  return addonData(info.Env()).session.New({ info[0] });
+}
+
+Session::Session(const Napi::CallbackInfo& info) : Napi::ObjectWrap<Session>(info) {
+  Napi::Env env = info.Env();
+  if (info[0].IsObject()) {
+    Napi::Object options = info[0].As<Napi::Object>();
+    pty_ = options.Get("pty").ToBoolean();
+    captureStderr_ = options.Get("stderr").ToBoolean();
+    if (options.Get("onOutput").IsFunction()) {
+      streaming_ = true;
+      onOutput_ = Napi::Persistent(options.Get("onOutput").As<Napi::Function>());
+      Ref();
+      chunks_ = OutputQueue::New(env, "sljs-session", 0, 1, this, [](Napi::Env, void*, Session* session) { session->Unref(); });
+      chunks_.Unref(env);
+    }
+  }
+
+  std::string error;
+  open_ = true;
+  if (!Open(error)) {
+    Shutdown();
+    Napi::Error::New(env, "Could not open session: " + error).ThrowAsJavaScriptException();
+    return;
+  }
+  napi_add_env_cleanup_hook(env, Cleanup, this);
+}
+
+Session::~Session() {
+  if (open_) {
+    Shutdown();
+    napi_remove_env_cleanup_hook(Env(), Cleanup, this);
+  }
+}
+
+void Session::Cleanup(void* arg) {
+  static_cast<Session*>(arg)->Shutdown();
+}
+
+bool Session::Open(std::string& error) {
+  for (int fd = 0; fd < 3; fd++) {
+    if ((saved_[fd] = fcntl(fd, F_DUPFD_CLOEXEC, 3)) == -1) {
+      error = std::string("dup: ") + strerror(errno);
+      return false;
+    }
+  }
+  if (pipe2(wake_, O_CLOEXEC | O_NONBLOCK) == -1) {
+    error = std::string("pipe: ") + strerror(errno);
+    return false;
+  }
+
+  if (pty_) {
+    int master = posix_openpt(O_RDWR | O_NOCTTY | O_CLOEXEC);
+    char name[128];
+    if (master == -1 || grantpt(master) != 0 || unlockpt(master) != 0 || ptsname_r(master, name, sizeof(name)) != 0) {
+      if (master != -1) close(master);
+      error = std::string("pty: ") + strerror(errno);
+      return false;
+    }
+    inputFd_ = outputFd_ = master;
+    setNonBlocking(master, true);
+    // Separate open file descriptions, so stdin alone can be made non-blocking
+    stdinFd_ = open(name, O_RDWR | O_NOCTTY | O_CLOEXEC);
+    stdoutFd_ = open(name, O_RDWR | O_NOCTTY | O_CLOEXEC);
+    termios mode;
+    if (stdinFd_ == -1 || stdoutFd_ == -1 || tcgetattr(stdinFd_, &mode) != 0) {
+      error = std::string("pty: ") + strerror(errno);
+      return false;
+    }
+    // Line input as a terminal would give it, but no echo, signals or
+    // output translation: what the library prints is what JS receives
+    mode.c_lflag &= ~(ECHO | ECHONL | ISIG | IEXTEN);
+    mode.c_iflag &= ~(ICRNL | IXON);
+    mode.c_oflag &= ~OPOST;
+    tcsetattr(stdinFd_, TCSANOW, &mode);
+    eof_ = static_cast<char>(mode.c_cc[VEOF]);
+  } else {
+    int in[2], out[2];
+    if (pipe2(in, O_CLOEXEC) == -1) {
+      error = std::string("pipe: ") + strerror(errno);
+      return false;
+    }
+    stdinFd_ = in[0];
+    inputFd_ = in[1];
+    if (pipe2(out, O_CLOEXEC) == -1) {
+      error = std::string("pipe: ") + strerror(errno);
+      return false;
+    }
+    outputFd_ = out[0];
+    stdoutFd_ = out[1];
+    setNonBlocking(inputFd_, true);
+    setNonBlocking(outputFd_, true);
+  }
+
+  if (captureStderr_) {
+    int err[2];
+    if (pipe2(err, O_CLOEXEC) == -1) {
+      error = std::string("pipe: ") + strerror(errno);
+      return false;
+    }
+    errorFd_ = err[0];
+    stderrFd_ = err[1];
+    setNonBlocking(errorFd_, true);
+  }
+
+  io_ = std::thread(&Session::IoLoop, this);
+  return true;
+}
+
+void Session::Wake() {
+  char byte = 1;
+  ssize_t ignored = write(wake_[1], &byte, 1);
+  (void)ignored;
+}
+
+// Runs one call with fds 0-2 swapped for the session's, then waits until
+// the I/O thread has read everything the call wrote. A synchronous run
+// cannot be fed input while it blocks the JS thread, so its stdin is
+// non-blocking: reading past the queued input fails instead of hanging.
+void Session::Execute(SessionRun& run, bool blockingInput) {
+  uint64_t start = statsEnabled() ? monotonicNs() : 0;
+  uint64_t callNs = 0;
+  // An async run may block on stdin; only this session's JS thread can
+  // unblock it, so that thread fails fast rather than waiting behind it
+  StdioLock stdio(blockingInput ? jsThread_ : std::thread::id());
+  if (!stdio.owns()) {
+    run.error = "stdio is held by a session runAsync() waiting for input; write() to that session first";
+    return;
+  }
+  uint64_t seq;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (stopping_) {
+      run.error = "Session is closed";
+      return;
+    }
+    running_++;
+    seq = ++seq_;
+  }
+
+  if (!blockingInput) {
+    // The pty passes input on to the reading side asynchronously; give
+    // freshly written input a moment to arrive before reads stop waiting
+    bool fresh;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      fresh = inputSince_;
+      inputSince_ = false;
+    }
+    pollfd arrived{ stdinFd_, POLLIN, 0 };
+    if (pty_ && fresh) poll(&arrived, 1, 100);
+    setNonBlocking(stdinFd_, true);
+  }
+  fflush(stdout);
+  fflush(stderr);
+  dup2(stdinFd_, STDIN_FILENO);
+  dup2(stdoutFd_, STDOUT_FILENO);
+  if (captureStderr_) dup2(stderrFd_, STDERR_FILENO);
+
+  uint64_t callStart = start ? monotonicNs() : 0;
+  timedCall(run.lib.handle(), run.symbol, [&]() {
+    if (run.withArgs) {
+      std::vector<const char*> argv;
+      for (const std::string& arg : run.args) argv.push_back(arg.c_str());
+      reinterpret_cast<void (*)(int, const char**)>(run.fn)(static_cast<int>(argv.size()), argv.data());
+    } else {
+      reinterpret_cast<void (*)()>(run.fn)();
+    }
+  });
+  if (start) callNs = monotonicNs() - callStart;
+
+  fflush(stdout);
+  fflush(stderr);
+  dup2(saved_[0], STDIN_FILENO);
+  dup2(saved_[1], STDOUT_FILENO);
+  if (captureStderr_) dup2(saved_[2], STDERR_FILENO);
+  clearerr(stdin); // a failed non-blocking read must not stick to the next run
+  if (!blockingInput) setNonBlocking(stdinFd_, false);
+  if (pty_) {
+    ssize_t ignored = write(stdoutFd_, kFrameMarker, kFrameMarkerLength);
+    (void)ignored;
+  }
+
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    endSeq_ = seq;
+    Wake();
+    changed_.wait(lock, [&] { return doneSeq_ >= seq || exit_; });
+    run.seq = seq;
+    run.out = stdout_.Take();
+    run.err = stderr_.Take();
+    running_--;
+  }
+  changed_.notify_all();
+  if (start) recordPhase(StatsPhase::Capture, monotonicNs() - start - callNs);
+}
+
+void Session::IoLoop() {
+  std::vector<pollfd> fds;
+  for (;;) {
+    bool writable;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (exit_) return;
+      writable = !inputClosed_ && (!input_.empty() || endInput_);
+    }
+
+    fds.clear();
+    fds.push_back({ wake_[0], POLLIN, 0 });
+    fds.push_back({ outputFd_, static_cast<short>(POLLIN | (pty_ && writable ? POLLOUT : 0)), 0 });
+    if (errorFd_ != -1) fds.push_back({ errorFd_, POLLIN, 0 });
+    if (!pty_ && writable) fds.push_back({ inputFd_, POLLOUT, 0 });
+    if (poll(fds.data(), fds.size(), -1) < 0 && errno != EINTR) return;
+
+    char drain[64];
+    while (read(wake_[0], drain, sizeof(drain)) > 0) {}
+
+    // Pipes are written synchronously: a run whose fds were restored
+    // before this read has all of its output in it. The pty needs its marker.
+    uint64_t restored;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      restored = endSeq_;
+    }
+    ReadOutput(outputFd_, true);
+    if (errorFd_ != -1) ReadOutput(errorFd_, false);
+    WriteInput();
+
+    bool finished = false;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      uint64_t complete = pty_ ? std::min(markers_, endSeq_) : restored;
+      if (complete > doneSeq_) {
+        doneSeq_ = complete;
+        finished = true;
+      }
+    }
+    if (finished) changed_.notify_all();
+  }
+}
+
+void Session::ReadOutput(int fd, bool toStdout) {
+  char buffer[16384];
+  ssize_t n;
+  while ((n = read(fd, buffer, sizeof(buffer))) > 0) Emit(buffer, static_cast<size_t>(n), toStdout);
+}
+
+void Session::Emit(const char* data, size_t length, bool toStdout) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  bytesOut_ += length;
+
+  auto deliver = [&](const char* text, size_t size) {
+    if (size == 0) return;
+    if (streaming_) {
+      chunks_.NonBlockingCall(new OutputChunk{ std::string(text, size), toStdout ? "stdout" : "stderr", seq_ });
+    } else {
+      (toStdout ? stdout_ : stderr_).Append(text, size);
+    }
+  };
+  if (!pty_ || !toStdout) {
+    deliver(data, length);
+    return;
+  }
+
+  // Split the pty stream at frame markers, holding back a possible prefix
+  ptyTail_.append(data, length);
+  size_t found;
+  while ((found = ptyTail_.find(kFrameMarker, 0, kFrameMarkerLength)) != std::string::npos) {
+    bytesOut_ -= kFrameMarkerLength;
+    deliver(ptyTail_.data(), found);
+    ptyTail_.erase(0, found + kFrameMarkerLength);
+    markers_++;
+  }
+  size_t keep = 0;
+  for (size_t n = std::min(ptyTail_.size(), kFrameMarkerLength - 1); n > 0; n--) {
+    if (ptyTail_.compare(ptyTail_.size() - n, n, kFrameMarker, n) == 0) {
+      keep = n;
+      break;
+    }
+  }
+  deliver(ptyTail_.data(), ptyTail_.size() - keep);
+  ptyTail_.erase(0, ptyTail_.size() - keep);
+}
+
+void Session::WriteInput() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (inputClosed_) return;
+  size_t written = 0;
+  while (written < input_.size()) {
+    ssize_t n = write(inputFd_, input_.data() + written, input_.size() - written);
+    if (n <= 0) break;
+    written += static_cast<size_t>(n);
+  }
+  input_.erase(0, written);
+  bytesIn_ += written;
+  if (written) inputSince_ = true;
+
+  if (input_.empty() && endInput_) {
+    // A pipe reports EOF once its write end is gone; the pty cannot be
+    // closed without losing it, so it gets the terminal's EOF character
+    if (pty_) {
+      if (write(inputFd_, &eof_, 1) != 1) return;
+    } else {
+      close(inputFd_);
+      inputFd_ = -1;
+    }
+    inputClosed_ = true;
+  }
+}
+
+// Lets pending runs finish (their stdin reaches EOF), then stops the I/O
+// thread and closes everything; safe to call more than once.
+void Session::Shutdown() {
+  if (!open_) return;
+  open_ = false;
+  if (io_.joinable()) {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      stopping_ = true;
+      endInput_ = true;
+    }
+    Wake();
+    std::unique_lock<std::mutex> lock(mutex_);
+    changed_.wait(lock, [&] { return running_ == 0; });
+    exit_ = true;
+    lock.unlock();
+    Wake();
+    io_.join();
+  }
+
+  for (int* fd : { &stdinFd_, &stdoutFd_, &stderrFd_, &outputFd_, &errorFd_, &saved_[0], &saved_[1], &saved_[2], &wake_[0], &wake_[1] }) {
+    if (*fd != -1) close(*fd);
+    *fd = -1;
+  }
+  if (inputFd_ != -1 && !pty_) close(inputFd_);
+  inputFd_ = -1;
+  if (streaming_) chunks_.Release();
+}
+
+void Session::DeliverOutput(Napi::Env env, Napi::Function, Session* session, OutputChunk* chunk) {
+  if (env != nullptr && !session->onOutput_.IsEmpty()) {
+    Napi::HandleScope scope(env);
+    session->onOutput_.Call({ Napi::String::New(env, chunk->text), Napi::String::New(env, chunk->stream),
+                              Napi::Number::New(env, static_cast<double>(chunk->seq)) });
+  }
+  delete chunk;
+}
+
+// (lib, symbol, args?): a void() symbol, or void(int, const char**) with args
+std::shared_ptr<SessionRun> Session::Prepare(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+  if (!open_) {
+    Napi::Error::New(env, "Session is closed").ThrowAsJavaScriptException();
+    return nullptr;
+  }
+  if (!info[1].IsString()) {
+    Napi::TypeError::New(env, "Expected a symbol name").ThrowAsJavaScriptException();
+    return nullptr;
+  }
+  auto run = std::make_shared<SessionRun>();
+  std::string error;
+  run->lib = leaseLibrary(info[0], error);
+  if (!run->lib) {
+    Napi::Error::New(env, error).ThrowAsJavaScriptException();
+    return nullptr;
+  }
+  run->symbol = info[1].As<Napi::String>();
+  run->fn = safeDlsym<void*>(run->lib.handle(), run->symbol, error);
+  if (!run->fn) {
+    recordSymbolError(run->lib.handle(), run->symbol);
+    Napi::Error::New(env, "Symbol not found: " + error).ThrowAsJavaScriptException();
+    return nullptr;
+  }
+  if (info[2].IsArray()) {
+    Napi::Array args = info[2].As<Napi::Array>();
+    run->withArgs = true;
+    for (uint32_t i = 0; i < args.Length(); i++) run->args.push_back(args.Get(i).ToString());
+  }
+  return run;
+}
+
+// -> { seq, stdout, stderr }; with onOutput the text went there instead
+Napi::Value Session::Result(Napi::Env env, SessionRun& run) {
+  if (!run.error.empty()) {
+    Napi::Error::New(env, run.error).ThrowAsJavaScriptException();
+    return env.Null();
+  }
+  Napi::Object result = Napi::Object::New(env);
+  result.Set("seq", Napi::Number::New(env, static_cast<double>(run.seq)));
+  result.Set("stdout", Napi::String::New(env, run.out));
+  if (captureStderr_) result.Set("stderr", Napi::String::New(env, run.err));
+  return result;
+}
+
+// session.run(lib, symbol, args?)
+Napi::Value Session::Run(const Napi::CallbackInfo& info) {
+  std::shared_ptr<SessionRun> run = Prepare(info);
+  if (!run) return info.Env().Null();
+  Execute(*run, false);
+  return Result(info.Env(), *run);
+}
+
+// session.runAsync(lib, symbol, args?) -> Promise; stdin blocks for input
+// written while the call runs
+Napi::Value Session::RunAsync(const Napi::CallbackInfo& info) {
+  std::shared_ptr<SessionRun> run = Prepare(info);
+  if (!run) return info.Env().Null();
+  Ref();
+  return queueAsync(info.Env(),
+    [this, run]() { Execute(*run, true); },
+    [this, run](Napi::Env env) {
+      Unref();
+      return Result(env, *run);
+    });
+}
+
+// session.write(text | bytes) queues input for stdin
+Napi::Value Session::Write(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+  std::string data;
+  uint8_t* bytes = nullptr;
+  size_t length = 0;
+  if (info[0].IsString()) {
+    data = info[0].As<Napi::String>().Utf8Value();
+  } else if (viewBytes(env, info[0], bytes, length)) {
+    data.assign(reinterpret_cast<const char*>(bytes), length);
+  } else {
+    Napi::TypeError::New(env, "Expected a string or a view").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (endInput_) {
+      Napi::Error::New(env, "Session input has ended").ThrowAsJavaScriptException();
+      return env.Null();
+    }
+    input_ += data;
+  }
+  WriteInput(); // usually fits in the pipe straight away
+  Wake();
+  return env.Undefined();
+}
+
+// session.end(): stdin reads EOF once the queued input is consumed
+Napi::Value Session::End(const Napi::CallbackInfo& info) {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    endInput_ = true;
+  }
+  Wake();
+  return info.Env().Undefined();
+}
+
+// stats() -> { runs, bytesIn, bytesOut, queuedInput, pty }
+Napi::Value Session::Stats(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+  std::lock_guard<std::mutex> lock(mutex_);
+  Napi::Object stats = Napi::Object::New(env);
+  stats.Set("runs", Napi::Number::New(env, static_cast<double>(seq_)));
+  stats.Set("bytesIn", Napi::Number::New(env, static_cast<double>(bytesIn_)));
+  stats.Set("bytesOut", Napi::Number::New(env, static_cast<double>(bytesOut_)));
+  stats.Set("queuedInput", Napi::Number::New(env, static_cast<double>(input_.size())));
+  stats.Set("pty", Napi::Boolean::New(env, pty_));
+  return stats;
+}
+
+Napi::Value Session::Close(const Napi::CallbackInfo& info) {
+  if (open_) {
+    Shutdown();
+    napi_remove_env_cleanup_hook(info.Env(), Cleanup, this);
+  }
+  return info.Env().Undefined();
+}
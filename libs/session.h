@@ -0,0 +1,97 @@
+#pragma once
+
+#include <napi.h>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+#include "capture.h"
+#include "library.h"
+
+// One run through a Session, prepared on the JS thread
+struct SessionRun;
+
+// Persistent stdio redirection returned by createSession({ pty, stderr, onOutput }).
+// The pipes (or pty), the saved copies of fds 0-2 and the I/O thread are
+// set up once; each run only swaps the fds in and out with dup2. Input
+// queued with write() is fed to the run's stdin and output is framed per
+// run by sequence number.
+class Session : public Napi::ObjectWrap<Session> {
+ public:
+  static Napi::Function Define(Napi::Env env);
+  static Napi::Value Create(const Napi::CallbackInfo& info);
+
+  Session(const Napi::CallbackInfo& info);
+  ~Session();
+
+ private:
+  struct OutputChunk {
+    std::string text;
+    const char* stream;
+    uint64_t seq;
+  };
+
+  Napi::Value Run(const Napi::CallbackInfo& info);
+  Napi::Value RunAsync(const Napi::CallbackInfo& info);
+  Napi::Value Write(const Napi::CallbackInfo& info);
+  Napi::Value End(const Napi::CallbackInfo& info);
+  Napi::Value Stats(const Napi::CallbackInfo& info);
+  Napi::Value Close(const Napi::CallbackInfo& info);
+
+  bool Open(std::string& error);
+  std::shared_ptr<SessionRun> Prepare(const Napi::CallbackInfo& info);
+  void Execute(SessionRun& run, bool blockingInput);
+  Napi::Value Result(Napi::Env env, SessionRun& run);
+  void IoLoop();
+  void ReadOutput(int fd, bool toStdout);
+  void Emit(const char* data, size_t length, bool toStdout);
+  void WriteInput();
+  void Wake();
+  void Shutdown();
+  static void DeliverOutput(Napi::Env env, Napi::Function, Session* session, OutputChunk* chunk);
+  static void Cleanup(void* arg);
+
+  using OutputQueue = Napi::TypedThreadSafeFunction<Session, OutputChunk, DeliverOutput>;
+
+  bool pty_ = false;
+  bool captureStderr_ = false;
+
+  // Attached to fds 0-2 while a run is in progress
+  int stdinFd_ = -1;
+  int stdoutFd_ = -1;
+  int stderrFd_ = -1;
+  // Owned by the I/O thread: where input goes and output comes from
+  int inputFd_ = -1;
+  int outputFd_ = -1;
+  int errorFd_ = -1;
+  int saved_[3] = { -1, -1, -1 };
+  int wake_[2] = { -1, -1 };
+  std::thread io_;
+  bool open_ = false;
+  // The thread that created the session, the only one that writes its input
+  std::thread::id jsThread_ = std::this_thread::get_id();
+
+  std::mutex mutex_;
+  std::condition_variable changed_;
+  bool stopping_ = false; // no new runs; input is being closed
+  bool exit_ = false;     // the I/O thread should return
+  size_t running_ = 0;
+  std::string input_;
+  bool endInput_ = false;
+  bool inputClosed_ = false;
+  bool inputSince_ = false; // input was written since the last run started
+  uint64_t seq_ = 0;      // last run started
+  uint64_t endSeq_ = 0;   // last run whose fds were restored
+  uint64_t doneSeq_ = 0;  // last run whose output was fully read
+  ChunkedBuffer stdout_;
+  ChunkedBuffer stderr_;
+  std::string ptyTail_;   // bytes that may be the start of a frame marker
+  uint64_t markers_ = 0;  // frame markers seen on the pty
+  char eof_ = 4;          // the pty's VEOF character
+  uint64_t bytesIn_ = 0;
+  uint64_t bytesOut_ = 0;
+
+  bool streaming_ = false;
+  Napi::FunctionReference onOutput_;
+  OutputQueue chunks_;
+};
@@ -0,0 +1,185 @@
+#include "stats.h"
+
+#include <dlfcn.h>
+#include <link.h>
+#include <stdlib.h>
+#include <string.h>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <unordered_map>
+
+static bool enabledFromEnvironment() {
+  const char* value = getenv("SLJS_STATS");
+  return SLJS_STATS && value && *value && strcmp(value, "0") != 0;
+}
+
+std::atomic<bool> statsActive{ enabledFromEnvironment() };
+
+static std::shared_mutex symbolStatsMutex;
+static std::unordered_map<std::string, std::unique_ptr<SymbolStats>> symbolStatsTable;
+static LatencyHistogram phaseStats[3];
+static std::atomic<int64_t> statsSinceMs{
+  std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch()).count()
+};
+
+static int bucketFor(uint64_t ns) {
+  int width = ns ? 64 - __builtin_clzll(ns) : 0;
+  return width < LatencyHistogram::kBuckets ? width : LatencyHistogram::kBuckets - 1;
+}
+
+void LatencyHistogram::Record(uint64_t ns) {
+  count.fetch_add(1, std::memory_order_relaxed);
+  totalNs.fetch_add(ns, std::memory_order_relaxed);
+  buckets[bucketFor(ns)].fetch_add(1, std::memory_order_relaxed);
+  uint64_t seen = maxNs.load(std::memory_order_relaxed);
+  while (ns > seen && !maxNs.compare_exchange_weak(seen, ns, std::memory_order_relaxed)) {}
+}
+
+void LatencyHistogram::Reset() {
+  count = 0;
+  totalNs = 0;
+  maxNs = 0;
+  for (auto& bucket : buckets) bucket = 0;
+}
+
+void recordPhase(StatsPhase phase, uint64_t ns) {
+  phaseStats[static_cast<int>(phase)].Record(ns);
+}
+
+// Path the dynamic linker loaded `handle` from ("" for the main program)
+static const char* libraryName(void* handle) {
+  link_map* map = nullptr;
+  if (!handle || dlinfo(handle, RTLD_DI_LINKMAP, &map) != 0 || !map || !map->l_name) return "";
+  return map->l_name;
+}
+
+SymbolStats* symbolStats(void* handle, const std::string& symbol) {
+  const char* library = libraryName(handle);
+  std::string key;
+  key.reserve(strlen(library) + symbol.size() + 1);
+  key.append(library).push_back('\0');
+  key.append(symbol);
+
+  {
+    std::shared_lock<std::shared_mutex> lock(symbolStatsMutex);
+    auto it = symbolStatsTable.find(key);
+    if (it != symbolStatsTable.end()) return it->second.get();
+  }
+
+  std::unique_lock<std::shared_mutex> lock(symbolStatsMutex);
+  auto& entry = symbolStatsTable[key];
+  if (!entry) {
+    entry.reset(new SymbolStats());
+    entry->library = library;
+    entry->symbol = symbol;
+  }
+  return entry.get();
+}
+
+// Snapshot
+
+// Upper bound of the bucket holding quantile `q`, clamped to the observed max
+static double quantileNs(const uint64_t* buckets, uint64_t count, uint64_t maxNs, double q) {
+  if (count == 0) return 0;
+  uint64_t rank = static_cast<uint64_t>(q * static_cast<double>(count - 1)) + 1;
+  uint64_t seen = 0;
+  for (int i = 0; i < LatencyHistogram::kBuckets; ++i) {
+    seen += buckets[i];
+    if (seen >= rank) {
+      double upper = i == 0 ? 1.0 : static_cast<double>(1ull << i);
+      return upper < static_cast<double>(maxNs) ? upper : static_cast<double>(maxNs);
+    }
+  }
+  return static_cast<double>(maxNs);
+}
+
+static void describeHistogram(Napi::Env env, Napi::Object out, const LatencyHistogram& h, const char* countKey) {
+  uint64_t buckets[LatencyHistogram::kBuckets];
+  uint64_t count = 0;
+  for (int i = 0; i < LatencyHistogram::kBuckets; ++i) {
+    buckets[i] = h.buckets[i].load(std::memory_order_relaxed);
+    count += buckets[i];
+  }
+  uint64_t totalNs = h.totalNs.load(std::memory_order_relaxed);
+  uint64_t maxNs = h.maxNs.load(std::memory_order_relaxed);
+
+  out.Set(countKey, Napi::Number::New(env, static_cast<double>(count)));
+  out.Set("totalNs", Napi::Number::New(env, static_cast<double>(totalNs)));
+  out.Set("meanNs", Napi::Number::New(env, count ? static_cast<double>(totalNs) / static_cast<double>(count) : 0));
+  out.Set("maxNs", Napi::Number::New(env, static_cast<double>(maxNs)));
+  out.Set("p50Ns", Napi::Number::New(env, quantileNs(buckets, count, maxNs, 0.50)));
+  out.Set("p90Ns", Napi::Number::New(env, quantileNs(buckets, count, maxNs, 0.90)));
+  out.Set("p99Ns", Napi::Number::New(env, quantileNs(buckets, count, maxNs, 0.99)));
+
+  // Non-empty buckets only, as { leNs, count } with leNs the exclusive upper bound
+  Napi::Array histogram = Napi::Array::New(env);
+  for (int i = 0; i < LatencyHistogram::kBuckets; ++i) {
+    if (!buckets[i]) continue;
+    Napi::Object bucket = Napi::Object::New(env);
+    bucket.Set("leNs", Napi::Number::New(env, i == 0 ? 1.0 : static_cast<double>(1ull << i)));
+    bucket.Set("count", Napi::Number::New(env, static_cast<double>(buckets[i])));
+    histogram.Set(histogram.Length(), bucket);
+  }
+  out.Set("histogram", histogram);
+}
+
+Napi::Value SetStatsEnabled(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+  bool previous = statsEnabled();
+  if (!SLJS_STATS && info[0].ToBoolean().Value()) {
+    Napi::Error::New(env, "Stats were compiled out (SLJS_STATS=0)").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+  statsActive = info[0].ToBoolean().Value();
+  return Napi::Boolean::New(env, previous);
+}
+
+Napi::Value GetStats(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+  Napi::Object result = Napi::Object::New(env);
+  result.Set("enabled", Napi::Boolean::New(env, statsEnabled()));
+  result.Set("sinceMs", Napi::Number::New(env, static_cast<double>(statsSinceMs.load())));
+
+  Napi::Array symbols = Napi::Array::New(env);
+  {
+    std::shared_lock<std::shared_mutex> lock(symbolStatsMutex);
+    for (const auto& pair : symbolStatsTable) {
+      const SymbolStats& stats = *pair.second;
+      uint64_t errors = stats.errors.load(std::memory_order_relaxed);
+      if (stats.latency.count.load(std::memory_order_relaxed) == 0 && errors == 0) continue;
+
+      Napi::Object entry = Napi::Object::New(env);
+      entry.Set("library", stats.library);
+      entry.Set("symbol", stats.symbol);
+      entry.Set("errors", Napi::Number::New(env, static_cast<double>(errors)));
+      describeHistogram(env, entry, stats.latency, "calls");
+      symbols.Set(symbols.Length(), entry);
+    }
+  }
+  result.Set("symbols", symbols);
+
+  static const char* const phaseNames[] = { "dlopen", "dlsym", "capture" };
+  for (int i = 0; i < 3; ++i) {
+    Napi::Object phase = Napi::Object::New(env);
+    describeHistogram(env, phase, phaseStats[i], "count");
+    result.Set(phaseNames[i], phase);
+  }
+  return result;
+}
+
+// Counters are zeroed in place (not removed) so cached SymbolStats pointers
+// stay valid; calls racing with a reset may land on either side of it.
+Napi::Value ResetStats(const Napi::CallbackInfo& info) {
+  {
+    std::shared_lock<std::shared_mutex> lock(symbolStatsMutex);
+    for (auto& pair : symbolStatsTable) {
+      pair.second->latency.Reset();
+      pair.second->errors = 0;
+    }
+  }
+  for (auto& phase : phaseStats) phase.Reset();
+  statsSinceMs = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+  return info.Env().Undefined();
+}
@@ -0,0 +1,102 @@
+#pragma once
+
+#include <napi.h>
+#include <atomic>
+#include <cstdint>
+#include <exception>
+#include <string>
+#include <time.h>
+
+// Per-symbol call metrics. Off by default; setStatsEnabled(true) or
+// SLJS_STATS=1 in the environment turns them on at runtime. While off,
+// every probe is one relaxed load and a branch, and building with
+// -DSLJS_STATS=0 compiles the probes out entirely.
+#ifndef SLJS_STATS
+#define SLJS_STATS 1
+#endif
+
+extern std::atomic<bool> statsActive;
+
+inline bool statsEnabled() {
+#if SLJS_STATS
+  return statsActive.load(std::memory_order_relaxed);
+#else
+  return false;
+#endif
+}
+
+inline uint64_t monotonicNs() {
+  timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return static_cast<uint64_t>(ts.tv_sec) * 1000000000ull + static_cast<uint64_t>(ts.tv_nsec);
+}
+
+// Lock-free latency histogram with power-of-two buckets: bucket i counts
+// samples below 2^i ns that did not fit bucket i - 1.
+struct LatencyHistogram {
+  static constexpr int kBuckets = 48;
+
+  std::atomic<uint64_t> count{0};
+  std::atomic<uint64_t> totalNs{0};
+  std::atomic<uint64_t> maxNs{0};
+  std::atomic<uint64_t> buckets[kBuckets] = {};
+
+  void Record(uint64_t ns);
+  void Reset();
+};
+
+struct SymbolStats {
+  std::string library;
+  std::string symbol;
+  LatencyHistogram latency;
+  std::atomic<uint64_t> errors{0};
+};
+
+enum class StatsPhase { Dlopen, Dlsym, Capture };
+
+void recordPhase(StatsPhase phase, uint64_t ns);
+
+// Entry for (library behind `handle`, symbol), created on first use. Entries
+// are never freed, so callers may cache the pointer; resetStats() zeroes them.
+SymbolStats* symbolStats(void* handle, const std::string& symbol);
+
+inline void recordSymbolError(void* handle, const std::string& symbol) {
+  if (statsEnabled()) symbolStats(handle, symbol)->errors.fetch_add(1, std::memory_order_relaxed);
+}
+
+// Times the scope it lives in; a scope left by an exception also counts as an error
+class CallTimer {
+ public:
+  explicit CallTimer(SymbolStats* stats)
+      : stats_(stats), exceptions_(std::uncaught_exceptions()), start_(monotonicNs()) {}
+  ~CallTimer() {
+    stats_->latency.Record(monotonicNs() - start_);
+    if (std::uncaught_exceptions() > exceptions_) stats_->errors.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  CallTimer(const CallTimer&) = delete;
+  CallTimer& operator=(const CallTimer&) = delete;
+
+ private:
+  SymbolStats* stats_;
+  int exceptions_;
+  uint64_t start_;
+};
+
+// Runs `call`, timing it against `stats` unless that is null
+template <typename F>
+decltype(auto) timedCall(SymbolStats* stats, F&& call) {
+  if (!stats) return call();
+  CallTimer timer(stats);
+  return call();
+}
+
+template <typename F>
+decltype(auto) timedCall(void* handle, const std::string& symbol, F&& call) {
+  return timedCall(statsEnabled() ? symbolStats(handle, symbol) : nullptr, std::forward<F>(call));
+}
+
+// setStatsEnabled(on), getStats(), resetStats()
+Napi::Value SetStatsEnabled(const Napi::CallbackInfo& info);
+Napi::Value GetStats(const Napi::CallbackInfo& info);
+Napi::Value ResetStats(const Napi::CallbackInfo& info);
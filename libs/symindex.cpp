@@ -0,0 +1,620 @@
+#include "symindex.h"
+#include "core.h"
+#include "elf.h"
+#include "pool.h"
+#include "stats.h"
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <fnmatch.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cstring>
+#include <memory>
+#include <set>
+#include <string_view>
+#include <unordered_map>
+
+// Index file layout. Everything is in host byte order and 8-byte aligned,
+// so the mapped file is read through these structs directly. Strings live
+// in one pool, NUL-terminated and referenced by offset and length; offset
+// 0 is the empty string.
+static constexpr char kIndexMagic[8] = { 'S', 'L', 'J', 'S', 'I', 'D', 'X', '\0' };
+static constexpr uint32_t kIndexVersion = 1;
+static constexpr const char* kIndexName = ".sljs-index";
+
+struct IndexHeader {
+  char magic[8];
+  uint32_t version;
+  uint32_t headerSize;
+  uint32_t fileCount;
+  uint32_t symbolCount;
+  uint32_t slotCount; // hash table size, a power of two
+  uint32_t nameCount; // distinct names, one slot each
+  uint64_t filesAt;
+  uint64_t symbolsAt;
+  uint64_t slotsAt;
+  uint64_t stringsAt;
+  uint64_t stringsSize;
+  uint64_t totalSize;
+};
+
+struct IndexFile {
+  uint64_t dev, ino, size;
+  int64_t mtimeSec, mtimeNsec;
+  uint32_t path, pathLength;   // relative to the indexed directory
+  uint32_t error, errorLength; // set when the file could not be read
+  uint32_t symbolCount;
+  uint32_t reserved;
+};
+
+// Sorted by name, then by file; each slot points at the first symbol of a name
+struct IndexSymbol {
+  uint64_t size;
+  uint32_t name, nameLength;
+  uint32_t version, versionLength;
+  uint32_t file;
+  uint32_t hash;
+  uint8_t type, binding, letter, defaultVersion;
+  uint32_t reserved;
+};
+
+static_assert(sizeof(IndexHeader) == 80 && sizeof(IndexFile) == 64 && sizeof(IndexSymbol) == 40,
+              "the index layout is part of the file format");
+
+struct IndexCandidate {
+  std::string path; // relative to the indexed directory
+  struct stat st;
+  int64_t previous = -1; // unchanged entry in the current index
+  std::shared_ptr<const ElfSymbolTable> table;
+  std::string error;
+};
+
+// Same hash .gnu.hash uses
+static uint32_t hashName(std::string_view name) {
+  uint32_t h = 5381;
+  for (unsigned char c : name) h = h * 33 + c;
+  return h;
+}
+
+static uint64_t align8(uint64_t n) {
+  return (n + 7) & ~uint64_t(7);
+}
+
+// libfoo.so, libfoo.so.1, libfoo.so.1.2.3
+static bool looksShared(const char* name) {
+  for (const char* so = strstr(name, ".so"); so; so = strstr(so + 1, ".so"))
+    if (so[3] == '\0' || so[3] == '.') return true;
+  return false;
+}
+
+static const IndexHeader& indexHeader(const uint8_t* data) {
+  return *reinterpret_cast<const IndexHeader*>(data);
+}
+
+static const IndexFile* indexFiles(const uint8_t* data) {
+  return reinterpret_cast<const IndexFile*>(data + indexHeader(data).filesAt);
+}
+
+static const IndexSymbol* indexSymbols(const uint8_t* data) {
+  return reinterpret_cast<const IndexSymbol*>(data + indexHeader(data).symbolsAt);
+}
+
+static const uint32_t* indexSlots(const uint8_t* data) {
+  return reinterpret_cast<const uint32_t*>(data + indexHeader(data).slotsAt);
+}
+
+static std::string_view indexString(const uint8_t* data, uint32_t at, uint32_t length) {
+  return std::string_view(reinterpret_cast<const char*>(data + indexHeader(data).stringsAt + at), length);
+}
+
+Napi::Function SymbolIndex::Define(Napi::Env env) {
+  Napi::Function ctor = DefineClass(env, "SymbolIndex", {
+    InstanceMethod("findSymbol", &SymbolIndex::FindSymbol),
+    InstanceMethod("search", &SymbolIndex::Search),
+    InstanceMethod("refresh", &SymbolIndex::Refresh),
+    InstanceMethod("stats", &SymbolIndex::Stats),
+    InstanceMethod("close", &SymbolIndex::Close),
+  });
+  addonData(env).symbolIndex = Napi::Persistent(ctor);
+  return ctor;
+}
+
+// indexDirectory(dir, { recursive, index, threads })
+Napi::Value SymbolIndex::Create(const Napi::CallbackInfo& info) {
+  return addonData(info.Env()).symbolIndex.New({ info[0], info[1] });
+}
+
+SymbolIndex::SymbolIndex(const Napi::CallbackInfo& info) : Napi::ObjectWrap<SymbolIndex>(info) {
+  Napi::Env env = info.Env();
+  if (!info[0].IsString()) {
+    Napi::TypeError::New(env, "indexDirectory(dir, options) expects a directory path").ThrowAsJavaScriptException();
+    return;
+  }
+  dir_ = info[0].As<Napi::String>();
+  while (dir_.size() > 1 && dir_.back() == '/') dir_.pop_back();
+  indexPath_ = Join(kIndexName);
+  threads_ = WorkStealingPool::shared().Size();
+
+  if (info[1].IsObject()) {
+    Napi::Object options = info[1].As<Napi::Object>();
+    recursive_ = options.Get("recursive").ToBoolean().Value();
+    Napi::Value index = options.Get("index");
+    if (index.IsString()) indexPath_ = index.As<Napi::String>();
+    else if (index.IsBoolean() && !index.As<Napi::Boolean>().Value()) indexPath_.clear();
+    if (options.Get("threads").IsNumber())
+      threads_ = std::clamp<size_t>(options.Get("threads").As<Napi::Number>().Uint32Value(), 1, threads_);
+  }
+
+  // A missing, foreign or damaged index file is simply rebuilt
+  if (!indexPath_.empty()) MapFile();
+
+  std::string error;
+  if (!Update(error)) {
+    Release();
+    Napi::Error::New(env, error).ThrowAsJavaScriptException();
+    return;
+  }
+  open_ = true;
+}
+
+SymbolIndex::~SymbolIndex() {
+  Release();
+}
+
+std::string SymbolIndex::Join(const std::string& path) const {
+  return dir_.back() == '/' ? dir_ + path : dir_ + "/" + path;
+}
+
+// Lists the shared objects under dir_ sorted by path. Symlinks are followed,
+// but an inode reached through several names is indexed once, under the
+// first name, and no directory is entered twice. Hidden entries, the index
+// file among them, are skipped.
+bool SymbolIndex::Scan(std::vector<IndexCandidate>& out, std::string& error) {
+  struct stat st;
+  if (stat(dir_.c_str(), &st) != 0) {
+    error = "cannot index " + dir_ + ": " + strerror(errno);
+    return false;
+  }
+  if (!S_ISDIR(st.st_mode)) {
+    error = "cannot index " + dir_ + ": not a directory";
+    return false;
+  }
+
+  std::set<std::pair<dev_t, ino_t>> dirs{ { st.st_dev, st.st_ino } };
+  std::vector<std::string> pending{ "" };
+  while (!pending.empty()) {
+    std::string rel = std::move(pending.back());
+    pending.pop_back();
+    DIR* dir = opendir(rel.empty() ? dir_.c_str() : Join(rel).c_str());
+    if (!dir) {
+      if (!rel.empty()) continue;
+      error = "cannot index " + dir_ + ": " + strerror(errno);
+      return false;
+    }
+    while (dirent* entry = readdir(dir)) {
+      if (entry->d_name[0] == '.') continue;
+      std::string child = rel.empty() ? entry->d_name : rel + "/" + entry->d_name;
+      if (stat(Join(child).c_str(), &st) != 0) continue;
+      if (S_ISDIR(st.st_mode)) {
+        if (recursive_ && dirs.insert({ st.st_dev, st.st_ino }).second) pending.push_back(child);
+      } else if (S_ISREG(st.st_mode) && looksShared(entry->d_name)) {
+        IndexCandidate candidate;
+        candidate.path = std::move(child);
+        candidate.st = st;
+        out.push_back(std::move(candidate));
+      }
+    }
+    closedir(dir);
+  }
+
+  std::sort(out.begin(), out.end(), [](const IndexCandidate& a, const IndexCandidate& b) { return a.path < b.path; });
+  std::set<std::pair<dev_t, ino_t>> files;
+  out.erase(std::remove_if(out.begin(), out.end(),
+                           [&](const IndexCandidate& c) { return !files.insert({ c.st.st_dev, c.st.st_ino }).second; }),
+            out.end());
+  return true;
+}
+
+bool SymbolIndex::Update(std::string& error) {
+  uint64_t start = monotonicNs();
+  std::vector<IndexCandidate> files;
+  if (!Scan(files, error)) return false;
+
+  // Files whose path, inode, size and mtime all match keep their entries
+  uint32_t oldCount = data_ ? indexHeader(data_).fileCount : 0;
+  std::unordered_map<std::string_view, uint32_t> previous;
+  for (uint32_t i = 0; i < oldCount; ++i) {
+    const IndexFile& file = indexFiles(data_)[i];
+    previous.emplace(indexString(data_, file.path, file.pathLength), i);
+  }
+
+  std::vector<size_t> changed;
+  uint32_t kept = 0;
+  for (size_t i = 0; i < files.size(); ++i) {
+    IndexCandidate& c = files[i];
+    auto it = previous.find(c.path);
+    if (it != previous.end()) {
+      kept++;
+      const IndexFile& file = indexFiles(data_)[it->second];
+      if (file.dev == uint64_t(c.st.st_dev) && file.ino == uint64_t(c.st.st_ino) && file.size == uint64_t(c.st.st_size) &&
+          file.mtimeSec == c.st.st_mtim.tv_sec && file.mtimeNsec == c.st.st_mtim.tv_nsec) {
+        c.previous = it->second;
+        continue;
+      }
+    }
+    changed.push_back(i);
+  }
+  parsed_ = static_cast<uint32_t>(changed.size());
+  reused_ = static_cast<uint32_t>(files.size() - changed.size());
+  removed_ = oldCount - kept;
+  written_ = false;
+  writeError_.clear();
+
+  if (data_ && changed.empty() && removed_ == 0) {
+    updateMs_ = (monotonicNs() - start) / 1e6;
+    return true;
+  }
+
+  if (!changed.empty()) {
+    WorkStealingPool::shared().ParallelFor(changed.size(), threads_, [&](size_t i) {
+      IndexCandidate& c = files[changed[i]];
+      c.table = parseDynamicSymbols(Join(c.path), c.error);
+    });
+  }
+
+  // Gather every symbol, viewing names either in the current image or in
+  // the freshly parsed tables; both outlive the build below.
+  struct PendingSymbol {
+    std::string_view name, version;
+    uint64_t size;
+    uint32_t file;
+    uint8_t type, binding, letter, defaultVersion;
+  };
+  std::vector<PendingSymbol> pending;
+  std::vector<int64_t> remap(oldCount, -1);
+  for (size_t i = 0; i < files.size(); ++i)
+    if (files[i].previous >= 0) remap[files[i].previous] = static_cast<int64_t>(i);
+
+  const IndexSymbol* oldSymbols = data_ ? indexSymbols(data_) : nullptr;
+  for (uint32_t i = 0, n = data_ ? indexHeader(data_).symbolCount : 0; i < n; ++i) {
+    const IndexSymbol& sym = oldSymbols[i];
+    if (remap[sym.file] < 0) continue;
+    pending.push_back({ indexString(data_, sym.name, sym.nameLength), indexString(data_, sym.version, sym.versionLength),
+                        sym.size, static_cast<uint32_t>(remap[sym.file]), sym.type, sym.binding, sym.letter,
+                        sym.defaultVersion });
+  }
+  for (size_t index : changed) {
+    if (!files[index].table) continue;
+    for (const ElfSymbol& sym : files[index].table->symbols)
+      pending.push_back({ sym.name, sym.version, sym.size, static_cast<uint32_t>(index), sym.type, sym.binding,
+                          static_cast<uint8_t>(sym.letter), sym.defaultVersion });
+  }
+  std::sort(pending.begin(), pending.end(), [](const PendingSymbol& a, const PendingSymbol& b) {
+    if (a.name != b.name) return a.name < b.name;
+    if (a.file != b.file) return a.file < b.file;
+    return a.version < b.version;
+  });
+
+  std::string strings(1, '\0');
+  std::unordered_map<std::string_view, uint32_t> interned;
+  auto intern = [&](std::string_view s) -> uint32_t {
+    if (s.empty()) return 0;
+    auto it = interned.find(s);
+    if (it != interned.end()) return it->second;
+    uint32_t at = static_cast<uint32_t>(strings.size());
+    strings.append(s);
+    strings.push_back('\0');
+    interned.emplace(s, at);
+    return at;
+  };
+
+  std::vector<IndexFile> fileEntries(files.size());
+  for (size_t i = 0; i < files.size(); ++i) {
+    const IndexCandidate& c = files[i];
+    IndexFile& entry = fileEntries[i];
+    entry.dev = c.st.st_dev;
+    entry.ino = c.st.st_ino;
+    entry.size = c.st.st_size;
+    entry.mtimeSec = c.st.st_mtim.tv_sec;
+    entry.mtimeNsec = c.st.st_mtim.tv_nsec;
+    entry.path = intern(c.path);
+    entry.pathLength = static_cast<uint32_t>(c.path.size());
+    std::string_view failure = c.error;
+    if (c.previous >= 0) {
+      const IndexFile& old = indexFiles(data_)[c.previous];
+      failure = indexString(data_, old.error, old.errorLength);
+    }
+    entry.error = intern(failure);
+    entry.errorLength = static_cast<uint32_t>(failure.size());
+  }
+
+  std::vector<IndexSymbol> symbolEntries(pending.size());
+  uint32_t names = 0;
+  for (size_t i = 0; i < pending.size(); ++i) {
+    const PendingSymbol& p = pending[i];
+    IndexSymbol& entry = symbolEntries[i];
+    entry.size = p.size;
+    entry.name = intern(p.name);
+    entry.nameLength = static_cast<uint32_t>(p.name.size());
+    entry.version = intern(p.version);
+    entry.versionLength = static_cast<uint32_t>(p.version.size());
+    entry.file = p.file;
+    entry.hash = hashName(p.name);
+    entry.type = p.type;
+    entry.binding = p.binding;
+    entry.letter = p.letter;
+    entry.defaultVersion = p.defaultVersion;
+    fileEntries[p.file].symbolCount++;
+    if (i == 0 || pending[i - 1].name != p.name) names++;
+  }
+
+  // Open addressing at a load factor of at most one half
+  uint32_t slotCount = 16;
+  while (slotCount < names * 2) slotCount <<= 1;
+  std::vector<uint32_t> slots(slotCount, 0);
+  for (size_t i = 0; i < pending.size(); ++i) {
+    if (i > 0 && pending[i - 1].name == pending[i].name) continue;
+    uint32_t slot = symbolEntries[i].hash & (slotCount - 1);
+    while (slots[slot]) slot = (slot + 1) & (slotCount - 1);
+    slots[slot] = static_cast<uint32_t>(i + 1);
+  }
+
+  IndexHeader header = {};
+  memcpy(header.magic, kIndexMagic, sizeof(header.magic));
+  header.version = kIndexVersion;
+  header.headerSize = sizeof(IndexHeader);
+  header.fileCount = static_cast<uint32_t>(fileEntries.size());
+  header.symbolCount = static_cast<uint32_t>(symbolEntries.size());
+  header.slotCount = slotCount;
+  header.nameCount = names;
+  header.filesAt = sizeof(IndexHeader);
+  header.symbolsAt = header.filesAt + fileEntries.size() * sizeof(IndexFile);
+  header.slotsAt = header.symbolsAt + symbolEntries.size() * sizeof(IndexSymbol);
+  header.stringsAt = align8(header.slotsAt + slots.size() * sizeof(uint32_t));
+  header.stringsSize = strings.size();
+  header.totalSize = align8(header.stringsAt + strings.size());
+
+  std::vector<uint8_t> image(header.totalSize, 0);
+  memcpy(image.data(), &header, sizeof(header));
+  memcpy(image.data() + header.filesAt, fileEntries.data(), fileEntries.size() * sizeof(IndexFile));
+  memcpy(image.data() + header.symbolsAt, symbolEntries.data(), symbolEntries.size() * sizeof(IndexSymbol));
+  memcpy(image.data() + header.slotsAt, slots.data(), slots.size() * sizeof(uint32_t));
+  memcpy(image.data() + header.stringsAt, strings.data(), strings.size());
+
+  // Written beside the target and renamed over it, so readers in other
+  // processes see either the old index or the new one
+  if (!indexPath_.empty()) {
+    std::string temp = indexPath_ + ".tmp." + std::to_string(getpid());
+    int fd = open(temp.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    size_t done = 0;
+    while (fd != -1 && done < image.size()) {
+      ssize_t n = write(fd, image.data() + done, image.size() - done);
+      if (n < 0 && errno == EINTR) continue;
+      if (n <= 0) break;
+      done += static_cast<size_t>(n);
+    }
+    if (fd == -1 || done < image.size()) writeError_ = strerror(errno);
+    if (fd != -1 && close(fd) != 0 && writeError_.empty()) writeError_ = strerror(errno);
+    if (writeError_.empty() && rename(temp.c_str(), indexPath_.c_str()) != 0) writeError_ = strerror(errno);
+    if (writeError_.empty()) written_ = true;
+    else if (fd != -1) unlink(temp.c_str());
+  }
+
+  Release();
+  if (!written_ || !MapFile()) {
+    image_ = std::move(image);
+    Attach(image_.data(), image_.size());
+  }
+  updateMs_ = (monotonicNs() - start) / 1e6;
+  return true;
+}
+
+// Checks that every offset and reference stays inside the image before it
+// is used, so a truncated or foreign file is rejected instead of read
+bool SymbolIndex::Attach(const uint8_t* data, size_t size) {
+  if (size < sizeof(IndexHeader)) return false;
+  const IndexHeader& h = indexHeader(data);
+  if (memcmp(h.magic, kIndexMagic, sizeof(h.magic)) != 0 || h.version != kIndexVersion ||
+      h.headerSize != sizeof(IndexHeader) || h.totalSize != size)
+    return false;
+
+  auto within = [&](uint64_t at, uint64_t count, uint64_t width) {
+    return at % 8 == 0 && at <= size && count <= (size - at) / width;
+  };
+  if (!within(h.filesAt, h.fileCount, sizeof(IndexFile)) || !within(h.symbolsAt, h.symbolCount, sizeof(IndexSymbol)) ||
+      !within(h.slotsAt, h.slotCount, sizeof(uint32_t)) || !within(h.stringsAt, h.stringsSize, 1) ||
+      !h.slotCount || (h.slotCount & (h.slotCount - 1)) || !h.stringsSize)
+    return false;
+
+  const char* strings = reinterpret_cast<const char*>(data + h.stringsAt);
+  auto string = [&](uint32_t at, uint32_t length) {
+    return uint64_t(at) + length < h.stringsSize && strings[uint64_t(at) + length] == '\0';
+  };
+  const auto* files = reinterpret_cast<const IndexFile*>(data + h.filesAt);
+  for (uint32_t i = 0; i < h.fileCount; ++i)
+    if (!string(files[i].path, files[i].pathLength) || !string(files[i].error, files[i].errorLength)) return false;
+  const auto* symbols = reinterpret_cast<const IndexSymbol*>(data + h.symbolsAt);
+  for (uint32_t i = 0; i < h.symbolCount; ++i)
+    if (!symbols[i].nameLength || !string(symbols[i].name, symbols[i].nameLength) ||
+        !string(symbols[i].version, symbols[i].versionLength) || symbols[i].file >= h.fileCount)
+      return false;
+  // Lookups stop at an empty slot, so one has to exist
+  const auto* slots = reinterpret_cast<const uint32_t*>(data + h.slotsAt);
+  uint32_t used = 0;
+  for (uint32_t i = 0; i < h.slotCount; ++i) {
+    if (slots[i] > h.symbolCount) return false;
+    used += slots[i] != 0;
+  }
+  if (used == h.slotCount) return false;
+
+  data_ = data;
+  size_ = size;
+  return true;
+}
+
+bool SymbolIndex::MapFile() {
+  int fd = open(indexPath_.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd == -1) return false;
+  struct stat st;
+  if (fstat(fd, &st) != 0 || st.st_size < static_cast<off_t>(sizeof(IndexHeader))) {
+    close(fd);
+    return false;
+  }
+  void* mapped = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_SHARED, fd, 0);
+  close(fd);
+  if (mapped == MAP_FAILED) return false;
+  if (!Attach(static_cast<const uint8_t*>(mapped), static_cast<size_t>(st.st_size))) {
+    munmap(mapped, static_cast<size_t>(st.st_size));
+    return false;
+  }
+  map_ = mapped;
+  return true;
+}
+
+void SymbolIndex::Release() {
+  if (map_) munmap(map_, size_);
+  map_ = nullptr;
+  image_.clear();
+  image_.shrink_to_fit();
+  data_ = nullptr;
+  size_ = 0;
+}
+
+bool SymbolIndex::Usable(Napi::Env env) {
+  if (open_) return true;
+  Napi::Error::New(env, "symbol index is closed").ThrowAsJavaScriptException();
+  return false;
+}
+
+Napi::Object SymbolIndex::Entry(Napi::Env env, uint32_t index) {
+  const IndexSymbol& sym = indexSymbols(data_)[index];
+  const IndexFile& file = indexFiles(data_)[sym.file];
+  std::string_view name = indexString(data_, sym.name, sym.nameLength);
+  Napi::Object entry = Napi::Object::New(env);
+  entry.Set("name", Napi::String::New(env, name.data(), name.size()));
+  entry.Set("library", Join(std::string(indexString(data_, file.path, file.pathLength))));
+  entry.Set("type", std::string(1, static_cast<char>(sym.letter)));
+  entry.Set("symbolType", elfSymbolTypeName(sym.type));
+  entry.Set("binding", elfBindingName(sym.binding));
+  entry.Set("size", Napi::Number::New(env, static_cast<double>(sym.size)));
+  if (sym.versionLength) {
+    std::string_view version = indexString(data_, sym.version, sym.versionLength);
+    entry.Set("version", Napi::String::New(env, version.data(), version.size()));
+    entry.Set("defaultVersion", Napi::Boolean::New(env, sym.defaultVersion != 0));
+  }
+  return entry;
+}
+
+// Every library that exports `name`, in path order
+Napi::Value SymbolIndex::FindSymbol(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+  if (!Usable(env)) return env.Null();
+  if (!info[0].IsString()) {
+    Napi::TypeError::New(env, "findSymbol(name) expects a string").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+  std::string name = info[0].As<Napi::String>();
+  const IndexHeader& h = indexHeader(data_);
+  const IndexSymbol* symbols = indexSymbols(data_);
+  const uint32_t* slots = indexSlots(data_);
+
+  Napi::Array result = Napi::Array::New(env);
+  uint32_t hash = hashName(name);
+  for (uint32_t slot = hash & (h.slotCount - 1);; slot = (slot + 1) & (h.slotCount - 1)) {
+    uint32_t at = slots[slot];
+    if (!at) break;
+    const IndexSymbol& sym = symbols[at - 1];
+    if (sym.hash != hash || indexString(data_, sym.name, sym.nameLength) != name) continue;
+    uint32_t count = 0;
+    for (uint32_t i = at - 1; i < h.symbolCount && indexString(data_, symbols[i].name, symbols[i].nameLength) == name; ++i)
+      result.Set(count++, Entry(env, i));
+    break;
+  }
+  return result;
+}
+
+// search(pattern, { limit }): a pattern without wildcards matches as a
+// prefix, otherwise as a shell glob. The literal part before the first
+// wildcard narrows the scan to a range of the sorted symbol array.
+Napi::Value SymbolIndex::Search(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+  if (!Usable(env)) return env.Null();
+  if (!info[0].IsString()) {
+    Napi::TypeError::New(env, "search(pattern, options) expects a string pattern").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+  std::string pattern = info[0].As<Napi::String>();
+  uint32_t limit = UINT32_MAX;
+  if (info[1].IsObject() && info[1].As<Napi::Object>().Get("limit").IsNumber())
+    limit = info[1].As<Napi::Object>().Get("limit").As<Napi::Number>().Uint32Value();
+
+  size_t wildcard = pattern.find_first_of("*?[\\");
+  std::string_view prefix(pattern.data(), wildcard == std::string::npos ? pattern.size() : wildcard);
+  const IndexSymbol* first = indexSymbols(data_);
+  const IndexSymbol* last = first + indexHeader(data_).symbolCount;
+  const IndexSymbol* it = std::lower_bound(first, last, prefix, [&](const IndexSymbol& sym, std::string_view key) {
+    return indexString(data_, sym.name, sym.nameLength) < key;
+  });
+
+  Napi::Array result = Napi::Array::New(env);
+  uint32_t count = 0;
+  for (; it != last && count < limit; ++it) {
+    std::string_view name = indexString(data_, it->name, it->nameLength);
+    if (name.compare(0, prefix.size(), prefix) != 0) break;
+    if (wildcard != std::string::npos && fnmatch(pattern.c_str(), name.data(), 0) != 0) continue;
+    result.Set(count++, Entry(env, static_cast<uint32_t>(it - first)));
+  }
+  return result;
+}
+
+// Re-scans the directory and rebuilds the index if anything changed
+Napi::Value SymbolIndex::Refresh(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+  if (!Usable(env)) return env.Null();
+  std::string error;
+  if (!Update(error)) {
+    Napi::Error::New(env, error).ThrowAsJavaScriptException();
+    return env.Null();
+  }
+  return Stats(info);
+}
+
+Napi::Value SymbolIndex::Stats(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+  if (!Usable(env)) return env.Null();
+  const IndexHeader& h = indexHeader(data_);
+  Napi::Object stats = Napi::Object::New(env);
+  stats.Set("files", Napi::Number::New(env, h.fileCount));
+  stats.Set("symbols", Napi::Number::New(env, h.symbolCount));
+  stats.Set("names", Napi::Number::New(env, h.nameCount));
+  stats.Set("bytes", Napi::Number::New(env, static_cast<double>(size_)));
+  stats.Set("index", indexPath_.empty() ? env.Null() : Napi::String::New(env, indexPath_));
+  stats.Set("mapped", Napi::Boolean::New(env, map_ != nullptr));
+  stats.Set("parsed", Napi::Number::New(env, parsed_));
+  stats.Set("reused", Napi::Number::New(env, reused_));
+  stats.Set("removed", Napi::Number::New(env, removed_));
+  stats.Set("written", Napi::Boolean::New(env, written_));
+  if (!writeError_.empty()) stats.Set("writeError", writeError_);
+  stats.Set("updateMs", Napi::Number::New(env, updateMs_));
+
+  Napi::Array unreadable = Napi::Array::New(env);
+  const IndexFile* files = indexFiles(data_);
+  for (uint32_t i = 0, n = 0; i < h.fileCount; ++i) {
+    if (!files[i].errorLength) continue;
+    Napi::Object entry = Napi::Object::New(env);
+    entry.Set("library", Join(std::string(indexString(data_, files[i].path, files[i].pathLength))));
+    entry.Set("error", std::string(indexString(data_, files[i].error, files[i].errorLength)));
+    unreadable.Set(n++, entry);
+  }
+  stats.Set("unreadable", unreadable);
+  return stats;
+}
+
+Napi::Value SymbolIndex::Close(const Napi::CallbackInfo& info) {
+  Release();
+  open_ = false;
+  return info.Env().Undefined();
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <napi.h>
+#include <string>
+#include <vector>
+
+// One file found while scanning the indexed directory
+struct IndexCandidate;
+
+// Symbol index returned by indexDirectory(dir, { recursive, index, threads }).
+// Maps every defined dynamic symbol of the shared objects under a directory
+// to the library that exports it. The index is a single flat file that is
+// mapped read-only and queried in place: a hash table over the symbol
+// names for exact lookups and the name-sorted symbol array for prefix and
+// glob searches. Updates re-read only the files whose inode, size or mtime
+// changed; the others are copied over from the previous index.
+class SymbolIndex : public Napi::ObjectWrap<SymbolIndex> {
+ public:
+  static Napi::Function Define(Napi::Env env);
+  static Napi::Value Create(const Napi::CallbackInfo& info);
+
+  SymbolIndex(const Napi::CallbackInfo& info);
+  ~SymbolIndex();
+
+ private:
+  Napi::Value FindSymbol(const Napi::CallbackInfo& info);
+  Napi::Value Search(const Napi::CallbackInfo& info);
+  Napi::Value Refresh(const Napi::CallbackInfo& info);
+  Napi::Value Stats(const Napi::CallbackInfo& info);
+  Napi::Value Close(const Napi::CallbackInfo& info);
+
+  bool Update(std::string& error);
+  bool Scan(std::vector<IndexCandidate>& out, std::string& error);
+  bool Attach(const uint8_t* data, size_t size);
+  bool MapFile();
+  void Release();
+  Napi::Object Entry(Napi::Env env, uint32_t symbol);
+  bool Usable(Napi::Env env);
+  std::string Join(const std::string& path) const;
+
+  std::string dir_;
+  std::string indexPath_; // empty when the index is kept in memory only
+  bool recursive_ = false;
+  size_t threads_ = 0;
+
+  // The current index image, either mapped from indexPath_ or held in image_
+  const uint8_t* data_ = nullptr;
+  size_t size_ = 0;
+  void* map_ = nullptr;
+  std::vector<uint8_t> image_;
+  bool open_ = false;
+
+  // What the last update did
+  uint32_t parsed_ = 0;
+  uint32_t reused_ = 0;
+  uint32_t removed_ = 0;
+  bool written_ = false;
+  std::string writeError_;
+  double updateMs_ = 0;
+};
@@ -0,0 +1,432 @@
+#include "typed.h"
+#include "bind.h"
+#include "stats.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <memory>
+#include <utility>
+
+#if defined(__aarch64__)
+static constexpr unsigned kIntRegs = 8;
+#else
+static constexpr unsigned kIntRegs = 6;
+#endif
+static constexpr unsigned kFloatRegs = 8;
+static constexpr unsigned kMaxParams = kIntRegs + kFloatRegs;
+
+// Signature parsing
+
+struct TypeName {
+  const char* name;
+  TypedKind kind;
+  int arrayType;
+};
+
+// Names with whitespace removed ("unsigned int" -> "unsignedint")
+static const TypeName typeNames[] = {
+  { "void", TypedKind::Void, -1 },
+  { "bool", TypedKind::Bool, -1 },
+  { "int", TypedKind::Int32, -1 },
+  { "int32_t", TypedKind::Int32, -1 },
+  { "unsigned", TypedKind::Uint32, -1 },
+  { "unsignedint", TypedKind::Uint32, -1 },
+  { "uint32_t", TypedKind::Uint32, -1 },
+  { "long", TypedKind::Int64, -1 },
+  { "longlong", TypedKind::Int64, -1 },
+  { "int64_t", TypedKind::Int64, -1 },
+  { "uint64_t", TypedKind::Uint64, -1 },
+  { "size_t", TypedKind::Uint64, -1 },
+  { "float", TypedKind::Float, -1 },
+  { "double", TypedKind::Double, -1 },
+  { "constchar*", TypedKind::String, -1 },
+  { "void*", TypedKind::Pointer, -1 },
+  { "char*", TypedKind::Pointer, -1 },
+  { "uint8_t*", TypedKind::Pointer, -1 },
+  { "unsignedchar*", TypedKind::Pointer, -1 },
+  { "int8_t*", TypedKind::Pointer, napi_int8_array },
+  { "int16_t*", TypedKind::Pointer, napi_int16_array },
+  { "uint16_t*", TypedKind::Pointer, napi_uint16_array },
+  { "int*", TypedKind::Pointer, napi_int32_array },
+  { "int32_t*", TypedKind::Pointer, napi_int32_array },
+  { "uint32_t*", TypedKind::Pointer, napi_uint32_array },
+  { "float*", TypedKind::Pointer, napi_float32_array },
+  { "double*", TypedKind::Pointer, napi_float64_array },
+  { "int64_t*", TypedKind::Pointer, napi_bigint64_array },
+  { "uint64_t*", TypedKind::Pointer, napi_biguint64_array },
+};
+
+static const TypeName* lookupType(std::string name) {
+  // const only matters for strings; "const float*" is still a float view
+  if (name.compare(0, 5, "const") == 0 && name != "constchar*") name.erase(0, 5);
+  for (const TypeName& type : typeNames)
+    if (name == type.name) return &type;
+  return nullptr;
+}
+
+bool parseTypedSignature(const std::string& text, TypedSignature& out, std::string& error) {
+  std::string compact;
+  for (char c : text)
+    if (!std::isspace(static_cast<unsigned char>(c))) compact += c;
+
+  size_t open = compact.find('(');
+  if (open == std::string::npos || compact.back() != ')') {
+    error = "Malformed signature: " + text;
+    return false;
+  }
+
+  const TypeName* ret = lookupType(compact.substr(0, open));
+  if (!ret || ret->kind == TypedKind::Pointer) {
+    error = "Unsupported return type in " + text;
+    return false;
+  }
+  out.text = text;
+  out.ret = ret->kind;
+  out.params.clear();
+  out.intCount = out.floatCount = 0;
+
+  std::string list = compact.substr(open + 1, compact.size() - open - 2);
+  if (list.empty() || list == "void") return true;
+
+  size_t start = 0;
+  while (start <= list.size()) {
+    size_t comma = list.find(',', start);
+    if (comma == std::string::npos) comma = list.size();
+    const TypeName* type = lookupType(list.substr(start, comma - start));
+    if (!type || type->kind == TypedKind::Void) {
+      error = "Unsupported parameter type '" + list.substr(start, comma - start) + "' in " + text;
+      return false;
+    }
+    out.params.push_back({ type->kind, type->arrayType });
+    if (type->kind == TypedKind::Float || type->kind == TypedKind::Double) out.floatCount++;
+    else out.intCount++;
+    start = comma + 1;
+  }
+
+  if (out.intCount > kIntRegs || out.floatCount > kFloatRegs) {
+    error = "Too many arguments for a typed call (at most " + std::to_string(kIntRegs) +
+            " integer/pointer and " + std::to_string(kFloatRegs) + " floating-point): " + text;
+    return false;
+  }
+  return true;
+}
+
+// Argument arena. Register images are fixed arrays and string copies go
+// into one buffer that only ever grows, so once warmed up a call performs
+// no heap allocation. thread_local keeps worker_threads apart.
+
+struct TypedArena {
+  uint64_t ints[kIntRegs];
+  double floats[kFloatRegs];
+  std::vector<char> text;
+  size_t stringOffsets[kIntRegs]; // offset + 1 into `text`, 0 for a null string
+};
+
+static thread_local TypedArena arena;
+
+static bool fillArgument(napi_env env, const TypedParam& param, napi_value value, unsigned& ii, unsigned& fi, size_t& textUsed) {
+  napi_valuetype type;
+  napi_typeof(env, value, &type);
+
+  switch (param.kind) {
+    case TypedKind::Bool: {
+      bool v;
+      if (napi_get_value_bool(env, value, &v) != napi_ok) return false;
+      arena.ints[ii++] = v;
+      return true;
+    }
+    case TypedKind::Int32: {
+      int32_t v;
+      if (napi_get_value_int32(env, value, &v) != napi_ok) return false;
+      arena.ints[ii++] = static_cast<uint64_t>(static_cast<int64_t>(v));
+      return true;
+    }
+    case TypedKind::Uint32: {
+      uint32_t v;
+      if (napi_get_value_uint32(env, value, &v) != napi_ok) return false;
+      arena.ints[ii++] = v;
+      return true;
+    }
+    case TypedKind::Int64:
+    case TypedKind::Uint64: {
+      int64_t v;
+      bool lossless;
+      if (type == napi_bigint) {
+        napi_status s = param.kind == TypedKind::Int64
+          ? napi_get_value_bigint_int64(env, value, &v, &lossless)
+          : napi_get_value_bigint_uint64(env, value, reinterpret_cast<uint64_t*>(&v), &lossless);
+        if (s != napi_ok) return false;
+      } else if (napi_get_value_int64(env, value, &v) != napi_ok) {
+        return false;
+      }
+      arena.ints[ii++] = static_cast<uint64_t>(v);
+      return true;
+    }
+    case TypedKind::Float: {
+      double v;
+      if (napi_get_value_double(env, value, &v) != napi_ok) return false;
+      // A float travels in the low 32 bits of its floating-point register
+      float f = static_cast<float>(v);
+      double slot = 0;
+      memcpy(&slot, &f, sizeof(f));
+      arena.floats[fi++] = slot;
+      return true;
+    }
+    case TypedKind::Double: {
+      if (napi_get_value_double(env, value, &arena.floats[fi]) != napi_ok) return false;
+      fi++;
+      return true;
+    }
+    case TypedKind::String: {
+      if (type == napi_null || type == napi_undefined) {
+        arena.ints[ii++] = 0;
+        return true;
+      }
+      size_t length;
+      if (napi_get_value_string_utf8(env, value, nullptr, 0, &length) != napi_ok) return false;
+      if (arena.text.size() < textUsed + length + 1) arena.text.resize((textUsed + length + 1) * 2);
+      napi_get_value_string_utf8(env, value, arena.text.data() + textUsed, length + 1, &length);
+      arena.stringOffsets[ii++] = textUsed + 1;
+      textUsed += length + 1;
+      return true;
+    }
+    case TypedKind::Pointer: {
+      if (type == napi_null || type == napi_undefined) {
+        arena.ints[ii++] = 0;
+        return true;
+      }
+      if (param.arrayType != -1) {
+        bool isTyped = false;
+        napi_typedarray_type arrayType;
+        if (napi_is_typedarray(env, value, &isTyped) != napi_ok || !isTyped) return false;
+        napi_get_typedarray_info(env, value, &arrayType, nullptr, nullptr, nullptr, nullptr);
+        if (arrayType != param.arrayType) return false;
+      }
+      uint8_t* data;
+      size_t length;
+      if (!viewBytes(env, value, data, length)) return false;
+      arena.ints[ii++] = reinterpret_cast<uint64_t>(data);
+      return true;
+    }
+    case TypedKind::Void:
+      break;
+  }
+  return false;
+}
+
+#if SLJS_TYPED_CALLS
+template <typename T, size_t> using Slot = T;
+
+// Every integer-class argument is assigned the next general-purpose
+// register and every float/double the next vector register, regardless of
+// how the two kinds interleave, so one function type covers all mixes.
+template <typename R, size_t... I, size_t... F>
+static R callRegisters(void* fn, std::index_sequence<I...>, std::index_sequence<F...>) {
+  using Fn = R(*)(Slot<uint64_t, I>..., Slot<double, F>...);
+  return reinterpret_cast<Fn>(fn)(arena.ints[I]..., arena.floats[F]...);
+}
+
+template <typename R>
+static R callRegisters(void* fn) {
+  return callRegisters<R>(fn, std::make_index_sequence<kIntRegs>{}, std::make_index_sequence<kFloatRegs>{});
+}
+#endif
+
+static napi_value typedError(napi_env env, const char* name, const TypedSignature& sig, size_t index) {
+  std::string message = "Invalid argument " + std::to_string(index) + " for " + std::string(name) + ": expected " + sig.text;
+  napi_throw_type_error(env, nullptr, message.c_str());
+  return nullptr;
+}
+
+static napi_value callTyped(napi_env env, void* fn, const char* name, const TypedSignature& sig, const napi_value* argv, size_t argc, SymbolStats* stats) {
+#if SLJS_TYPED_CALLS
+  if (argc < sig.params.size()) return typedError(env, name, sig, argc);
+
+  unsigned ii = 0, fi = 0;
+  size_t textUsed = 0;
+  for (size_t i = 0; i < sig.params.size(); ++i) {
+    if (sig.params[i].kind == TypedKind::String) arena.stringOffsets[ii] = 0;
+    if (!fillArgument(env, sig.params[i], argv[i], ii, fi, textUsed)) return typedError(env, name, sig, i);
+  }
+  // Strings are placed once the text buffer has stopped growing
+  for (unsigned i = 0, slot = 0; i < sig.params.size(); ++i) {
+    TypedKind kind = sig.params[i].kind;
+    if (kind == TypedKind::Float || kind == TypedKind::Double) continue;
+    if (kind == TypedKind::String && arena.stringOffsets[slot])
+      arena.ints[slot] = reinterpret_cast<uint64_t>(arena.text.data() + arena.stringOffsets[slot] - 1);
+    slot++;
+  }
+
+  napi_value result;
+  switch (sig.ret) {
+    case TypedKind::Float: {
+      double raw = timedCall(stats, [&]() { return callRegisters<double>(fn); });
+      float f;
+      memcpy(&f, &raw, sizeof(f));
+      napi_create_double(env, f, &result);
+      return result;
+    }
+    case TypedKind::Double:
+      napi_create_double(env, timedCall(stats, [&]() { return callRegisters<double>(fn); }), &result);
+      return result;
+    default:
+      break;
+  }
+
+  uint64_t raw = timedCall(stats, [&]() { return callRegisters<uint64_t>(fn); });
+  switch (sig.ret) {
+    case TypedKind::Void: napi_get_undefined(env, &result); break;
+    case TypedKind::Bool: napi_get_boolean(env, static_cast<uint8_t>(raw) != 0, &result); break;
+    case TypedKind::Int32: napi_create_int32(env, static_cast<int32_t>(static_cast<uint32_t>(raw)), &result); break;
+    case TypedKind::Uint32: napi_create_uint32(env, static_cast<uint32_t>(raw), &result); break;
+    case TypedKind::Int64: napi_create_bigint_int64(env, static_cast<int64_t>(raw), &result); break;
+    case TypedKind::Uint64: napi_create_bigint_uint64(env, raw, &result); break;
+    case TypedKind::String: {
+      const char* s = reinterpret_cast<const char*>(raw);
+      if (s) napi_create_string_utf8(env, s, NAPI_AUTO_LENGTH, &result);
+      else napi_get_null(env, &result);
+      break;
+    }
+    default: napi_get_undefined(env, &result); break;
+  }
+  return result;
+#else
+  napi_throw_error(env, nullptr, "Typed calls are not supported on this platform");
+  return nullptr;
+#endif
+}
+
+// bind() fallback
+
+struct TypedBound : SymbolBinding {
+  TypedSignature signature;
+};
+
+static napi_value callTypedBound(napi_env env, napi_callback_info cbinfo) {
+  napi_value argv[kMaxParams];
+  size_t argc = kMaxParams;
+  void* data = nullptr;
+  napi_get_cb_info(env, cbinfo, &argc, argv, nullptr, &data);
+  auto* bound = static_cast<TypedBound*>(data);
+  if (statsEnabled() && !bound->stats) bound->stats = symbolStats(bound->lib->handle, bound->name);
+  return callTyped(env, bound->fn, bound->name.c_str(), bound->signature, argv, argc, statsEnabled() ? bound->stats : nullptr);
+}
+
+static void finalizeTypedBound(napi_env, void* data, void*) {
+  auto* bound = static_cast<TypedBound*>(data);
+  releaseLibrary(bound->lib);
+  delete bound;
+}
+
+Napi::Value bindTypedSymbol(Napi::Env env, SharedLibrary* lib, const std::string& symbol, const std::string& signature,
+                            const std::shared_ptr<BindingSet>& registry) {
+  auto bound = std::make_unique<TypedBound>();
+  std::string err;
+  if (!parseTypedSignature(signature, bound->signature, err)) {
+    Napi::TypeError::New(env, "Unsupported signature: " + signature + " (" + err + ")").ThrowAsJavaScriptException();
+    return Napi::Value();
+  }
+
+  bound->fn = safeDlsym<void*>(lib->handle, symbol, err);
+  if (!bound->fn) {
+    Napi::Error::New(env, "[ERROR] symbol lookup: " + err).ThrowAsJavaScriptException();
+    return Napi::Value();
+  }
+  bound->lib = lib;
+  bound->name = symbol;
+  retainLibrary(lib);
+  if (registry) {
+    bound->registry = registry;
+    registry->insert(bound.get());
+  }
+
+  napi_value result;
+  TypedBound* raw = bound.release();
+  napi_create_function(env, symbol.c_str(), symbol.size(), callTypedBound, raw, &result);
+  napi_add_finalizer(env, result, raw, finalizeTypedBound, nullptr, nullptr);
+  return Napi::Function(env, result);
+}
+
+// runTyped(lib, symbol, signature, args). Parsed signatures are kept by
+// their text and names are read into stack buffers, so repeated calls
+// against a Library allocate nothing beyond the JS result. Like the
+// argument arena, the cache is per thread; once full, new signatures
+// replace old ones in turn.
+
+static constexpr size_t kSignatureCacheSize = 64;
+
+static const TypedSignature* cachedSignature(napi_env env, napi_value value, std::string& error) {
+  static thread_local std::vector<std::unique_ptr<TypedSignature>> cache;
+  static thread_local size_t nextSlot = 0;
+
+  char text[256];
+  size_t length;
+  if (napi_get_value_string_utf8(env, value, text, sizeof(text), &length) != napi_ok || length + 1 >= sizeof(text)) {
+    error = "Expected a signature string";
+    return nullptr;
+  }
+  for (const auto& sig : cache)
+    if (sig->text.size() == length && memcmp(sig->text.data(), text, length) == 0) return sig.get();
+
+  auto sig = std::make_unique<TypedSignature>();
+  if (!parseTypedSignature(std::string(text, length), *sig, error)) return nullptr;
+  if (cache.size() < kSignatureCacheSize) {
+    cache.push_back(std::move(sig));
+    return cache.back().get();
+  }
+  std::unique_ptr<TypedSignature>& slot = cache[nextSlot];
+  nextSlot = (nextSlot + 1) % kSignatureCacheSize;
+  slot = std::move(sig);
+  return slot.get();
+}
+
+Napi::Value RunTyped(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+  std::string error;
+  LibraryLease lib = leaseLibrary(info[0], error);
+  if (!lib) {
+    Napi::Error::New(env, error).ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  const TypedSignature* sig = cachedSignature(env, info[2], error);
+  if (!sig) {
+    Napi::TypeError::New(env, error).ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  char symbol[256];
+  size_t symbolLength;
+  if (napi_get_value_string_utf8(env, info[1], symbol, sizeof(symbol), &symbolLength) != napi_ok) {
+    Napi::TypeError::New(env, "Expected a symbol name").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+  if (symbolLength + 1 >= sizeof(symbol)) {
+    // A longer name would be silently truncated and look up a different symbol
+    Napi::TypeError::New(env, "Symbol name too long (max " + std::to_string(sizeof(symbol) - 2) + " bytes)").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+  uint64_t start = statsEnabled() ? monotonicNs() : 0;
+  dlerror();
+  void* fn = dlsym(lib.handle(), symbol);
+  if (start) recordPhase(StatsPhase::Dlsym, monotonicNs() - start);
+  if (!fn) {
+    recordSymbolError(lib.handle(), symbol);
+    const char* err = dlerror();
+    Napi::Error::New(env, std::string("[ERROR] symbol lookup: ") + (err ? err : symbol)).ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  napi_value argv[kMaxParams];
+  uint32_t argc = 0;
+  if (info[3].IsArray()) {
+    Napi::Array args = info[3].As<Napi::Array>();
+    argc = std::min<uint32_t>(args.Length(), kMaxParams);
+    for (uint32_t i = 0; i < argc; ++i) napi_get_element(env, args, i, &argv[i]);
+  }
+
+  napi_value result = callTyped(env, fn, symbol, *sig, argv, argc, statsEnabled() ? symbolStats(lib.handle(), symbol) : nullptr);
+  if (!result) return env.Null();
+  return Napi::Value(env, result);
+}
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <napi.h>
+#include <string>
+#include <vector>
+#include "library.h"
+
+// Typed calling convention for signatures outside the fixed bind() table.
+// Arguments are converted straight to their C types (no argv strings) and
+// the call is made through one register-class function pointer type, which
+// is only valid where every scalar argument travels in a register.
+#if (defined(__x86_64__) && !defined(_WIN32)) || defined(__aarch64__)
+#define SLJS_TYPED_CALLS 1
+#else
+#define SLJS_TYPED_CALLS 0
+#endif
+
+enum class TypedKind : uint8_t {
+  Void, Bool, Int32, Uint32, Int64, Uint64, Float, Double, String, Pointer,
+};
+
+struct TypedParam {
+  TypedKind kind;
+  // For Pointer: the TypedArray type the argument must have, or -1 for any view
+  int arrayType = -1;
+};
+
+struct TypedSignature {
+  std::string text;
+  TypedKind ret = TypedKind::Void;
+  std::vector<TypedParam> params;
+  unsigned intCount = 0;
+  unsigned floatCount = 0;
+};
+
+// Parses "double(int32_t, float*, int64_t)"; returns false with `error` set
+// on unknown types or more arguments than fit in registers.
+bool parseTypedSignature(const std::string& text, TypedSignature& out, std::string& error);
+
+// bind() fallback for signatures not in the trampoline table
+Napi::Value bindTypedSymbol(Napi::Env env, SharedLibrary* lib, const std::string& symbol, const std::string& signature,
+                            const std::shared_ptr<BindingSet>& registry = nullptr);
+
+// runTyped(lib, symbol, signature, args)
+Napi::Value RunTyped(const Napi::CallbackInfo& info);
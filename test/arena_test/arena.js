@@ -0,0 +1,122 @@
+const path = require('path');
+const sljs = require('../../build/Release/sljs');
+
+const lib = sljs.open(path.resolve(__dirname, 'kernels.so'));
+const alignedTo = (alignment, ...views) => sljs.runBuffers(lib, 'aligned_to', [...views, new Uint32Array([alignment])]);
+
+const arena = sljs.createArena({ size: 1 << 20 });
+const bytes = arena.alloc(3);
+const floats = arena.alloc(1000, 'float32');
+const doubles = arena.alloc(10, 'float64');
+console.log(bytes.constructor.name, floats.constructor.name, floats.length, doubles.constructor.name);
+console.log('64-byte aligned:', alignedTo(64, bytes, floats, doubles), 'of 3');
+const page = arena.alloc(16, 'uint8', { alignment: 4096 });
+console.log('4096-byte aligned:', alignedTo(4096, page), 'of 1');
+
+// JS and the library write the same memory
+const particles = arena.structOfArrays(1000, { x: 'float32', vx: 'float32', id: 'uint32' });
+console.log('columns:', Object.keys(particles), particles.x.length, 'aligned:', alignedTo(64, ...Object.values(particles)));
+particles.x.fill(1);
+particles.vx.forEach((_, i) => { particles.vx[i] = i; });
+console.log('integrate:', sljs.runBuffers(lib, 'integrate', [particles.x, particles.vx]), particles.x[0], particles.x[10], particles.x[999]);
+const byteSum = lib.bind('byte_sum', 'int(uint8_t*, size_t)');
+bytes.set([1, 2, 3]);
+console.log('bound call sees the block:', byteSum(bytes));
+
+let s = arena.stats();
+console.log('stats:', { size: s.size, used: s.used, allocations: s.allocations, liveBlocks: s.liveBlocks, alignment: s.alignment });
+
+// reset() rewinds everything and detaches what was handed out
+arena.reset();
+console.log('after reset:', floats.length, particles.x.length, arena.stats().used, arena.stats().resets);
+const again = arena.alloc(4, 'int32');
+again.set([5, 6, 7, 8]);
+console.log('reused:', Array.from(again), floats.length);
+
+// Running out throws, and a layout that does not fit allocates nothing
+try {
+  arena.alloc(1 << 20, 'float64');
+} catch (e) {
+  console.log(`${e.constructor.name}: ${e.message}`);
+}
+const before = arena.stats().used;
+try {
+  arena.structOfArrays(100000, { a: 'float32', b: 'float64' });
+} catch (e) {
+  console.log(`${e.constructor.name}: ${e.message}`, 'used unchanged:', arena.stats().used === before);
+}
+for (const bad of [() => arena.alloc(4, 'complex'), () => arena.alloc(4, 'uint8', { alignment: 48 }), () => sljs.createArena({ alignment: 3 })]) {
+  try {
+    bad();
+  } catch (e) {
+    console.log(`${e.constructor.name}: ${e.message}`);
+  }
+}
+
+// Huge pages: the size is rounded to 2 MiB and the block start aligned to it
+const huge = sljs.createArena({ size: 3 << 20, hugePages: true });
+const hs = huge.stats();
+console.log('huge pages:', hs.size === 4 << 20, typeof hs.hugePages, alignedTo(2 << 20, huge.alloc(1, 'uint8', { alignment: 2 << 20 })));
+huge.free();
+
+// lock: true pins the pages, within RLIMIT_MEMLOCK
+try {
+  const locked = sljs.createArena({ size: 64 << 10, lock: true });
+  console.log('locked:', locked.stats().locked);
+  locked.free();
+} catch (e) {
+  console.log('locked:', e.message.includes('ulimit -l'));
+}
+
+// free() unmaps now; blocks are detached and the arena refuses further use
+const kept = arena.alloc(8);
+arena.free();
+console.log('after free:', kept.length, again.length);
+try {
+  arena.alloc(1);
+} catch (e) {
+  console.log('error:', e.message);
+}
+
+// Many short-lived blocks without a reset: collected ones are forgotten,
+// live ones are still detached by the next reset
+{
+  const churn = sljs.createArena({ size: 1 << 20 });
+  const kept = churn.alloc(4);
+  for (let i = 0; i < 4000; i++) {
+    churn.alloc(1);
+    if (i % 1000 === 999) global.gc();
+  }
+  global.gc();
+  const liveBlocks = churn.stats().liveBlocks;
+  churn.reset();
+  console.log('churn:', liveBlocks, 'live blocks, kept block after reset:', kept.length);
+  churn.free();
+}
+
+// A block outlives a collected arena object
+function orphan() {
+  const a = sljs.createArena({ size: 4096 });
+  const view = a.alloc(4, 'uint32');
+  view.set([1, 2, 3, 4]);
+  return view;
+}
+const survivor = orphan();
+global.gc();
+survivor[0] += 10;
+console.log('orphaned block:', Array.from(survivor));
+
+// While an async call works on a block, reset() is refused and free()
+// leaves the mapping in place until the call is done
+const busy = sljs.createArena({ size: 4 << 20 });
+const block = busy.alloc(4 << 20);
+block.fill(1);
+const mapping = sljs.parallelMapAsync(lib, 'invert', block);
+try {
+  busy.reset();
+} catch (e) {
+  console.log('reset while in flight:', e.message, 'pending:', busy.stats().pendingCalls);
+}
+busy.free();
+console.log('freed while in flight:', block.length);
+mapping.then(() => console.log('async call finished after free'));
@@ -0,0 +1,33 @@
+#include <stdint.h>
+#include <sljs.h>
+
+// Number of buffers whose start is a multiple of `alignment` (the last buffer, one uint32)
+int aligned_to(sljs_buffer* buffers, size_t count) {
+    uint32_t alignment = *(uint32_t*)buffers[count - 1].data;
+    int aligned = 0;
+    for (size_t i = 0; i + 1 < count; ++i)
+        if (((uintptr_t)buffers[i].data % alignment) == 0) aligned++;
+    return aligned;
+}
+
+// x += vx * 0.5 over two float columns of a struct-of-arrays layout
+int integrate(sljs_buffer* buffers, size_t count) {
+    if (count != 2 || buffers[0].length != buffers[1].length) return -1;
+    float* x = buffers[0].data;
+    const float* vx = buffers[1].data;
+    size_t n = buffers[0].length / sizeof(float);
+    for (size_t i = 0; i < n; ++i) x[i] += vx[i] * 0.5f;
+    return (int)n;
+}
+
+// Sum of the bytes, through a bound `int(uint8_t*, size_t)` function
+int byte_sum(uint8_t* data, size_t length) {
+    int sum = 0;
+    for (size_t i = 0; i < length; ++i) sum += data[i];
+    return sum;
+}
+
+// Map: invert every byte in place, for parallelMapAsync over a block
+void invert(uint8_t* data, size_t length) {
+    for (size_t i = 0; i < length; ++i) data[i] = (uint8_t)~data[i];
+}
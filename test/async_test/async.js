@@ -0,0 +1,39 @@
+const path = require('path');
+const sljs = require('../../build/Release/sljs');
+
+const soPath = path.resolve(__dirname, 'slow.so');
+sljs.setThreadPoolSize(4);
+
+// The event loop keeps ticking while the native calls run on the pool
+const ticker = setInterval(() => process.stdout.write('.'), 20);
+
+(async () => {
+  const started = Date.now();
+  const calls = [];
+  for (let i = 0; i < 4; ++i) calls.push(sljs.runValueAsync(soPath, 'slow_answer'));
+  console.log('\npool stats while running:', sljs.getThreadPoolStats());
+
+  const values = await Promise.all(calls);
+  console.log('\nvalues:', values, `in ${Date.now() - started} ms`); // ~200 ms, not ~800 ms
+
+  console.log('text:', await sljs.runTextAsync(soPath, 'slow_hello'));
+
+  try {
+    await sljs.runValueAsync(soPath, 'missing_symbol');
+  } catch (e) {
+    console.log('rejected:', e.message);
+  }
+
+  clearInterval(ticker);
+  console.log('pool stats when idle:', sljs.getThreadPoolStats());
+
+  // Each worker_thread settles its promises on its own queue, and the main
+  // thread's queue works after a worker that used the pool has exited
+  const { Worker } = require('worker_threads');
+  const worker = new Worker(`
+    const sljs = require(${JSON.stringify(require.resolve('../../build/Release/sljs'))});
+    sljs.runValueAsync(${JSON.stringify(soPath)}, 'slow_answer').then((v) => require('worker_threads').parentPort.postMessage(v));
+  `, { eval: true });
+  worker.on('message', (v) => console.log('worker async:', v));
+  worker.on('exit', async () => console.log('main async after worker exit:', await sljs.runValueAsync(soPath, 'slow_answer')));
+})();
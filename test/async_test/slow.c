@@ -0,0 +1,12 @@
+#include <stdio.h>
+#include <unistd.h>
+
+int slow_answer() {
+    usleep(200 * 1000);
+    return 42;
+}
+
+void slow_hello() {
+    usleep(200 * 1000);
+    printf("Hello from a worker thread\n");
+}
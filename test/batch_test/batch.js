@@ -0,0 +1,40 @@
+const path = require('path');
+const sljs = require('../../build/Release/sljs');
+
+const lib = sljs.open(path.resolve(__dirname, 'score.so'));
+
+// Array of argument tuples; bad items are flagged instead of throwing
+const tuples = sljs.runBatch(lib, 'score', 'double(double, double)', [[4, 8], [1, 1], ['x', 2], [0, 4]]);
+console.log('results:', tuples.results);           // Float64Array [5, 1, 0, 1]
+console.log('errors bitmap:', tuples.errors, 'errorCount:', tuples.errorCount); // bit 2 set
+
+// Packed TypedArray: count * arity elements, row after row
+const packed = new Float64Array([4, 8, 1, 1, 0, 4]);
+console.log('packed:', sljs.runBatch(lib, 'score', 'double(double,double)', packed).results);
+
+// Single-parameter signatures take bare values
+console.log('square:', sljs.runBatch(lib, 'square', 'int(int)', [1, 2, 3, 4]).results);
+console.log('square packed:', sljs.runBatch(lib, 'square', 'int(int)', new Int32Array([5, 6])).results);
+
+console.log('byte_sum:', sljs.runBatch(lib, 'byte_sum', 'int(uint8_t*, size_t)', [Buffer.from([1, 2]), 'oops', new Uint8Array([9])]));
+
+// Zero-parameter signatures take a call count, which must be a sane integer
+console.log('tick:', sljs.runBatch(lib, 'tick', 'int()', 3).results);
+for (const count of [-1, 1.5, Infinity, 2 ** 32]) {
+  try {
+    sljs.runBatch(lib, 'tick', 'int()', count);
+  } catch (e) {
+    console.log(`count ${count}:`, e.constructor.name, e.message);
+  }
+}
+
+const n = 100000;
+const inputs = new Int32Array(n).map((_, i) => i);
+let start = process.hrtime.bigint();
+sljs.runBatch(lib, 'square', 'int(int)', inputs);
+const batchNs = Number(process.hrtime.bigint() - start) / n;
+start = process.hrtime.bigint();
+for (let i = 0; i < n; ++i) sljs.runArgsValue(lib, 'square', [String(i)]);
+const loopNs = Number(process.hrtime.bigint() - start) / n;
+console.log(`runBatch ${batchNs.toFixed(1)} ns/item vs runArgsValue loop ${loopNs.toFixed(1)} ns/call`);
+lib.close();
@@ -0,0 +1,23 @@
+#include <stdint.h>
+#include <stddef.h>
+
+double score(double x, double y) {
+    return x * 0.75 + y * 0.25;
+}
+
+int square(int x) {
+    return x * x;
+}
+
+int byte_sum(uint8_t* data, size_t length) {
+    int sum = 0;
+    for (size_t i = 0; i < length; ++i) sum += data[i];
+    return sum;
+}
+
+static int ticks;
+
+// Zero-parameter: runBatch takes a plain call count
+int tick(void) {
+    return ++ticks;
+}
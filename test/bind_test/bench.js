@@ -0,0 +1,26 @@
+const path = require('path');
+const sljs = require('../../build/Release/sljs');
+
+// Compares the per-call cost of runValue (path and Library) with a bound function
+const soPath = path.resolve(__dirname, 'mathlib.so');
+const iterations = Number(process.argv[2]) || 200000;
+
+function bench(label, fn) {
+  for (let i = 0; i < 1000; ++i) fn(); // warm up
+  const start = process.hrtime.bigint();
+  for (let i = 0; i < iterations; ++i) fn();
+  const ns = Number(process.hrtime.bigint() - start) / iterations;
+  console.log(`${label.padEnd(24)} ${ns.toFixed(1).padStart(10)} ns/call  ${(1e9 / ns).toFixed(0).padStart(12)} calls/s`);
+  return ns;
+}
+
+const lib = sljs.open(soPath);
+const giveNumber = lib.bind('give_number', 'int()');
+
+const pathNs = bench('runValue(path)', () => sljs.runValue(soPath, 'give_number'));
+const libNs = bench('runValue(lib)', () => sljs.runValue(lib, 'give_number'));
+const boundNs = bench('bound give_number()', () => giveNumber());
+
+console.log(`bound vs runValue(path): ${(pathNs / boundNs).toFixed(1)}x faster`);
+console.log(`bound vs runValue(lib):  ${(libNs / boundNs).toFixed(1)}x faster`);
+lib.close();
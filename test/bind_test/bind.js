@@ -0,0 +1,29 @@
+const path = require('path');
+const sljs = require('../../build/Release/sljs');
+
+const lib = sljs.open(path.resolve(__dirname, 'mathlib.so'));
+
+const giveNumber = lib.bind('give_number', 'int()');
+const add = lib.bind('add', 'int(int, int)');
+const scale = lib.bind('scale', 'double(double)');
+const bigSquare = lib.bind('big_square', 'int64_t(int64_t)');
+const join = lib.bind('join', 'const char*(int, const char**)');
+const checksum = lib.bind('checksum', 'int(uint8_t*, size_t)');
+
+console.log('give_number() =>', giveNumber());             // 69420
+console.log('add(2, 3) =>', add(2, 3));                     // 5
+console.log('scale(4) =>', scale(4));                       // 10
+console.log('big_square(3000000000n) =>', bigSquare(3000000000n)); // 9000000000000000000n
+console.log('join([...]) =>', join(['so', 'li', 'js']));    // solijs
+console.log('checksum(...) =>', checksum(Buffer.from([1, 2, 3, 4]))); // 10
+
+try {
+  add('not a number', 1);
+} catch (e) {
+  console.log('bad arguments =>', e.message);
+}
+
+// Bound functions keep the library loaded after close()
+lib.close();
+console.log('after close =>', add(20, 22));                 // 42
+console.log('supported signatures:', sljs.signatures.length);
@@ -0,0 +1,35 @@
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+
+int give_number() {
+    return 69420;
+}
+
+int add(int a, int b) {
+    return a + b;
+}
+
+double scale(double x) {
+    return x * 2.5;
+}
+
+int64_t big_square(int64_t x) {
+    return x * x;
+}
+
+const char* join(int argc, const char** argv) {
+    static char out[256];
+    out[0] = '\0';
+    for (int i = 0; i < argc; ++i) {
+        strncat(out, argv[i], sizeof(out) - strlen(out) - 1);
+    }
+    return out;
+}
+
+int checksum(uint8_t* data, size_t length) {
+    int sum = 0;
+    for (size_t i = 0; i < length; ++i) sum += data[i];
+    return sum;
+}
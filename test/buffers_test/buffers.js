@@ -0,0 +1,44 @@
+const path = require('path');
+const sljs = require('../../build/Release/sljs');
+
+const lib = sljs.open(path.resolve(__dirname, 'kernels.so'));
+
+// Several typed inputs and a preallocated output, passed by pointer
+const a = new Float32Array([1, 2, 3, 4]);
+const b = new Float32Array([10, 20, 30, 40]);
+const out = new Float32Array(4);
+console.log('saxpy wrote', sljs.runBuffers(lib, 'saxpy', [a, b, new Float32Array([2]), out]), out);
+
+// Any view type works; lengths are in bytes
+const shared = new SharedArrayBuffer(64);
+const bytes = sljs.runBuffers(lib, 'count_bytes', [
+  new Int32Array(4), new DataView(new ArrayBuffer(8)), shared, new Float64Array(shared, 8, 2), Buffer.alloc(3),
+]);
+console.log('bytes seen:', bytes); // 16 + 8 + 64 + 16 + 3 = 107
+
+// The library allocates the result; JS gets it without a copy
+const positive = new Int32Array(sljs.runBufferAlloc(lib, 'filter_positive', [new Int32Array([3, -1, 0, 7, -5, 9])]));
+console.log('positive:', positive, 'live allocations:', sljs.runValue(lib, 'allocations'));
+
+try {
+  sljs.runBufferAlloc(lib, 'always_fails', [], 'sljs_free');
+} catch (e) {
+  console.log('error:', e.message, 'live allocations:', sljs.runValue(lib, 'allocations'));
+}
+
+try {
+  sljs.runBuffers(lib, 'count_bytes', [42]);
+} catch (e) {
+  console.log('error:', e.message);
+}
+
+// Once the ArrayBuffer is collected, sljs_free runs in the library (run with --expose-gc)
+if (global.gc) {
+  for (let i = 0; i < 100; i++) sljs.runBufferAlloc(lib, 'filter_positive', [new Int32Array(1024).fill(1)]);
+  console.log('live allocations before gc:', sljs.runValue(lib, 'allocations'));
+  global.gc();
+  setTimeout(() => {
+    global.gc();
+    console.log('live allocations after gc:', sljs.runValue(lib, 'allocations'), '(only `positive` left)');
+  }, 20);
+}
@@ -0,0 +1,55 @@
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sljs.h>
+
+// out[i] = a[i] * scale[0] + b[i]  (Float32Array a, Float32Array b, Float32Array scale, Float32Array out)
+int saxpy(sljs_buffer* buffers, size_t count) {
+    if (count != 4) return -1;
+    const float* a = buffers[0].data;
+    const float* b = buffers[1].data;
+    float scale = *(const float*)buffers[2].data;
+    float* out = buffers[3].data;
+    size_t n = buffers[3].length / sizeof(float);
+    for (size_t i = 0; i < n; ++i) out[i] = a[i] * scale + b[i];
+    return (int)n;
+}
+
+// Sums every input byte-wise into a shared counter (any view type)
+int count_bytes(sljs_buffer* buffers, size_t count) {
+    int total = 0;
+    for (size_t i = 0; i < count; ++i) total += (int)buffers[i].length;
+    return total;
+}
+
+static int live_allocations = 0;
+
+// Keeps only the positive values of an Int32Array; the result size is only known here
+int filter_positive(const sljs_buffer* inputs, size_t count, sljs_buffer* out) {
+    if (count != 1) return 1;
+    const int32_t* in = inputs[0].data;
+    size_t n = inputs[0].length / sizeof(int32_t);
+    int32_t* result = malloc(n * sizeof(int32_t) + 1);
+    size_t kept = 0;
+    for (size_t i = 0; i < n; ++i)
+        if (in[i] > 0) result[kept++] = in[i];
+    live_allocations++;
+    out->data = result;
+    out->length = kept * sizeof(int32_t);
+    return 0;
+}
+
+int always_fails(const sljs_buffer* inputs, size_t count, sljs_buffer* out) {
+    out->data = malloc(16);
+    live_allocations++;
+    return 7;
+}
+
+void sljs_free(void* data) {
+    live_allocations--;
+    free(data);
+}
+
+int allocations() {
+    return live_allocations;
+}
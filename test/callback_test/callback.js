@@ -0,0 +1,180 @@
+const path = require('path');
+const sljs = require('../../build/Release/sljs');
+
+const lib = sljs.open(path.resolve(__dirname, 'progress.so'));
+const startWorkers = lib.bind('start_workers', 'int(int, int)');
+const joinWorkers = lib.bind('join_workers', 'int()');
+const emitOnce = lib.bind('emit_once', 'int()');
+const forget = lib.bind('forget', 'void()');
+const startFlood = lib.bind('start_flood', 'int(int, int)');
+
+const WORKERS = 4, STEPS = 20000, DONE_KEY = 1000;
+
+// Every call arrives, in order per worker, in batches no larger than maxBatch
+function everyCall() {
+  const next = new Uint32Array(WORKERS);
+  let steps = 0, done = 0, disorder = 0, oversized = 0, batches = 0;
+  const started = process.hrtime.bigint();
+  const callback = sljs.createCallback(lib, {
+    register: 'register_progress', unregister: 'unregister_progress', maxBatch: 512,
+    onCall(events) {
+      batches++;
+      if (events.length > 512) oversized++;
+      for (const { key, data } of events) {
+        if (key >= DONE_KEY) { done++; continue; }
+        const step = new DataView(data.buffer, data.byteOffset, data.byteLength).getUint32(0, true);
+        if (step !== next[key]) disorder++;
+        next[key] = step + 1;
+        steps++;
+      }
+      if (done < WORKERS) return;
+      joinWorkers();
+      const ms = Number(process.hrtime.bigint() - started) / 1e6;
+      const stats = callback.stats();
+      callback.close();
+      console.log('all calls:', steps === WORKERS * STEPS, 'in order:', disorder === 0, 'batches within maxBatch:', oversized === 0);
+      console.log('fewer batches than calls:', batches < steps, 'delivered:', stats.delivered === steps + WORKERS, 'open:', callback.open);
+      console.log(`(${steps + WORKERS} calls in ${batches} batches, ${((steps + WORKERS) / ms / 1e3).toFixed(2)}M calls/s, largest batch ${stats.largestBatch})`);
+      coalesced();
+    },
+  });
+  console.log('start:', startWorkers(WORKERS, STEPS));
+}
+
+// With coalescing a batch keeps only the newest step of each worker
+function coalesced() {
+  const last = new Int32Array(WORKERS).fill(-1);
+  let done = 0, backwards = 0;
+  const callback = sljs.createCallback(lib, {
+    register: 'register_progress', unregister: 'unregister_progress', coalesce: true,
+    onCall(events) {
+      const seen = new Set();
+      for (const { key, data } of events) {
+        if (seen.has(key)) backwards++; // one event per key and batch
+        seen.add(key);
+        if (key >= DONE_KEY) { done++; continue; }
+        const step = data[0] | data[1] << 8 | data[2] << 16 | data[3] << 24;
+        if (step <= last[key]) backwards++;
+        last[key] = step;
+      }
+      if (done < WORKERS) return;
+      joinWorkers();
+      callback.close(); // hands over whatever is still queued first
+      const stats = callback.stats();
+      console.log('latest step per worker:', last.every((step) => step === STEPS - 1), 'one per key:', backwards === 0);
+      console.log('calls coalesced:', stats.coalesced > 0, 'accounted for:', stats.delivered + stats.coalesced === WORKERS * STEPS + WORKERS);
+      delayed();
+    },
+  });
+  startWorkers(WORKERS, STEPS);
+}
+
+// maxLatency holds the first wakeup back so later calls join its batch
+function delayed() {
+  const sizes = [];
+  let first;
+  const callback = sljs.createCallback(lib, {
+    register: 'register_progress', unregister: 'unregister_progress', maxLatency: 30,
+    onCall(events) {
+      sizes.push(events.length);
+      if (sizes.length > 1) return;
+      first = Number(process.hrtime.bigint() - started) / 1e6;
+    },
+  });
+  const started = process.hrtime.bigint();
+  startWorkers(1, 1);
+  joinWorkers();
+  setTimeout(() => {
+    startWorkers(2, 100);
+    joinWorkers();
+    setTimeout(() => {
+      callback.close();
+      console.log('held back:', first >= 25, 'batched:', sizes.length === 2 && sizes[1] === 202);
+      handle();
+    }, 80);
+  }, 80);
+}
+
+// The pair also reaches the library as a plain buffer
+function handle() {
+  let received;
+  const callback = sljs.createCallback(lib, { onCall(events) { received = events; } });
+  console.log('handle:', callback.handle.length, 'adopted:', sljs.runBuffers(lib, 'adopt_handle', [callback.handle]));
+  console.log('emit:', emitOnce());
+  setImmediate(() => {
+    const value = received && new DataView(received[0].data.buffer, received[0].data.byteOffset, 4).getUint32(0, true);
+    console.log('received:', received && received.length, received && received[0].key, value);
+    callback.close();
+    // Without an unregister symbol the library may still call; it is refused
+    console.log('after close:', emitOnce(), 'stats:', callback.stats().delivered);
+    forget();
+    errors();
+  });
+}
+
+function errors() {
+  const attempts = {
+    'no options': () => sljs.createCallback(lib),
+    'no onCall': () => sljs.createCallback(lib, { register: 'register_progress' }),
+    'missing register': () => sljs.createCallback(lib, { onCall() {}, register: 'nope' }),
+    'refused': () => sljs.createCallback(lib, { onCall() {}, register: 'register_refused' }),
+    'bad library': () => sljs.createCallback(42, { onCall() {} }),
+  };
+  for (const [name, attempt] of Object.entries(attempts)) {
+    try {
+      attempt();
+      console.log(name, 'did not throw');
+    } catch (e) {
+      console.log(name, 'threw:', e.message);
+    }
+  }
+  // Closing twice is fine, and a registered callback can be replaced after close
+  const callback = sljs.createCallback(lib, { onCall() {}, register: 'register_progress', unregister: 'unregister_progress' });
+  callback.close();
+  callback.close();
+  const again = sljs.createCallback(lib, { onCall() {}, register: 'register_progress', unregister: 'unregister_progress' });
+  console.log('re-registered:', again.open);
+  again.close();
+  closeUnderLoad(20);
+}
+
+// close() while workers are mid-call: no wakeup reaches a released queue
+// or a collected wrapper. Without unregister the closed target outlives it.
+function closeUnderLoad(rounds) {
+  if (rounds === 0) {
+    console.log('closed under load: ok');
+    closeInOnCall();
+    return;
+  }
+  const callback = sljs.createCallback(lib, { onCall() {} });
+  sljs.runBuffers(lib, 'adopt_handle', [callback.handle]);
+  startFlood(WORKERS, 20000);
+  callback.close();
+  joinWorkers();
+  forget();
+  if (global.gc) global.gc();
+  setImmediate(() => closeUnderLoad(rounds - 1));
+}
+
+// close() from onCall on a full batch: the rest is delivered once that
+// onCall returns, not from inside it, and no wakeup follows
+function closeInOnCall() {
+  let depth = 0, nested = 0, received = 0, batches = 0;
+  const callback = sljs.createCallback(lib, {
+    register: 'register_progress', unregister: 'unregister_progress', maxBatch: 4,
+    onCall(events) {
+      if (depth++) nested++;
+      batches++;
+      received += events.length;
+      if (batches === 1) callback.close();
+      depth--;
+    },
+  });
+  startWorkers(1, 100);
+  joinWorkers();
+  setTimeout(() => {
+    console.log('closed in onCall:', received === 101, 'nested:', nested, 'batches:', batches, 'open:', callback.open);
+  }, 20);
+}
+
+everyCall();
@@ -0,0 +1,102 @@
+// Workers reporting progress through an sljs_callback: each thread calls
+// back once per step with its id as the key, then once more when done,
+// keyed DONE_KEY + id.
+#include <pthread.h>
+#include <sched.h>
+#include <string.h>
+#include <sljs.h>
+
+#define MAX_WORKERS 8
+#define DONE_KEY 1000
+
+typedef struct {
+  uint32_t step;
+  uint32_t total;
+} progress;
+
+static sljs_callback registered;
+static pthread_t threads[MAX_WORKERS];
+static int ids[MAX_WORKERS];
+static int workers, steps;
+static volatile int rejected;
+
+int register_progress(sljs_callback_fn invoke, void* context) {
+  if (registered.invoke) return 3; // one listener at a time
+  registered.invoke = invoke;
+  registered.context = context;
+  return 0;
+}
+
+void unregister_progress(void* context) {
+  if (registered.context == context) memset(&registered, 0, sizeof(registered));
+}
+
+int register_refused(sljs_callback_fn invoke, void* context) {
+  (void)invoke;
+  (void)context;
+  return 7;
+}
+
+// Takes the pair from callback.handle instead of a register symbol
+int adopt_handle(sljs_buffer* buffers, size_t count) {
+  if (count != 1 || buffers[0].length != sizeof(sljs_callback)) return 1;
+  memcpy(&registered, buffers[0].data, sizeof(registered));
+  return 0;
+}
+
+static void* work(void* arg) {
+  int id = *(int*)arg;
+  for (int i = 0; i < steps; i++) {
+    progress p = { (uint32_t)i, (uint32_t)steps };
+    // A full queue is retried rather than lost, so every step arrives
+    while (sljs_callback_call(&registered, (uint64_t)id, &p, sizeof(p)) != 0 && registered.invoke) sched_yield();
+  }
+  sljs_callback_call(&registered, DONE_KEY + (uint64_t)id, &id, sizeof(id));
+  return NULL;
+}
+
+int start_workers(int count, int per_worker) {
+  if (!registered.invoke || count < 1 || count > MAX_WORKERS) return 1;
+  workers = count;
+  steps = per_worker;
+  for (int i = 0; i < count; i++) {
+    ids[i] = i;
+    pthread_create(&threads[i], NULL, work, &ids[i]);
+  }
+  return 0;
+}
+
+// Calls from a private copy of the pair and ignores refusals, so calls keep
+// arriving while the callback closes
+static void* flood(void* arg) {
+  sljs_callback pair = registered;
+  for (int i = 0; i < steps; i++) sljs_callback_call(&pair, (uint64_t)*(int*)arg, &i, sizeof(i));
+  return NULL;
+}
+
+int start_flood(int count, int per_worker) {
+  if (!registered.invoke || count < 1 || count > MAX_WORKERS) return 1;
+  workers = count;
+  steps = per_worker;
+  for (int i = 0; i < count; i++) {
+    ids[i] = i;
+    pthread_create(&threads[i], NULL, flood, &ids[i]);
+  }
+  return 0;
+}
+
+int join_workers(void) {
+  for (int i = 0; i < workers; i++) pthread_join(threads[i], NULL);
+  workers = 0;
+  return 0;
+}
+
+// Status of a single call, for checking what a closed callback returns
+int emit_once(void) {
+  uint32_t value = 42;
+  return registered.invoke ? sljs_callback_call(&registered, 7, &value, sizeof(value)) : -2;
+}
+
+void forget(void) {
+  memset(&registered, 0, sizeof(registered));
+}
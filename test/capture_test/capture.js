@@ -0,0 +1,62 @@
+const path = require('path');
+const sljs = require('../../build/Release/sljs');
+
+const soPath = path.resolve(__dirname, 'report.so');
+
+// Large output is drained while the call runs: no truncation, no deadlock
+const output = sljs.runText(soPath, 'big_report');
+console.log('captured bytes:', output.length, 'lines:', output.trim().split('\n').length); // 20000 lines
+
+// A background child keeps the pipe open; the capture returns without waiting for it
+const started = Date.now();
+const cpu = process.cpuUsage();
+const detached = sljs.runText(soPath, 'detached_child').trim();
+const spentCpu = process.cpuUsage(cpu);
+console.log(detached, '- fast:', Date.now() - started < 1000, 'idle:', (spentCpu.user + spentCpu.system) / 1000 < 200); // true true
+
+// stderr can be captured too; the pipes are read separately, so its line need not come last
+sljs.setCaptureOptions({ stderr: true });
+console.log('stderr line:', sljs.runText(soPath, 'big_report').split('\n').includes('report finished')); // true
+
+// Stream chunks to the logger as they arrive
+let chunks = 0;
+let bytes = 0;
+const streams = new Set();
+sljs.setStdoutLogger((text, stream) => {
+  chunks++;
+  bytes += text.length;
+  streams.add(stream);
+});
+sljs.setCaptureOptions({ stream: true, flushBytes: 64 * 1024 });
+
+console.log(sljs.runText(soPath, 'big_report'));
+console.log('sync chunks:', chunks, 'bytes:', bytes, 'streams:', [...streams]);
+
+chunks = 0;
+bytes = 0;
+sljs.runTextAsync(soPath, 'big_report').then((result) => {
+  console.log(result);
+  setImmediate(() => {
+    console.log('async chunks:', chunks, 'bytes:', bytes);
+    inWorker();
+  });
+});
+
+// A worker_thread has its own logger, options and streaming queue: its
+// chunks reach its logger only, and the main thread's keep working after it exits
+function inWorker() {
+  chunks = 0;
+  const { Worker } = require('worker_threads');
+  const worker = new Worker(`
+    const sljs = require(${JSON.stringify(require.resolve('../../build/Release/sljs'))});
+    let bytes = 0;
+    sljs.setStdoutLogger((text) => { bytes += text.length; });
+    console.log('worker options:', sljs.setCaptureOptions({ stream: true }));
+    sljs.runTextAsync(${JSON.stringify(soPath)}, 'big_report').then(() => setImmediate(() => require('worker_threads').parentPort.postMessage(bytes)));
+  `, { eval: true });
+  worker.on('message', (workerBytes) => console.log('worker streamed:', workerBytes, 'main chunks meanwhile:', chunks));
+  worker.on('exit', () => {
+    bytes = 0;
+    sljs.runTextAsync(soPath, 'big_report').then(() => setImmediate(() => console.log('main bytes after worker exit:', bytes)));
+  });
+}
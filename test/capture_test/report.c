@@ -0,0 +1,17 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+// Prints far more than one pipe buffer (64 KiB) to stdout, plus a note on stderr
+void big_report() {
+    for (int i = 0; i < 20000; ++i) {
+        printf("line %05d: the quick brown fox jumps over the lazy dog\n", i);
+    }
+    fprintf(stderr, "report finished\n");
+}
+
+// Leaves a background child holding the captured stdout open
+void detached_child() {
+    printf("started a background sleep\n");
+    fflush(stdout);
+    system("sleep 4 &");
+}
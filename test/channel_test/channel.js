@@ -0,0 +1,82 @@
+const path = require('path');
+const sljs = require('../../build/Release/sljs');
+
+const lib = sljs.open(path.resolve(__dirname, 'producer.so'));
+const total = sljs.runValue(lib, 'total_events');
+
+// Checks every record against what producer.c wrote; per-producer order must hold
+const next = new Uint32Array(4);
+let received = 0, corrupt = 0, batches = 0;
+function consume({ count, data, offsets }) {
+  batches++;
+  const view = new DataView(data.buffer, data.byteOffset, data.byteLength);
+  for (let i = 0; i < count; i++) {
+    const at = offsets[i], length = offsets[i + 1] - at;
+    const producer = view.getUint32(at, true), seq = view.getUint32(at + 4, true);
+    if (producer >= 4 || seq !== next[producer] || length !== 8 + seq % 13) corrupt++;
+    for (let j = 8; j < length; j++) if (data[at + j] !== ((seq + j) & 0xff)) corrupt++;
+    next[producer] = seq + 1;
+  }
+  received += count;
+}
+
+// Woken by the library only when the ring goes from empty to non-empty
+const started = process.hrtime.bigint();
+const channel = sljs.createChannel(lib, {
+  capacity: 64 * 1024, init: 'start_producers', stop: 'stop_producers',
+  onData(ch) {
+    consume(ch.drain());
+    if (received < total) return;
+    const ms = Number(process.hrtime.bigint() - started) / 1e6;
+    const stats = ch.stats();
+    ch.close();
+    console.log('received all:', received === total, 'corrupt:', corrupt);
+    console.log('fewer wakeups than records:', stats.notifications < total, 'open:', ch.open);
+    console.log(`(${total} records in ${batches} batches, ${(total / ms / 1e3).toFixed(2)}M records/s, ${stats.dropped} pushes retried on a full ring)`);
+    lossyRing();
+  },
+});
+console.log('capacity:', channel.stats().capacity, 'buffer:', channel.buffer instanceof SharedArrayBuffer, channel.buffer.byteLength);
+
+// Without a consumer a small ring fills up and the overflow is counted, not blocked on
+function lossyRing() {
+  const ch = sljs.createChannel(lib, { capacity: 1000, init: 'start_lossy', stop: 'stop_producers' });
+  setTimeout(() => {
+    ch.close(); // joins the producers; what made it in can still be drained
+    const { count } = ch.drain(10);
+    const stats = ch.stats();
+    console.log('rounded capacity:', stats.capacity, 'drained 10:', count === 10, 'dropped some:', stats.dropped > 0);
+    console.log('rest accounted for:', ch.drain().count + 10 + stats.dropped === total);
+    errors();
+  }, 50);
+}
+
+function errors() {
+  try {
+    sljs.createChannel(lib, { init: 'refuse' });
+  } catch (e) {
+    console.log('error:', e.message);
+  }
+  try {
+    sljs.createChannel(lib, { init: 'missing_init' });
+  } catch (e) {
+    console.log('error:', e.message.split(':').slice(0, 2).join(':'));
+  }
+  try {
+    sljs.createChannel(lib, {});
+  } catch (e) {
+    console.log('error:', e.message);
+  }
+  unreferenced();
+}
+
+// An open channel nobody references is not collected while its producers
+// (here without a stop symbol) still write into its buffer
+function unreferenced() {
+  sljs.createChannel(lib, { capacity: 1000, init: 'start_lossy' });
+  for (let i = 0; i < 5; i++) global.gc();
+  setTimeout(() => {
+    global.gc();
+    console.log('unreferenced channel kept until close: ok');
+  }, 50);
+}
@@ -0,0 +1,55 @@
+// Producers for the ring channel: each thread pushes a numbered stream of
+// variable-length records so wrap-around and padding get exercised.
+#include <pthread.h>
+#include <sched.h>
+#include <sljs.h>
+
+#define PRODUCERS 4
+#define PER_PRODUCER 50000
+
+typedef struct {
+  uint32_t producer;
+  uint32_t seq;
+  uint8_t tail[12];
+} event;
+
+static pthread_t threads[PRODUCERS];
+static int ids[PRODUCERS];
+static sljs_ring* current;
+static volatile int stopping;
+static int lossy;
+
+static void* produce(void* arg) {
+  int id = *(int*)arg;
+  for (uint32_t seq = 0; seq < PER_PRODUCER && !stopping; seq++) {
+    event e = { (uint32_t)id, seq, { 0 } };
+    uint32_t length = 8 + seq % 13;
+    for (uint32_t i = 8; i < length; i++) e.tail[i - 8] = (uint8_t)(seq + i);
+    // Back off while the ring is full; the lossy variant just drops
+    while (sljs_ring_push(current, &e, length) != 0 && !lossy && !stopping) sched_yield();
+  }
+  return NULL;
+}
+
+static int start(sljs_ring* ring, int drop) {
+  if (ring->magic != SLJS_RING_MAGIC) return 1;
+  current = ring;
+  stopping = 0;
+  lossy = drop;
+  for (int i = 0; i < PRODUCERS; i++) {
+    ids[i] = i;
+    pthread_create(&threads[i], NULL, produce, &ids[i]);
+  }
+  return 0;
+}
+
+int start_producers(sljs_ring* ring, size_t capacity) { return start(ring, 0); }
+int start_lossy(sljs_ring* ring, size_t capacity) { return start(ring, 1); }
+int refuse(sljs_ring* ring, size_t capacity) { return 7; }
+
+void stop_producers(sljs_ring* ring) {
+  stopping = 1;
+  for (int i = 0; i < PRODUCERS; i++) pthread_join(threads[i], NULL);
+}
+
+int total_events() { return PRODUCERS * PER_PRODUCER; }
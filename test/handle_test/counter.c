@@ -0,0 +1,11 @@
+#include <stdio.h>
+
+static int calls = 0;
+
+int next_count() {
+    return ++calls;
+}
+
+void report() {
+    printf("counter is at %d\n", calls);
+}
@@ -0,0 +1,35 @@
+const path = require('path');
+const sljs = require('../../build/Release/sljs');
+
+const soPath = path.resolve(__dirname, 'counter.so');
+
+// Path calls open and close the library every time, so static state resets
+console.log('path call:', sljs.runValue(soPath, 'next_count')); // 1
+console.log('path call:', sljs.runValue(soPath, 'next_count')); // 1
+
+// A Library keeps the handle (and its static state) alive between calls
+const lib = sljs.open(soPath, sljs.RTLD_NOW);
+console.log('handle call:', sljs.runValue(lib, 'next_count')); // 1
+console.log('handle call:', sljs.runValue(lib, 'next_count')); // 2
+
+// While the Library is open, path calls share the cached handle
+console.log('path call:', sljs.runValue(soPath, 'next_count')); // 3
+console.log(sljs.runText(lib, 'report'));
+
+lib.close();
+console.log('isOpen after close:', lib.isOpen);
+
+// Each env keeps its own Library class: opening on the main thread still
+// works after a worker that loaded the addon has exited
+const { Worker } = require('worker_threads');
+const worker = new Worker(`
+  const sljs = require(${JSON.stringify(require.resolve('../../build/Release/sljs'))});
+  const lib = sljs.open(${JSON.stringify(soPath)});
+  require('worker_threads').parentPort.postMessage(sljs.runValue(lib, 'next_count'));
+`, { eval: true });
+worker.on('message', (count) => console.log('worker call:', count));
+worker.on('exit', () => {
+  const again = sljs.open(soPath);
+  console.log('open after worker exit:', again.isOpen, again instanceof sljs.Library);
+  again.close();
+});
@@ -0,0 +1,7 @@
+// Plugin fixture for the symbol index test
+int plugin_version = 3;
+const char plugin_name[] = "codec";
+
+int codec_encode(int x) { return x * 2; }
+int codec_decode(int x) { return x / 2; }
+int shared_hook(void) { return 1; }
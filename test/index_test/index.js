@@ -0,0 +1,82 @@
+const fs = require('fs');
+const os = require('os');
+const path = require('path');
+const sljs = require('../../build/Release/sljs');
+
+// A plugin tree: two objects at the top, one nested, a symlink to an object
+// already listed, a file that is not ELF and a directory the index skips
+const dir = fs.mkdtempSync(path.join(os.tmpdir(), 'sljs-index-'));
+fs.mkdirSync(path.join(dir, 'nested'));
+fs.copyFileSync(path.resolve(__dirname, 'codec.so'), path.join(dir, 'codec.so'));
+fs.copyFileSync(path.resolve(__dirname, 'render.so'), path.join(dir, 'nested', 'librender.so.1'));
+fs.writeFileSync(path.join(dir, 'broken.so'), 'INPUT(-lcodec)\n');
+fs.writeFileSync(path.join(dir, 'README'), 'not a plugin\n');
+fs.symlinkSync('codec.so', path.join(dir, 'zz-alias.so'));
+
+const local = p => path.relative(dir, p);
+const where = matches => matches.map(m => `${m.name} ${m.type} ${m.symbolType} size=${m.size} in ${local(m.library)}`);
+const summary = s => ({ files: s.files, symbols: s.symbols, parsed: s.parsed, reused: s.reused, removed: s.removed, written: s.written, mapped: s.mapped });
+
+// First scan parses everything and writes <dir>/.sljs-index
+const top = sljs.indexDirectory(dir);
+console.log('top level:', summary(top.stats()));
+console.log('unreadable:', top.stats().unreadable.map(u => local(u.library)));
+console.log(where(top.findSymbol('codec_encode')));
+console.log('render_frame at top level:', top.findSymbol('render_frame').length);
+top.close();
+
+// The recursive scan only parses the nested object; the rest comes from the index
+const all = sljs.indexDirectory(dir, { recursive: true });
+console.log('recursive:', summary(all.stats()));
+console.log(where(all.findSymbol('shared_hook')));
+console.log(where(all.findSymbol('plugin_version')));
+console.log('missing:', all.findSymbol('nope'));
+
+// Prefix and glob searches over the sorted names
+console.log('prefix codec_:', all.search('codec_').map(m => m.name));
+console.log('glob *_width:', all.search('*_width').map(m => m.name));
+console.log('glob plugin_[nv]*:', all.search('plugin_[nv]*').map(m => `${m.name}@${path.basename(m.library)}`));
+console.log('limit 2:', all.search('', { limit: 2 }).length);
+
+// Nothing changed: the existing index is mapped and used as is
+const again = sljs.indexDirectory(dir, { recursive: true });
+console.log('unchanged:', summary(again.stats()));
+
+// Touching a file re-reads only that file; deleting one drops its symbols
+fs.utimesSync(path.join(dir, 'codec.so'), new Date(), new Date(Date.now() + 5000));
+console.log('after touch:', summary(again.refresh()));
+fs.unlinkSync(path.join(dir, 'nested', 'librender.so.1'));
+console.log('after delete:', summary(again.refresh()));
+console.log('render_frame after delete:', again.findSymbol('render_frame').length);
+again.close();
+
+// A damaged index file is rebuilt rather than trusted
+fs.writeFileSync(path.join(dir, '.sljs-index'), Buffer.alloc(200, 0xff));
+const rebuilt = sljs.indexDirectory(dir);
+console.log('damaged index:', summary(rebuilt.stats()));
+
+// index: false keeps everything in memory and touches nothing on disk
+const memory = sljs.indexDirectory(dir, { index: false });
+console.log('in memory:', summary(memory.stats()), memory.stats().index);
+
+// Lookups cost a hash probe and a string compare
+const rounds = 200000;
+let found = 0;
+const start = process.hrtime.bigint();
+for (let i = 0; i < rounds; ++i) found += rebuilt.findSymbol('codec_decode').length;
+const ns = Number(process.hrtime.bigint() - start) / rounds;
+console.log(`findSymbol: ${found === rounds ? 'ok' : 'wrong'} (${ns.toFixed(0)} ns per lookup)`);
+
+rebuilt.close();
+try {
+  rebuilt.findSymbol('codec_decode');
+} catch (e) {
+  console.log('error:', e.message);
+}
+try {
+  sljs.indexDirectory(path.join(dir, 'absent'));
+} catch (e) {
+  console.log('error:', e.message.replace(dir, '<dir>'));
+}
+
+fs.rmSync(dir, { recursive: true });
@@ -0,0 +1,6 @@
+// Second plugin fixture; exports some of the same names as codec.c
+int plugin_version = 7;
+
+void render_frame(void) {}
+int render_width(void) { return 640; }
+int shared_hook(void) { return 2; }
@@ -0,0 +1,24 @@
+const path = require('path');
+const sljs = require('../../build/Release/sljs');
+
+const soPath = path.resolve(__dirname, 'shapes.so');
+
+// Same lines `nm -D --defined-only` prints, read straight from the ELF file
+for (const line of sljs.inspect(soPath)) process.stdout.write(line);
+
+// Structured records, optionally with demangled C++ names
+for (const sym of sljs.smartInspect(soPath, { demangle: true })) {
+  console.log(`${sym.type} ${sym.symbolType.padEnd(6)} ${sym.binding.padEnd(6)} ${sym.section.padEnd(8)} size=${sym.size} ${sym.demangled}`);
+}
+
+// The system math library carries versioned symbols (exp@GLIBC_2.2.5, exp@@GLIBC_2.29)
+const libm = sljs.smartInspect('/lib/x86_64-linux-gnu/libm.so.6');
+console.log(libm.filter(s => s.name === 'exp').map(s => `${s.name}${s.defaultVersion ? '@@' : '@'}${s.version}`));
+
+console.log(sljs.inspect('/etc/hostname'));
+
+try {
+  sljs.smartInspect('/no/such/lib.so');
+} catch (e) {
+  console.log('smartInspect error:', e.message);
+}
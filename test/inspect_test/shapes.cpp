@@ -0,0 +1,24 @@
+#include <cstdio>
+
+namespace shapes {
+
+int area(int w, int h) {
+    return w * h;
+}
+
+}
+
+extern "C" {
+
+int shape_count = 3;
+extern const char shape_name[] = "square";
+
+int sides() {
+    return 4;
+}
+
+__attribute__((weak)) void on_draw() {
+    printf("drawing %s\n", shape_name);
+}
+
+}
@@ -0,0 +1,33 @@
+// A library that misbehaves on purpose, for isolated pools
+#include <signal.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <sljs.h>
+
+static int counter;
+
+int answer() { return 42; }
+int count_calls() { return ++counter; }
+int worker_pid() { return (int)getpid(); }
+
+void crash() { *(volatile int*)0 = 1; }
+void bail() { exit(3); }
+void hang() { for (;;) pause(); }
+void touch() { counter += 0; }
+
+// Doubles every float in place, like runBufferFunc kernels do
+void double_floats(uint8_t* data, size_t length) {
+  float* values = (float*)data;
+  for (size_t i = 0; i < length / sizeof(float); i++) values[i] *= 2;
+}
+
+// out[i] = a[i] + b[i]; returns the element count
+int add_arrays(sljs_buffer* buffers, size_t count) {
+  if (count != 3) return -1;
+  const int32_t* a = buffers[0].data;
+  const int32_t* b = buffers[1].data;
+  int32_t* out = buffers[2].data;
+  size_t n = buffers[2].length / sizeof(int32_t);
+  for (size_t i = 0; i < n; i++) out[i] = a[i] + b[i];
+  return (int)n;
+}
@@ -0,0 +1,78 @@
+const path = require('path');
+const sljs = require('../../build/Release/sljs');
+
+const lib = path.resolve(__dirname, 'faulty.so');
+
+async function main() {
+  const pool = sljs.createIsolatedPool(lib, { workers: 2, timeout: 300 });
+  console.log('answer:', await pool.runValue('answer'));
+  console.log('worker is another process:', (await pool.runValue('worker_pid')) !== process.pid);
+
+  // Buffers go through the worker's shared arena and come back updated
+  const floats = new Float32Array([1.5, 2, -4]);
+  await pool.runBufferFunc('double_floats', floats);
+  console.log('doubled:', floats);
+  const out = new Int32Array(4);
+  const n = await pool.runBuffers('add_arrays', [new Int32Array([1, 2, 3, 4]), new Int32Array([10, 20, 30, 40]), out]);
+  console.log('added', n, out);
+
+  // A fault only fails its own call; the worker is replaced
+  for (const symbol of ['crash', 'bail']) {
+    try {
+      await pool.run(symbol);
+    } catch (e) {
+      console.log('error:', e.message);
+    }
+  }
+  try {
+    await pool.run('hang');
+  } catch (e) {
+    console.log('error:', e.message);
+  }
+  console.log('still answering:', await pool.runValue('answer'));
+
+  // Calls spread over the workers and can be in flight together
+  const results = await Promise.allSettled([pool.runValue('answer'), pool.run('crash'), pool.runValue('answer'), pool.runValue('answer')]);
+  console.log('mixed batch:', results.map(r => r.status).join(' '));
+  const { workers, crashes, timeouts, restarts, pending } = pool.stats();
+  console.log({ workers, crashes, timeouts, restarts, pending });
+
+  try {
+    await pool.run('missing_symbol');
+  } catch (e) {
+    console.log('error:', e.message.startsWith('Symbol not found'), e.message.endsWith('undefined symbol: missing_symbol'));
+  }
+  try {
+    await pool.runBuffers('add_arrays', [new Int32Array(1 << 20)]);
+  } catch (e) {
+    console.log('error:', e.message);
+  }
+
+  // Round trip cost next to the in-process call
+  const rounds = 2000;
+  let start = process.hrtime.bigint();
+  for (let i = 0; i < rounds; i++) await pool.run('touch');
+  const isolatedUs = Number(process.hrtime.bigint() - start) / rounds / 1e3;
+  start = process.hrtime.bigint();
+  for (let i = 0; i < rounds; i++) await sljs.runValueAsync(lib, 'count_calls');
+  const asyncUs = Number(process.hrtime.bigint() - start) / rounds / 1e3;
+  console.log(`(isolated call ${isolatedUs.toFixed(1)}us, in-process async call ${asyncUs.toFixed(1)}us)`);
+
+  pool.close();
+  try {
+    await pool.runValue('answer');
+  } catch (e) {
+    console.log('error:', e.message);
+  }
+
+  for (const options of [{ workers: 0 }, { arena: -1 }, { timeout: 2 ** 31 }, { timeout: -1 }]) {
+    try {
+      sljs.createIsolatedPool(lib, options).close();
+      console.log(options, 'did not throw');
+    } catch (e) {
+      console.log(options, e.name + ':', e.message);
+    }
+  }
+}
+
+main();
@@ -0,0 +1,62 @@
+const path = require('path');
+const sljs = require('../../build/Release/sljs');
+
+const lib = sljs.open(path.resolve(__dirname, 'sim.so'));
+
+let events = 0;
+let last = null;
+const loop = sljs.startLoop(lib, 'world_step', {
+  hz: 120,
+  renderSymbol: 'draw',
+  onFrame: (frame) => { events++; last = frame; },
+});
+
+// Block the event loop for a while: ticks keep running natively and the
+// frame events that pile up meanwhile are coalesced into one.
+setTimeout(() => {
+  const until = Date.now() + 200;
+  while (Date.now() < until);
+}, 100);
+
+setTimeout(() => {
+  loop.pause();
+  const paused = sljs.runValue(lib, 'tick_count');
+  setTimeout(() => {
+    console.log('paused:', loop.paused, 'ticks while paused:', sljs.runValue(lib, 'tick_count') - paused);
+    loop.resume();
+    setTimeout(() => {
+      loop.stop();
+      const stats = loop.stats();
+      console.log('running:', loop.running);
+      // ~2s unpaused at 120 Hz, including the 200 ms the event loop was blocked
+      console.log('ticks in range:', stats.ticks > 220 && stats.ticks < 260, stats.ticks);
+      console.log('frame events delivered < frames:', events < stats.frames, 'coalesced:', stats.coalescedEvents > 0);
+      console.log('last event keys:', Object.keys(last));
+      console.log('frameTime p50 ~ target:', Math.abs(stats.frameTime.p50 - stats.targetMs) < 2, stats.frameTime);
+      console.log(sljs.runText(lib, 'report').trim());
+      overrun();
+    }, 1600);
+  }, 200);
+}, 400);
+
+function overrun() {
+  const loop = sljs.startLoop(lib, 'heavy_step', { hz: 60, maxCatchUpSteps: 2 });
+  setTimeout(() => {
+    loop.stop();
+    const stats = loop.stats();
+    console.log('heavy: missed deadlines > 0:', stats.missedDeadlines > 0, 'workTime max >= 25ms:', stats.workTime.max >= 25);
+
+    try {
+      sljs.startLoop(lib, 'missing_tick');
+    } catch (e) {
+      console.log('error:', e.message.split(':')[0]);
+    }
+    for (const hz of [0, 2e9]) {
+      try {
+        sljs.startLoop(lib, 'heavy_step', { hz });
+      } catch (e) {
+        console.log(`hz ${hz}:`, e.constructor.name, e.message);
+      }
+    }
+  }, 1000);
+}
@@ -0,0 +1,31 @@
+#include <stdio.h>
+#include <time.h>
+
+static int ticks = 0;
+static double simulated = 0;
+static int renders = 0;
+
+void world_step(float dt) {
+    ticks++;
+    simulated += dt;
+}
+
+// Every 30th tick is slow enough to overrun a 60 Hz budget
+void heavy_step(float dt) {
+    world_step(dt);
+    if (ticks % 30 == 0) {
+        struct timespec pause = { 0, 25 * 1000 * 1000 };
+        nanosleep(&pause, NULL);
+    }
+}
+
+void draw() {
+    renders++;
+}
+
+int tick_count() { return ticks; }
+int render_count() { return renders; }
+
+void report() {
+    printf("ticks=%d renders=%d simulated=%.3fs\n", ticks, renders, simulated);
+}
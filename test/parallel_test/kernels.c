@@ -0,0 +1,27 @@
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+// Map: invert every byte in place (thread-safe: touches only its chunk)
+void invert(uint8_t* data, size_t length) {
+    for (size_t i = 0; i < length; ++i) data[i] = (uint8_t)~data[i];
+}
+
+// Reduce: FNV-1a over the chunks in order; the result only matches a
+// serial hash if chunks are folded strictly in sequence.
+void fnv1a(uint8_t* acc, size_t accLen, const uint8_t* chunk, size_t chunkLen) {
+    uint64_t hash;
+    memcpy(&hash, acc, sizeof(hash));
+    for (size_t i = 0; i < chunkLen; ++i) {
+        hash ^= chunk[i];
+        hash *= 1099511628211ull;
+    }
+    memcpy(acc, &hash, sizeof(hash));
+}
+
+// Reduce: counts chunks and records the largest one (acc = two uint64s)
+void chunk_stats(uint8_t* acc, size_t accLen, const uint8_t* chunk, size_t chunkLen) {
+    uint64_t* out = (uint64_t*)acc;
+    out[0] += 1;
+    if (chunkLen > out[1]) out[1] = chunkLen;
+}
@@ -0,0 +1,38 @@
+const path = require('path');
+const sljs = require('../../build/Release/sljs');
+
+const lib = sljs.open(path.resolve(__dirname, 'kernels.so'));
+
+const data = Buffer.alloc(4 * 1024 * 1024 + 13);
+for (let i = 0; i < data.length; i++) data[i] = (i * 31) & 0xff;
+
+// In place: every byte inverted, chunk by chunk across the pool
+const out = sljs.parallelMap(lib, 'invert', data, { chunkSize: 64 * 1024 });
+console.log('returns input:', out === data, 'inverted:', data[1] === (~31 & 0xff) && data[data.length - 1] === (~((data.length - 1) * 31) & 0xff));
+
+// Ordered reduce: matches a serial FNV-1a over the mapped buffer
+function fnv(buf) {
+  let h = 0xcbf29ce484222325n;
+  for (const b of buf) h = BigInt.asUintN(64, (h ^ BigInt(b)) * 0x100000001b3n);
+  return h;
+}
+const expected = fnv(data.map(b => ~b & 0xff));
+const initial = Buffer.alloc(8);
+initial.writeBigUInt64LE(0xcbf29ce484222325n);
+const hash = sljs.parallelMap(lib, 'invert', data, { chunkSize: 4096, reduce: 'fnv1a', initial });
+console.log('ordered reduce matches serial hash:', hash.readBigUInt64LE() === expected);
+
+// Chunks start on `alignment` boundaries; an unaligned view gets a short head chunk
+const view = new Uint8Array(data.buffer, data.byteOffset + 3, 10000);
+const stats = sljs.parallelMap(lib, 'invert', view, { chunkSize: 1000, alignment: 256, reduce: 'chunk_stats', resultSize: 16 });
+console.log('chunks:', stats.readBigUInt64LE(0), 'largest:', stats.readBigUInt64LE(8)); // chunkSize rounds up to 1024
+
+sljs.parallelMapAsync(lib, 'invert', data, { reduce: 'fnv1a', initial }).then((h) => {
+  console.log('async reduce matches:', h.readBigUInt64LE() === fnv(data));
+});
+
+try {
+  sljs.parallelMap(lib, 'invert', data, { reduce: 'no_such_reduce' });
+} catch (e) {
+  console.log('error:', e.message.split(':')[0]);
+}
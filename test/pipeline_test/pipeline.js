@@ -0,0 +1,64 @@
+const path = require('path');
+const sljs = require('../../build/Release/sljs');
+
+const lib = sljs.open(path.resolve(__dirname, 'world.so'));
+const sleep = ms => new Promise(r => setTimeout(r, ms));
+const initial = new Float64Array([0, 0, 1, 0]);
+const world = state => new Float64Array(state.buffer, state.byteOffset, 4);
+const consistent = w => w[3] === w[1] * 2 + w[0];
+
+async function run(depth) {
+  const pipeline = sljs.createPipeline(lib, { tick: 'world_tick', render: 'world_render', stateSize: 32, depth, paced: false, initial });
+  await sleep(600);
+  pipeline.stop();
+  return pipeline.stats();
+}
+
+async function main() {
+  // tick takes 2 ms and render 3 ms: run back to back that is 5 ms a frame
+  const sequential = 1000 / 5;
+  for (const depth of [2, 3]) {
+    const s = await run(depth);
+    console.log(`depth ${s.depth}: render rate beats sequential: ${s.renderRate > sequential * 1.3},`,
+                `tick rate beats sequential: ${s.tickRate > sequential * 1.3},`,
+                `frames skipped by render: ${s.skipped > 0}, tick stalled: ${s.stalls > 0}`);
+    console.log('  stage timings:', ['p50', 'p90', 'p99', 'max'].every(k => s.tickTime[k] >= 1.5 && s.renderTime[k] >= 2.5));
+  }
+
+  // latest() pins the newest state in place; tick keeps going around it
+  let events = 0;
+  const paced = sljs.createPipeline(lib, { tick: 'world_tick', render: 'world_render', stateSize: 32, hz: 100, initial, onFrame: () => events++ });
+  const first = paced.latest();
+  console.log('initial state:', first.frame, Array.from(world(first.state)), first.state.length);
+  await sleep(300);
+  const { frame, state } = paced.latest();
+  const pinned = Array.from(world(state));
+  console.log('state at frame', frame === pinned[0], 'consistent', consistent(world(state)));
+  await sleep(100);
+  console.log('pinned slot untouched while ticks continue:', Array.from(world(state)).every((v, i) => v === pinned[i]),
+              paced.latest().frame > frame);
+  paced.release();
+  await sleep(100);
+  paced.stop();
+  const s = paced.stats();
+  console.log('paced at 100 Hz:', s.frames >= 35 && s.frames <= 55, 'onFrame events:', events > 0 && events <= s.frames,
+              'running:', paced.running);
+  console.log('torn reads seen by render:', sljs.runValue(lib, 'torn_reads'));
+
+  // Without a render symbol only the tick thread runs
+  const headless = sljs.createPipeline(lib, { tick: 'world_tick', initial, stateSize: 32, paced: false });
+  await sleep(100);
+  headless.stop();
+  const h = headless.stats();
+  console.log('headless:', h.frames > 10, h.rendered, consistent(world(headless.latest().state)));
+
+  for (const options of [{ tick: 'world_tick', stateSize: 32, depth: 4 }, { tick: 'missing', stateSize: 32 }, { tick: 'world_tick' }]) {
+    try {
+      sljs.createPipeline(lib, options);
+    } catch (e) {
+      console.log('error:', e.message.split(__dirname + '/').join(''));
+    }
+  }
+}
+
+main();
@@ -0,0 +1,44 @@
+#include <time.h>
+
+// State shared with JS as a Float64Array: { frame, position, velocity, check }
+typedef struct {
+    double frame;
+    double position;
+    double velocity;
+    double check; // written last; a torn or overwritten state fails the check
+} world;
+
+static int torn = 0;
+static int renders = 0;
+
+static void work(long us) {
+    struct timespec pause = { 0, us * 1000 };
+    nanosleep(&pause, NULL);
+}
+
+static int consistent(const world* w) {
+    return w->check == w->position * 2 + w->frame;
+}
+
+void world_tick(void* out, const void* in, float dt) {
+    const world* a = in;
+    world* b = out;
+    b->frame = a->frame + 1;
+    b->velocity = a->velocity;
+    b->position = a->position + a->velocity * dt;
+    work(2000);
+    b->check = b->position * 2 + b->frame;
+}
+
+void world_render(const void* state) {
+    const world* w = state;
+    double frame = w->frame;
+    if (!consistent(w)) torn++;
+    work(3000);
+    // Nobody may write the slot while it is being rendered
+    if (!consistent(w) || w->frame != frame) torn++;
+    renders++;
+}
+
+int torn_reads() { return torn; }
+int render_count() { return renders; }
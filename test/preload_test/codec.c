@@ -0,0 +1,9 @@
+// Self-contained second library, preloaded with RTLD_DEEPBIND
+#include <stddef.h>
+#include <stdint.h>
+
+int checksum(uint8_t* data, size_t length) {
+  int sum = 0;
+  for (size_t i = 0; i < length; i++) sum += data[i];
+  return sum;
+}
@@ -0,0 +1,4 @@
+// Ordinary library for the preload manifest
+int area(int w, int h) { return w * h; }
+double hypotenuse_sq(double a, double b) { return a * a + b * b; }
+const char* unit() { return "cm"; }
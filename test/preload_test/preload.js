@@ -0,0 +1,50 @@
+const path = require('path');
+const sljs = require('../../build/Release/sljs');
+
+const so = name => path.resolve(__dirname, name);
+
+async function main() {
+  const { totalMs, libraries } = await sljs.preload([
+    { path: so('geometry.so'), symbols: { area: 'int(int, int)', hypotenuse_sq: 'double(double, double)', unit: 'const char*()' } },
+    { path: so('codec.so'), flags: sljs.RTLD_NOW | (sljs.RTLD_DEEPBIND || 0), symbols: { checksum: 'int(uint8_t*, size_t)' } },
+  ]);
+  const [geometry, codec] = libraries;
+  console.log('area:', geometry.functions.area(3, 4), 'hyp²:', geometry.functions.hypotenuse_sq(3, 4), 'unit:', geometry.functions.unit());
+  console.log('checksum:', codec.functions.checksum(Buffer.from([1, 2, 3])));
+  console.log('libraries:', libraries.map(l => path.basename(l.path)), 'open:', geometry.lib.isOpen);
+  console.log('timings reported:', [totalMs, geometry.loadMs, geometry.resolveMs].every(t => typeof t === 'number' && t >= 0));
+
+  // Every problem is reported at once, and nothing stays loaded
+  try {
+    await sljs.preload([
+      { path: so('geometry.so'), symbols: { area: 'int(int, int)', perimeter: 'int(int, int)' } },
+      { path: so('unresolved.so'), symbols: { fine: 'int()' } },
+      { path: so('absent.so') },
+    ]);
+  } catch (e) {
+    const local = text => text.split(__dirname + '/').join('');
+    console.log('error:', local(e.message));
+    console.log(e.failures.map(local));
+  }
+  console.log('lazy open still works:', sljs.runValue(so('unresolved.so'), 'fine'));
+
+  // A library already open lazily is still checked as if loaded with RTLD_NOW
+  const lazy = sljs.open(so('unresolved.so'));
+  try {
+    await sljs.preload([{ path: so('unresolved.so'), symbols: { fine: 'int()' } }]);
+    console.log('preload after lazy open did not fail');
+  } catch (e) {
+    console.log('after lazy open:', e.failures.map(text => text.split(__dirname + '/').join('')));
+  }
+  console.log('lazy handle untouched:', lazy.isOpen, sljs.runValue(lazy, 'fine'));
+  lazy.close();
+
+  // Bad signatures are rejected before anything is loaded
+  try {
+    await sljs.preload([{ path: so('codec.so'), symbols: { checksum: 'int(struct thing)' } }]);
+  } catch (e) {
+    console.log('error:', e.message.split(__dirname + '/').join(''));
+  }
+}
+
+main();
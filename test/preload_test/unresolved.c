@@ -0,0 +1,5 @@
+// Links fine and opens with RTLD_LAZY, but RTLD_NOW refuses it: the failure
+// a lazy first request would only hit when the function is first called
+extern int defined_nowhere(void);
+int uses_missing() { return defined_nowhere(); }
+int fine() { return 1; }
@@ -0,0 +1,4 @@
+// A bad build: `scale` and `blend` went missing
+int version(void) {
+  return 3;
+}
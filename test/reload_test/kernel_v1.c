@@ -0,0 +1,25 @@
+#include <time.h>
+
+#ifndef VERSION
+#define VERSION 1
+#endif
+
+int version(void) {
+  return VERSION;
+}
+
+// Different math per build, so a stale pointer is easy to spot
+double scale(double x, double factor) {
+  return x * factor * VERSION;
+}
+
+float blend(float a, float b, unsigned weight) {
+  return (a * weight + b) / (weight + 1) + VERSION;
+}
+
+// Still running on the old generation while the new one is swapped in
+int slow_version(void) {
+  struct timespec ts = { 0, 300 * 1000000L };
+  nanosleep(&ts, 0);
+  return VERSION;
+}
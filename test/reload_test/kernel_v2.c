@@ -0,0 +1,2 @@
+#define VERSION 2
+#include "kernel_v1.c"
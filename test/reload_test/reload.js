@@ -0,0 +1,66 @@
+const fs = require('fs');
+const os = require('os');
+const path = require('path');
+const sljs = require('../../build/Release/sljs');
+
+// Deploys go through a rename, the way install(1) and most deploy tools replace files
+const dir = fs.mkdtempSync(path.join(os.tmpdir(), 'sljs-reload-'));
+const target = path.join(dir, 'kernel.so');
+const deploy = (build) => {
+  fs.copyFileSync(path.join(__dirname, build), target + '.tmp');
+  fs.renameSync(target + '.tmp', target);
+};
+const watchdog = setTimeout(() => { console.log('timed out'); process.exit(1); }, 10000);
+
+deploy('kernel_v1.so');
+const lib = sljs.open(target);
+const version = lib.bind('version', 'int()');
+const scale = lib.bind('scale', 'double(double,double)');
+const blend = lib.bind('blend', 'float(float, float, uint32_t)'); // typed convention
+console.log('v1:', version(), scale(2, 3), blend(1, 3, 1), 'generation', lib.generation);
+
+// Manual reload of the same file: a new generation, same code
+console.log('reload():', lib.reload(), version());
+
+const events = [];
+let next;
+const nextEvent = () => new Promise((resolve) => { next = resolve; });
+lib.watch({
+  interval: 50,
+  settle: 20,
+  onReload(e) { events.push(e); next({ type: 'reload', ...e }); },
+  onError(e) { events.push(e); next({ type: 'error', ...e }); },
+});
+console.log('watching:', lib.watching);
+
+(async () => {
+  // A call in flight keeps the generation it started on
+  const inFlight = sljs.runValueAsync(lib, 'slow_version');
+  let pending = nextEvent();
+  deploy('kernel_v2.so');
+  let e = await pending;
+  console.log(e.type, 'generation', e.generation, 'bindings', e.bindings, 'switch < 1ms:', e.switchNs < 1e6);
+  console.log('v2:', version(), scale(2, 3), blend(1, 3, 1));
+  console.log('in-flight call finished on v' + await inFlight);
+  console.log('runValue sees v' + sljs.runValue(lib, 'version'));
+
+  // A build missing bound symbols is rejected and v2 keeps running
+  pending = nextEvent();
+  deploy('kernel_broken.so');
+  e = await pending;
+  console.log(e.type, /lacks (scale|blend)/.test(e.error), 'generation', e.generation);
+  console.log('still v2:', version(), scale(2, 3));
+
+  // Rolling back is just another deploy
+  pending = nextEvent();
+  deploy('kernel_v1.so');
+  e = await pending;
+  console.log(e.type, 'generation', e.generation, 'v' + version());
+
+  lib.unwatch();
+  console.log('watching:', lib.watching, 'events:', events.length);
+  // Each generation was loaded from a hidden copy beside the file and unlinked after dlopen
+  console.log('left behind:', fs.readdirSync(dir).filter(f => f !== 'kernel.so'));
+  clearTimeout(watchdog);
+  fs.rmSync(dir, { recursive: true });
+})();
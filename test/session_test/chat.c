@@ -0,0 +1,43 @@
+// Interactive routines driven through a session's stdin
+#include <ctype.h>
+#include <stdio.h>
+#include <string.h>
+
+void ask_name() {
+  char name[64];
+  printf("name? ");
+  if (!fgets(name, sizeof(name), stdin)) {
+    printf("no answer\n");
+    return;
+  }
+  name[strcspn(name, "\n")] = '\0';
+  printf("hello, %s\n", name);
+}
+
+// Echoes lines in upper case until EOF
+void shout() {
+  char line[256];
+  int lines = 0;
+  while (fgets(line, sizeof(line), stdin)) {
+    for (char* p = line; *p; p++) *p = (char)toupper((unsigned char)*p);
+    fputs(line, stdout);
+    lines++;
+  }
+  printf("%d lines\n", lines);
+}
+
+void warn() {
+  printf("to stdout\n");
+  fprintf(stderr, "to stderr\n");
+}
+
+void report() {
+  for (int i = 0; i < 20000; i++) printf("line %05d of the report\n", i);
+}
+
+void greet_args(int argc, const char** argv) {
+  for (int i = 0; i < argc; i++) printf("[%s]", argv[i]);
+  printf("\n");
+}
+
+void noop() {}
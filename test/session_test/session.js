@@ -0,0 +1,76 @@
+const path = require('path');
+const sljs = require('../../build/Release/sljs');
+
+const lib = sljs.open(path.resolve(__dirname, 'chat.so'));
+
+async function main() {
+  // Pipes: stdin is fed from write(), each run's output comes back framed
+  const session = sljs.createSession({ stderr: true });
+  session.write('Ada\nGrace\n');
+  console.log(session.run(lib, 'ask_name'));
+  console.log(session.run(lib, 'ask_name')); // reads the second queued line
+  console.log(session.run(lib, 'ask_name').stdout); // nothing queued: no answer, no hang
+  console.log(session.run(lib, 'warn'));
+  console.log(session.run(lib, 'greet_args', ['a', 'b c']).stdout.trim());
+  const report = session.run(lib, 'report').stdout;
+  console.log('report lines:', report.trim().split('\n').length);
+
+  // Async runs block on stdin until JS writes to it
+  const shouting = session.runAsync(lib, 'shout');
+  session.write('first\n');
+  setTimeout(() => {
+    session.write('second\n');
+    session.end();
+  }, 20);
+  console.log(await shouting);
+  const { runs, bytesIn, queuedInput } = session.stats();
+  console.log({ runs, bytesIn, queuedInput });
+
+  // While an async run waits for input, sync captures on this thread fail
+  // fast instead of waiting for input only this thread could write. (fd 1
+  // belongs to that run meanwhile, so results are logged afterwards.)
+  const blocked = sljs.createSession();
+  const waiting = blocked.runAsync(lib, 'ask_name');
+  await new Promise((resolve) => setTimeout(resolve, 50));
+  const meanwhile = [sljs.runText(lib, 'noop')];
+  try {
+    session.run(lib, 'noop');
+  } catch (e) {
+    meanwhile.push(e.message);
+  }
+  blocked.write('Linus\n');
+  console.log((await waiting).stdout.trim(), meanwhile);
+  console.log('runText after:', JSON.stringify(sljs.runText(lib, 'noop')));
+  blocked.close();
+
+  // Same fds every time: per-run cost next to runText's pipe/thread setup
+  const rounds = 2000;
+  let start = process.hrtime.bigint();
+  for (let i = 0; i < rounds; i++) session.run(lib, 'noop');
+  const sessionUs = Number(process.hrtime.bigint() - start) / rounds / 1e3;
+  start = process.hrtime.bigint();
+  for (let i = 0; i < rounds; i++) sljs.runText(lib, 'noop');
+  const runTextUs = Number(process.hrtime.bigint() - start) / rounds / 1e3;
+  console.log(`(session run ${sessionUs.toFixed(1)}us, runText ${runTextUs.toFixed(1)}us)`);
+  session.close();
+  try {
+    session.run(lib, 'noop');
+  } catch (e) {
+    console.log('error:', e.message);
+  }
+
+  // A pty makes the library see a terminal; output streams with its run's seq
+  const chunks = [];
+  const tty = sljs.createSession({ pty: true, onOutput: (text, stream, seq) => chunks.push(`${seq}:${stream}:${text}`) });
+  tty.write('Linus\n');
+  const first = tty.run(lib, 'ask_name');
+  const second = tty.runAsync(lib, 'ask_name');
+  setTimeout(() => tty.write('Margaret\n'), 20);
+  await second;
+  setImmediate(() => {
+    console.log('pty runs:', first.seq, first.stdout === '', chunks); // the prompt arrives before the answer is written
+    tty.close();
+  });
+}
+
+main();
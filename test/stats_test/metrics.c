@@ -0,0 +1,27 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+int fast(void) {
+  return 7;
+}
+
+// Sleeps about `argv[0]` milliseconds so the histogram lands in a known bucket
+int slow(int argc, const char** argv) {
+  int ms = argc > 0 ? atoi(argv[0]) : 1;
+  struct timespec ts = { 0, ms * 1000000L };
+  nanosleep(&ts, NULL);
+  return ms;
+}
+
+void report(void) {
+  printf("frame ok\n");
+}
+
+const char* missing_name(void) {
+  return NULL;
+}
+
+int add(int a, int b) {
+  return a + b;
+}
@@ -0,0 +1,57 @@
+const path = require('path');
+const sljs = require('../../build/Release/sljs');
+
+const so = path.resolve(__dirname, 'metrics.so');
+const summary = (entry) => entry && { calls: entry.calls, errors: entry.errors, histogramTotal: entry.histogram.reduce((n, b) => n + b.count, 0) };
+const find = (stats, symbol) => stats.symbols.find(s => s.symbol === symbol);
+
+// Off by default: nothing is recorded
+sljs.runValue(so, 'fast');
+console.log('disabled:', sljs.getStats().enabled, sljs.getStats().symbols.length);
+
+console.log('was enabled:', sljs.setStatsEnabled(true));
+for (let i = 0; i < 1000; i++) sljs.runValue(so, 'fast');
+sljs.runArgsValue(so, 'slow', ['5']);
+sljs.runArgsValue(so, 'slow', ['5']);
+console.log(sljs.runText(so, 'report').trim());
+console.log(sljs.runStringReturn(so, 'missing_name'));
+console.log(sljs.runRender(so, 'no_such_symbol').startsWith('[ERROR]'));
+
+const lib = sljs.open(so);
+const add = lib.bind('add', 'int(int, int)');
+for (let i = 0; i < 500; i++) add(i, 1);
+
+let stats = sljs.getStats();
+console.log('fast:', summary(find(stats, 'fast')));
+console.log('add (bound):', summary(find(stats, 'add')));
+console.log('missing_name:', summary(find(stats, 'missing_name')));
+console.log('no_such_symbol:', summary(find(stats, 'no_such_symbol')));
+
+// 5 ms sleeps land in the 2^22..2^23 ns bucket (4.2..8.4 ms)
+const slow = find(stats, 'slow');
+console.log('slow calls:', slow.calls, 'p50 >= 4ms:', slow.p50Ns >= 4e6, 'max < 100ms:', slow.maxNs < 1e8);
+console.log('slow bucket:', slow.histogram.map(b => b.leNs));
+console.log('library:', path.basename(slow.library));
+
+// Phases: dlopen only on a cache miss, dlsym on every lookup, capture per runText
+console.log('dlopen:', stats.dlopen.count >= 1, 'dlsym:', stats.dlsym.count >= 1000, 'capture:', stats.capture.count);
+
+sljs.resetStats();
+stats = sljs.getStats();
+console.log('after reset:', stats.symbols.length, stats.dlsym.count);
+
+// The bound function's cached entry keeps counting after a reset
+add(1, 2);
+console.log('add after reset:', summary(find(sljs.getStats(), 'add')));
+
+// runBatch records one sample per item, packed or not
+sljs.runBatch(lib, 'add', 'int(int, int)', [[1, 2], [3, 4], [5, 6]]);
+sljs.runBatch(lib, 'add', 'int(int, int)', new Int32Array(20));
+sljs.runBatch(lib, 'fast', 'int()', 50);
+console.log('add after batches:', summary(find(sljs.getStats(), 'add'))); // 1 + 3 + 10
+console.log('fast after batch:', summary(find(sljs.getStats(), 'fast')));
+
+// Disabled again: calls are not counted
+sljs.setStatsEnabled(false);
+add(1, 2);
+console.log('add while disabled:', summary(find(sljs.getStats(), 'add')));
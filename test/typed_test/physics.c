@@ -0,0 +1,57 @@
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+// Mixed integer and floating-point arguments, interleaved
+double weighted(int32_t a, float wa, int64_t b, double wb, bool negate) {
+    double r = a * (double)wa + (double)b * wb;
+    return negate ? -r : r;
+}
+
+// Typed-array pointers plus a count
+float dot(const float* a, const float* b, uint32_t n) {
+    float sum = 0;
+    for (uint32_t i = 0; i < n; ++i) sum += a[i] * b[i];
+    return sum;
+}
+
+// In-place update through a pointer argument
+void integrate(double* positions, const double* velocities, size_t n, double dt) {
+    for (size_t i = 0; i < n; ++i) positions[i] += velocities[i] * dt;
+}
+
+int64_t checksum(const uint8_t* data, size_t length, int64_t seed) {
+    int64_t h = seed;
+    for (size_t i = 0; i < length; ++i) h = h * 31 + data[i];
+    return h;
+}
+
+const char* greet(const char* name, int times) {
+    static char out[256];
+    out[0] = '\0';
+    for (int i = 0; i < times; ++i) {
+        strncat(out, "hi ", sizeof(out) - strlen(out) - 1);
+        strncat(out, name, sizeof(out) - strlen(out) - 1);
+        if (i + 1 < times) strncat(out, ", ", sizeof(out) - strlen(out) - 1);
+    }
+    return out;
+}
+
+int concat_len(const char* a, const char* b, const char* c) {
+    return (int)(strlen(a) + strlen(b) + (c ? strlen(c) : 0));
+}
+
+bool is_even(int32_t v) {
+    return v % 2 == 0;
+}
+
+// Six int-class arguments fill every x86-64 integer register
+int64_t sum6(int a, int b, int c, int d, int e, int f) {
+    return (int64_t)a + b + c + d + e + f;
+}
+
+// Eight doubles fill every vector register
+double sum8(double a, double b, double c, double d, double e, double f, double g, double h) {
+    return a + b + c + d + e + f + g + h;
+}
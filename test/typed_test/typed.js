@@ -0,0 +1,66 @@
+const path = require('path');
+const sljs = require('../../build/Release/sljs');
+
+const lib = sljs.open(path.resolve(__dirname, 'physics.so'));
+
+// Numbers go in as C types, not argv strings
+console.log('weighted:', sljs.runTyped(lib, 'weighted', 'double(int32_t, float, int64_t, double, bool)', [2, 0.5, 10n, 1.5, true])); // -16
+console.log('is_even:', sljs.runTyped(lib, 'is_even', 'bool(int)', [4]));
+console.log('sum6:', sljs.runTyped(lib, 'sum6', 'int64_t(int,int,int,int,int,int)', [1, 2, 3, 4, 5, 6]));
+console.log('sum8:', sljs.runTyped(lib, 'sum8', 'double(double,double,double,double,double,double,double,double)', [1, 2, 3, 4, 5, 6, 7, 8]));
+
+// bind() falls back to the typed convention for signatures not in sljs.signatures
+const dot = lib.bind('dot', 'float(const float*, const float*, uint32_t)');
+console.log('dot:', dot(new Float32Array([1, 2, 3]), new Float32Array([4, 5, 6]), 3)); // 32
+
+const integrate = lib.bind('integrate', 'void(double*, const double*, size_t, double)');
+const pos = new Float64Array([0, 10]);
+integrate(pos, new Float64Array([1, -2]), 2, 0.5);
+console.log('integrate:', pos);
+
+const checksum = lib.bind('checksum', 'int64_t(const uint8_t*, size_t, int64_t)');
+console.log('checksum:', checksum(Buffer.from('abc'), 3, 7n));
+
+const greet = lib.bind('greet', 'const char*(const char*, int)');
+console.log('greet:', greet('sljs', 2));
+console.log('concat_len:', sljs.runTyped(lib, 'concat_len', 'int(const char*, const char*, const char*)', ['ab', 'cde', null]));
+
+// Argument types are checked against the signature
+for (const [args, label] of [[[new Int32Array(3), new Float32Array(3), 3], 'wrong array type'], [['x', new Float32Array(3), 3], 'string for pointer']]) {
+  try {
+    dot(...args);
+  } catch (e) {
+    console.log(label + ':', e.message);
+  }
+}
+try {
+  lib.bind('sum8', 'double(int,int,int,int,int,int,int)');
+} catch (e) {
+  console.log('too many:', e.message.includes('Too many arguments'));
+}
+try {
+  sljs.runTyped(lib, 'is_even' + '_'.repeat(300), 'bool(int)', [4]);
+} catch (e) {
+  console.log('long name:', e.message); // not truncated to a shorter name
+}
+
+// Steady state: many calls reuse the same argument arena
+let acc = 0;
+for (let i = 0; i < 100000; i++) acc += sljs.runTyped(lib, 'weighted', 'double(int32_t, float, int64_t, double, bool)', [i, 1, 1n, 1, false]);
+console.log('loop total:', acc);
+
+// Many distinct signatures, here and on worker threads: each thread keeps its own bounded cache
+const { Worker } = require('worker_threads');
+const spellings = (lib) => {
+  let even = 0;
+  for (let i = 0; i < 500; i++) even += sljs.runTyped(lib, 'is_even', 'bool(int' + ' '.repeat(i % 200) + ')', [i]) ? 1 : 0;
+  return even;
+};
+console.log('signature spellings:', spellings(lib)); // 250
+for (let w = 0; w < 2; w++) {
+  new Worker(`
+    const sljs = require(${JSON.stringify(require.resolve('../../build/Release/sljs'))});
+    const lib = sljs.open(${JSON.stringify(path.resolve(__dirname, 'physics.so'))});
+    require('worker_threads').parentPort.postMessage((${spellings})(lib));
+  `, { eval: true }).on('message', (even) => console.log('worker spellings:', even));
+}